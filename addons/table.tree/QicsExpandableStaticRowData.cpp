@@ -51,7 +51,12 @@ void QicsExpandableStaticRowData::dispose(QicsRow &row)
 
 void QicsExpandableStaticRowData::addChild(int index)
 {
-    m_list.append(index);
+    insertChild(m_list.size(), index);
+}
+
+void QicsExpandableStaticRowData::insertChild(int pos, int index)
+{
+    m_list.insert(qBound(0, pos, m_list.size()), index);
 
     // we will test if the added child is expandable row
     QicsExpandableStaticRowData *erow = qobject_cast<QicsExpandableStaticRowData*>(m_table->specialRowData(index));
@@ -151,10 +156,14 @@ void QicsExpandableStaticRowData::doExpand(bool open, bool tree, bool repaint)
             }
         }
 
-        // if the rrow has children itself, process them too
+        // if the rrow has children itself, process them too; those of
+        // a closed row are hidden already, so only its summary is left
         QicsExpandableStaticRowData *erow = qobject_cast<QicsExpandableStaticRowData*>(m_table->specialRowData(row));
         if (erow && erow != this) {
-            erow->doExpand(open, false, false);
+            if (erow->m_open)
+                erow->doExpand(open, false, false);
+            else
+                erow->doExpandSummary(open);
         }
     }
 
@@ -172,6 +181,24 @@ void QicsExpandableStaticRowData::doExpand(bool open, bool tree, bool repaint)
     }
 }
 
+void QicsExpandableStaticRowData::doExpandSummary(bool open)
+{
+    if (m_list.isEmpty())
+        return;
+
+    QicsDimensionManager *dm = m_table->gridInfo().dimensionManager();
+    const int summary = m_list.last();
+
+    if (!open || isRowHidden(summary))
+        dm->hideRow(summary);
+
+    if (m_table->summaryPolicy() == QicsTreeTable::SummaryAlwaysExpanded) {
+        if (!m_root || m_root->isOpen())
+            if (m_table->specialRowData(summary)->isVisible())
+                dm->showRow(summary);
+    }
+}
+
 bool QicsExpandableStaticRowData::isRowHidden(int index)
 {
     if (m_table->isRowFiltered(index))
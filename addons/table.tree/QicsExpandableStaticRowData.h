@@ -45,6 +45,13 @@ public:
     */
     void addChild(int index);
 
+    /*!
+    *	Inserts row with \a index at position \a pos of the internal list
+    *	of children.
+    *	\since 3.1
+    */
+    void insertChild(int pos, int index);
+
     /*!
     *	Sets level of the tree node to \a i. 0 is the root level, and so on.
     */
@@ -131,6 +138,15 @@ protected:
 
     void doExpand(bool open, bool tree = false, bool repaint = true);
 
+    /*!
+    *	Does what doExpand() would do for this closed node when its parent
+    *	is expanded or collapsed according to \a open.  The children of a
+    *	closed node are hidden already, so only the summary row is updated,
+    *	however large the subtree is.
+    *	\since 3.1
+    */
+    void doExpandSummary(bool open);
+
     /*!
     *	Returns \a true, if row \a index is hidden, otherwise returns \a false.
     */
@@ -0,0 +1,155 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#include <QicsGroupAggregate.h>
+
+#include <QList>
+#include <QPair>
+#include <QicsDataItem.h>
+
+
+QicsGroupAggregate::QicsGroupAggregate(QicsSummarizer::Aggregate func)
+    : myFunction(func), myCount(0), myNumbers(0), myReals(0),
+        myIntegerSum(0), myRealSum(0)
+{
+}
+
+void QicsGroupAggregate::add(int row, const QicsGroupKey &key)
+{
+    switch (myFunction)
+    {
+    case QicsSummarizer::First:
+    case QicsSummarizer::Last:
+        myRows.insert(row, key);
+        return;
+    case QicsSummarizer::NoAggregate:
+        return;
+    default:
+        break;
+    }
+
+    if (key.kind() == QicsGroupKey::Null)
+        return;
+
+    ++myCount;
+
+    if (key.kind() == QicsGroupKey::Number) {
+        ++myNumbers;
+        if (key.isInteger())
+            myIntegerSum += key.toLongLong();
+        else {
+            ++myReals;
+            myRealSum += key.toDouble();
+        }
+    }
+
+    switch (myFunction)
+    {
+    case QicsSummarizer::Min:
+    case QicsSummarizer::Max:
+    case QicsSummarizer::DistinctCount:
+        ++myValues[key];
+        break;
+    default:
+        break;
+    }
+}
+
+void QicsGroupAggregate::remove(int row, const QicsGroupKey &key)
+{
+    switch (myFunction)
+    {
+    case QicsSummarizer::First:
+    case QicsSummarizer::Last:
+        myRows.remove(row);
+        return;
+    case QicsSummarizer::NoAggregate:
+        return;
+    default:
+        break;
+    }
+
+    if (key.kind() == QicsGroupKey::Null)
+        return;
+
+    --myCount;
+
+    if (key.kind() == QicsGroupKey::Number) {
+        --myNumbers;
+        if (key.isInteger())
+            myIntegerSum -= key.toLongLong();
+        else if (--myReals)
+            myRealSum -= key.toDouble();
+        else
+            myRealSum = 0;      // do not keep rounding errors
+    }
+
+    switch (myFunction)
+    {
+    case QicsSummarizer::Min:
+    case QicsSummarizer::Max:
+    case QicsSummarizer::DistinctCount: {
+        QMap<QicsGroupKey, int>::iterator it = myValues.find(key);
+        if (it != myValues.end() && !--(*it))
+            myValues.erase(it);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void QicsGroupAggregate::shiftRows(int from, int delta)
+{
+    if (!delta || myRows.isEmpty())
+        return;
+
+    QList<QPair<int, QicsGroupKey> > moved;
+    QMap<int, QicsGroupKey>::iterator it = myRows.lowerBound(from);
+    while (it != myRows.end()) {
+        moved.append(qMakePair(it.key() + delta, it.value()));
+        it = myRows.erase(it);
+    }
+    for (int i = 0; i < moved.size(); ++i)
+        myRows.insert(moved.at(i).first, moved.at(i).second);
+}
+
+QicsDataItem *QicsGroupAggregate::value() const
+{
+    switch (myFunction)
+    {
+    case QicsSummarizer::Sum:
+        if (!myNumbers)
+            return 0;
+        if (!myReals)
+            return new QicsDataLongLong(myIntegerSum);
+        return new QicsDataDouble(double(myIntegerSum) + myRealSum);
+    case QicsSummarizer::Count:
+        return new QicsDataInt(myCount);
+    case QicsSummarizer::Average:
+        if (!myNumbers)
+            return 0;
+        return new QicsDataDouble((double(myIntegerSum) + myRealSum) / myNumbers);
+    case QicsSummarizer::Min:
+        return (myValues.isEmpty() ? 0 : myValues.constBegin().key().toDataItem());
+    case QicsSummarizer::Max:
+        return (myValues.isEmpty() ? 0 : (myValues.constEnd() - 1).key().toDataItem());
+    case QicsSummarizer::First:
+        return (myRows.isEmpty() ? 0 : myRows.constBegin().value().toDataItem());
+    case QicsSummarizer::Last:
+        return (myRows.isEmpty() ? 0 : (myRows.constEnd() - 1).value().toDataItem());
+    case QicsSummarizer::DistinctCount:
+        return new QicsDataInt(myValues.size());
+    default:
+        return 0;
+    }
+}
@@ -0,0 +1,79 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#ifndef QICSGROUPAGGREGATE_H
+#define QICSGROUPAGGREGATE_H
+
+#include <QMap>
+#include <QicsGroupKey.h>
+#include <QicsSummarizer.h>
+
+class QicsDataItem;
+
+/*! \file */
+
+/*!
+* \internal
+* \class QicsGroupAggregate QicsGroupAggregate.h
+* \brief The running result of a QicsSummarizer::Aggregate for one
+* column of a group.
+*
+* Values are added and removed one row at a time, so that a change of
+* a single cell costs the same for every group on its way to the top.
+* Sums are kept as an integer and a floating point part, which are
+* updated by adding and subtracting.  Min, Max and DistinctCount keep
+* the count of each value, and First and Last the value of each row,
+* ordered; the other functions keep no values at all.
+* \since 3.1
+*/
+class QICS_EXPORT QicsGroupAggregate
+{
+public:
+    QicsGroupAggregate(QicsSummarizer::Aggregate func = QicsSummarizer::NoAggregate);
+
+    inline QicsSummarizer::Aggregate function() const { return myFunction; }
+
+    /*!
+    * Adds \a key as the value of data row \a row.
+    */
+    void add(int row, const QicsGroupKey &key);
+
+    /*!
+    * Removes \a key, the value of data row \a row.
+    */
+    void remove(int row, const QicsGroupKey &key);
+
+    /*!
+    * Adds \a delta to the indexes of the rows from \a from on.
+    */
+    void shiftRows(int from, int delta);
+
+    /*!
+    * Returns a new data item holding the result, or 0 if there is none.
+    */
+    QicsDataItem *value() const;
+
+private:
+    QicsSummarizer::Aggregate myFunction;
+
+    // number of values, and of those which are numbers or not integral
+    int myCount;
+    int myNumbers;
+    int myReals;
+    qint64 myIntegerSum;
+    double myRealSum;
+
+    QMap<QicsGroupKey, int> myValues;
+    QMap<int, QicsGroupKey> myRows;
+};
+
+#endif //QICSGROUPAGGREGATE_H
@@ -36,6 +36,7 @@ void QicsGroupInfo::clear()
 
     m_groups.clear();
     m_rows.clear();
+    m_aggregates.clear();
 
     m_parent = 0;
     m_lev = 0;
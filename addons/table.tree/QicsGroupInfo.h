@@ -18,6 +18,8 @@
 #include <QFont>
 
 #include <QicsNamespace.h>
+#include <QicsGroupKey.h>
+#include <QicsGroupAggregate.h>
 
 class QicsSpecialRowData;
 class QicsExpandableStaticRowData;
@@ -288,11 +290,15 @@ private:
     inline void setLevel(int i) { m_lev = i; }
     inline void setContent(const QString &s) { m_content = s; }
     inline void setData(const QString &s) { m_data = s; }
+    inline void setKey(const QicsGroupKey &key) { m_key = key; }
 
     QList<QicsGroupInfo*> m_groups;
     QList<int> m_rows;
     int m_smi, m_hmi, m_col, m_lev;
     QString m_content, m_data;
+    QicsGroupKey m_key;
+    // the running results of the summarized columns
+    QMap<int, QicsGroupAggregate> m_aggregates;
     QicsTreeTable *m_table;
     QicsGroupInfo *m_parent;
 };
@@ -0,0 +1,193 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#include <QicsGroupKey.h>
+
+#include <string.h>
+#include <QicsDataItem.h>
+
+
+QicsGroupKey::QicsGroupKey()
+    : myKind(Null), myInteger(0), myReal(0), myIsInteger(true)
+{
+}
+
+QicsGroupKey::QicsGroupKey(const QString &text)
+    : myKind(Text), myInteger(0), myReal(0), myIsInteger(true), myText(text)
+{
+}
+
+QicsGroupKey::QicsGroupKey(const QicsDataItem *item)
+    : myKind(Null), myInteger(0), myReal(0), myIsInteger(true)
+{
+    if (!item)
+        return;
+
+    switch (item->type())
+    {
+    case QicsDataItem_Int:
+        myKind = Number;
+        myInteger = static_cast<const QicsDataInt *>(item)->data();
+        break;
+    case QicsDataItem_Long:
+        myKind = Number;
+        myInteger = static_cast<const QicsDataLong *>(item)->data();
+        break;
+    case QicsDataItem_LongLong:
+        myKind = Number;
+        myInteger = static_cast<const QicsDataLongLong *>(item)->data();
+        break;
+    case QicsDataItem_Bool:
+        myKind = Number;
+        myInteger = static_cast<const QicsDataBool *>(item)->data() ? 1 : 0;
+        break;
+    case QicsDataItem_Float:
+        setNumber(static_cast<const QicsDataFloat *>(item)->data());
+        break;
+    case QicsDataItem_Double:
+        setNumber(static_cast<const QicsDataDouble *>(item)->data());
+        break;
+    case QicsDataItem_Date: {
+        const QDate d = static_cast<const QicsDataDate *>(item)->data();
+        if (d.isValid()) {
+            myKind = Date;
+            myInteger = d.toJulianDay();
+        }
+        break;
+    }
+    case QicsDataItem_Time: {
+        const QTime t = static_cast<const QicsDataTime *>(item)->data();
+        if (t.isValid()) {
+            myKind = Time;
+            myInteger = QTime(0, 0).msecsTo(t);
+        }
+        break;
+    }
+    case QicsDataItem_DateTime: {
+        const QDateTime dt = static_cast<const QicsDataDateTime *>(item)->data();
+        if (dt.isValid()) {
+            myKind = DateTime;
+            myInteger = qint64(dt.date().toJulianDay()) * 86400000 +
+                QTime(0, 0).msecsTo(dt.time());
+        }
+        break;
+    }
+    case QicsDataItem_String:
+        myKind = Text;
+        myText = static_cast<const QicsDataString *>(item)->data();
+        break;
+    default:
+        myKind = Text;
+        myText = item->string();
+        break;
+    }
+}
+
+void QicsGroupKey::setNumber(double d)
+{
+    if (d != d) {
+        // NaN equals nothing, so group it by its string
+        myKind = Text;
+        myText = QString::number(d);
+        return;
+    }
+
+    myKind = Number;
+
+    // integral values group with equal integers
+    if (d >= -9.2e18 && d <= 9.2e18 && d == double(qint64(d)))
+        myInteger = qint64(d);
+    else {
+        myIsInteger = false;
+        myReal = d;
+    }
+}
+
+QicsDataItem *QicsGroupKey::toDataItem() const
+{
+    switch (myKind)
+    {
+    case Null:
+        return 0;
+    case Number:
+        if (myIsInteger)
+            return new QicsDataLongLong(myInteger);
+        return new QicsDataDouble(myReal);
+    case Date:
+        return new QicsDataDate(QDate::fromJulianDay(int(myInteger)));
+    case Time:
+        return new QicsDataTime(QTime(0, 0).addMSecs(int(myInteger)));
+    case DateTime:
+        return new QicsDataDateTime(QDateTime(QDate::fromJulianDay(int(myInteger / 86400000)),
+            QTime(0, 0).addMSecs(int(myInteger % 86400000))));
+    default:
+        return new QicsDataString(myText);
+    }
+}
+
+bool QicsGroupKey::operator==(const QicsGroupKey &other) const
+{
+    if (myKind != other.myKind)
+        return false;
+
+    switch (myKind)
+    {
+    case Null:
+        return true;
+    case Text:
+        return (myText == other.myText);
+    default:
+        if (myIsInteger != other.myIsInteger)
+            return false;
+        return (myIsInteger ? myInteger == other.myInteger : myReal == other.myReal);
+    }
+}
+
+bool QicsGroupKey::operator<(const QicsGroupKey &other) const
+{
+    if (myKind != other.myKind)
+        return (myKind < other.myKind);
+
+    switch (myKind)
+    {
+    case Null:
+        return false;
+    case Text:
+        return (myText < other.myText);
+    default:
+        if (myIsInteger && other.myIsInteger)
+            return (myInteger < other.myInteger);
+        return ((myIsInteger ? double(myInteger) : myReal) <
+            (other.myIsInteger ? double(other.myInteger) : other.myReal));
+    }
+}
+
+uint qHash(const QicsGroupKey &key)
+{
+    const uint seed = uint(key.myKind) * 0x9e3779b9U;
+
+    switch (key.myKind)
+    {
+    case QicsGroupKey::Null:
+        return seed;
+    case QicsGroupKey::Text:
+        return seed ^ qHash(key.myText);
+    default:
+        if (key.myIsInteger)
+            return seed ^ qHash(quint64(key.myInteger));
+        else {
+            quint64 bits;
+            memcpy(&bits, &key.myReal, sizeof(bits));
+            return seed ^ qHash(bits) ^ 1U;
+        }
+    }
+}
@@ -0,0 +1,130 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#ifndef QICSGROUPKEY_H
+#define QICSGROUPKEY_H
+
+#include <QString>
+#include <QHash>
+#include <QicsNamespace.h>
+
+class QicsDataItem;
+
+/*! \file */
+
+/*!
+* \internal
+* \class QicsGroupKey QicsGroupKey.h
+* \brief The value a group of QicsTreeTable is formed by.
+*
+* QicsGroupKey holds the value of a data item in a form which can be
+* compared and hashed without converting it to a string.  Integers,
+* booleans and integral floating point values are kept as 64-bit
+* integers, other floating point values as doubles, and dates and
+* times as day or millisecond counts.  Strings and items of other types
+* are kept as their string.
+*
+* Keys order by kind first (no value, numbers, dates, times, date-times,
+* strings) and then by value, so numeric groups sort numerically and
+* date groups chronologically.
+*
+* A key may also carry the text shown for the group.  The text of a key
+* made from a string is its value; for other keys it is set with
+* setText() and takes no part in comparisons.
+* \since 3.1
+*/
+class QICS_EXPORT QicsGroupKey
+{
+public:
+    enum Kind {
+        Null,
+        Number,
+        Date,
+        Time,
+        DateTime,
+        Text
+    };
+
+    /*!
+    * Constructs a key for an empty cell.
+    */
+    QicsGroupKey();
+
+    /*!
+    * Constructs the key for the value of \a item, which may be 0.
+    */
+    explicit QicsGroupKey(const QicsDataItem *item);
+
+    /*!
+    * Constructs a key for the string \a text.
+    */
+    explicit QicsGroupKey(const QString &text);
+
+    inline Kind kind() const { return myKind; }
+
+    /*!
+    * Returns true if the key is a number held as an integer.
+    */
+    inline bool isInteger() const
+    { return (myKind == Number && myIsInteger); }
+
+    /*!
+    * Returns the integer of a key for which isInteger() is true.
+    */
+    inline qint64 toLongLong() const { return myInteger; }
+
+    /*!
+    * Returns the number of a Number key, or 0 for other keys.
+    */
+    inline double toDouble() const
+    { return (myKind != Number ? 0 : myIsInteger ? double(myInteger) : myReal); }
+
+    /*!
+    * Returns a new data item holding the value of the key, or 0 for a
+    * key of no value.  Integral numbers are returned as QicsDataLongLong.
+    */
+    QicsDataItem *toDataItem() const;
+
+    /*!
+    * Returns the text shown for the group.
+    */
+    inline const QString &text() const { return myText; }
+
+    /*!
+    * Sets the text shown for the group to \a text.  Does nothing for
+    * keys made from strings.
+    */
+    inline void setText(const QString &text)
+    { if (myKind != Text) myText = text; }
+
+    bool operator==(const QicsGroupKey &other) const;
+    inline bool operator!=(const QicsGroupKey &other) const
+    { return !(*this == other); }
+    bool operator<(const QicsGroupKey &other) const;
+
+private:
+    friend QICS_EXPORT uint qHash(const QicsGroupKey &key);
+
+    void setNumber(double d);
+
+    Kind myKind;
+    // integral values, and dates and times; myIsInteger tells whether
+    // a number is held here or in myReal
+    qint64 myInteger;
+    double myReal;
+    bool myIsInteger;
+    QString myText;
+};
+
+QICS_EXPORT uint qHash(const QicsGroupKey &key);
+
+#endif //QICSGROUPKEY_H
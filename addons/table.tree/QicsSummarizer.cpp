@@ -0,0 +1,36 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#include <QicsSummarizer.h>
+
+#include <QicsDataItem.h>
+#include <QicsGroupInfo.h>
+
+
+void QicsSummarizer::setAggregate(int col, Aggregate func)
+{
+    if (func == NoAggregate)
+        m_aggregates.remove(col);
+    else
+        m_aggregates.insert(col, func);
+}
+
+void QicsSummarizer::onAggregated(QicsGroupInfo *gi, int col, Aggregate func,
+                                  const QicsDataItem *value)
+{
+    Q_UNUSED(func);
+
+    if (value)
+        gi->setSummaryData(col, *value);
+    else
+        gi->setSummaryData(col, QicsDataString());
+}
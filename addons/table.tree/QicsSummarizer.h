@@ -13,6 +13,12 @@
 #ifndef QICSSUMMARIZER_H
 #define QICSSUMMARIZER_H
 
+#include <QMap>
+#include <QicsNamespace.h>
+
+class QicsGroupInfo;
+class QicsDataItem;
+
 /*!
 *  \class QicsSummarizer QicsTreeTable.h
 *  \brief Used for handling summary and header rows.
@@ -56,23 +62,79 @@ gi->headerRef().setFont(QFont("Arial", 12-gi->level(), QFont::Bold));
 }
 };
 *  \endcode
+*
+*  The summarizer can also compute the summary rows itself.  setAggregate()
+*  selects the function summarizing a column, and the table keeps its result
+*  for every group up to date: after a regroup, and when rows are added,
+*  removed or moved between groups, or a cell of the column changes, only the
+*  groups on the way from the changed row to the top are updated.  Each result
+*  is passed to onAggregated(), which by default puts it into the summary row
+*  and may be reimplemented to format it.  A summarizer which only
+*  aggregates needs no subclass.
+
+*  \code
+QicsSummarizer *s = new QicsSummarizer();
+s->setAggregate(3, QicsSummarizer::Sum);
+s->setAggregate(4, QicsSummarizer::Average);
+s->setAggregate(5, QicsSummarizer::Max);
+table->setSummarizer(s);
+*  \endcode
 */
 
 class QICS_EXPORT QicsSummarizer
 {
 public:
+    /*!
+    * Functions summarizing the values of a column in a group.
+    * Cells without a value are left out, except by First and Last.
+    * \since 3.1
+    */
+    enum Aggregate {
+        NoAggregate,
+        Sum,
+        Count,
+        Min,
+        Max,
+        Average,
+        First,
+        Last,
+        DistinctCount
+    };
+
     /*!
     * Constructor, does nothing. Used for subclassing.
     */
     QicsSummarizer() {};
     virtual ~QicsSummarizer() {};
 
+    /*!
+    * Summarizes column \a col (model coordinates) by \a func;
+    * NoAggregate stops summarizing it.  Takes effect when the table
+    * is regrouped or the summarizer is set to the table.
+    * \since 3.1
+    */
+    void setAggregate(int col, Aggregate func);
+
+    /*!
+    * Returns the function summarizing column \a col.
+    * \since 3.1
+    */
+    inline Aggregate aggregate(int col) const
+    { return m_aggregates.value(col, NoAggregate); }
+
+    /*!
+    * Returns the summarized columns with their functions.
+    * \since 3.1
+    */
+    inline const QMap<int, Aggregate> &aggregates() const
+    { return m_aggregates; }
+
     /*!
     * Called each time when regroup by column occurs,
     * passing QicsGroupInfo object \a gi as parameter.
     * Used for subclassing.
     */
-    virtual void onGrouping(QicsGroupInfo *gi) = 0;
+    virtual void onGrouping(QicsGroupInfo *gi) { Q_UNUSED(gi); }
 
     /*!
     * Called each time when value of the cell at \a row, \a col
@@ -81,7 +143,25 @@ public:
     * Used for subclassing.
     * \since 2.4
     */
-    virtual void onCellValueChanged(int row, int col, QicsGroupInfo *gi) = 0;
+    virtual void onCellValueChanged(int row, int col, QicsGroupInfo *gi)
+    { Q_UNUSED(row); Q_UNUSED(col); Q_UNUSED(gi); }
+
+    /*!
+    * Called when the result of \a func for column \a col of group \a gi
+    * has changed, before onGrouping() or onCellValueChanged().  \a value
+    * is the result, or 0 if the group has no values to summarize.  Sums
+    * of integers are QicsDataLongLong, counts QicsDataInt, averages
+    * QicsDataDouble, other results have the type of the column values.
+    *
+    * The default implementation sets \a value as data of the summary row.
+    * Reimplement it to format the result.
+    * \since 3.1
+    */
+    virtual void onAggregated(QicsGroupInfo *gi, int col, Aggregate func,
+        const QicsDataItem *value);
+
+private:
+    QMap<int, Aggregate> m_aggregates;
 };
 
 #endif //QICSSUMMARIZER_H
@@ -33,6 +33,7 @@ QicsViewTreeDataModel::QicsViewTreeDataModel(QicsDataModel *parent, bool shiftCo
     connect(parent, SIGNAL(columnsAdded(int)), this, SLOT(addColumns(int)));
 
     connect(parent, SIGNAL(cellValueChanged(int,int)), this, SLOT(onCellValueChanged(int,int)));
+    connect(parent, SIGNAL(cellValuesChanged(QicsRegion)), this, SLOT(onCellValuesChanged(QicsRegion)));
     connect(parent, SIGNAL(modelChanged(QicsRegion)), this, SIGNAL(modelChanged(QicsRegion)));
     connect(parent, SIGNAL(modelSizeChanged(int,int)), this, SIGNAL(modelSizeChanged(int,int)));
 }
@@ -68,6 +69,12 @@ void QicsViewTreeDataModel::onCellValueChanged(int row, int col)
     emit cellValueChanged(row, col+m_shiftColumn);
 }
 
+void QicsViewTreeDataModel::onCellValuesChanged(const QicsRegion &reg)
+{
+    emit cellValuesChanged(QicsRegion(reg.startRow(), reg.startColumn()+m_shiftColumn,
+        reg.endRow(), reg.endColumn()+m_shiftColumn));
+}
+
 void QicsViewTreeDataModel::addRows(int count)
 {
     setNumRows(numRows() + count);
@@ -86,16 +93,17 @@ void QicsViewTreeDataModel::insertRows(int count, int index)
     if (!m_delayInsertSignals) emit rowsInserted(count, index);
 
     if (m_specRows.size()) {
-        // renumber special rows
-        QMap<int, QicsSpecialRowData*>::iterator it_up = m_specRows.upperBound(index);
-        if (it_up == m_specRows.end())
+        // renumber special rows; one at index is moved as well, as the
+        // new rows are inserted before it when rows are appended
+        QMap<int, QicsSpecialRowData*>::iterator it_from = m_specRows.lowerBound(index);
+        if (it_from == m_specRows.end())
             return;
 
         QMap<int, QicsSpecialRowData*> temp;
         QMap<int, QicsSpecialRowData*>::iterator it;
-        for (it = m_specRows.begin(); it != it_up; it++)
+        for (it = m_specRows.begin(); it != it_from; it++)
             temp[it.key()] = *it;
-        for (it = it_up; it != m_specRows.end(); it++)
+        for (it = it_from; it != m_specRows.end(); it++)
             temp[it.key() + count] = *it;
 
         m_specRows = temp;
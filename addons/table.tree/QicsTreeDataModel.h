@@ -162,6 +162,11 @@ protected slots:
     */
     void onCellValueChanged(int row, int col);
 
+    /*! \internal
+    *  Called when the values in region \a reg change in a batch.
+    */
+    void onCellValuesChanged(const QicsRegion &reg);
+
 protected:
     QMap<int, QicsSpecialRowData*> m_specRows;
     QicsDataModel *m_model;
@@ -29,7 +29,6 @@
 #include <QicsSummarizer.h>
 #include <QicsSpecialRowData.h>
 #include <QicsExpandableStaticRowData.h>
-#include <QicsUtil.h>
 
 
 
@@ -93,6 +92,7 @@ void QicsTreeTable::setDataModel(QicsDataModel *model)
 
     if (m_userModel) {
         connect(m_userModel, SIGNAL(cellValueChanged(int,int)), this, SLOT(onCellValueChanged(int,int)));
+        connect(m_userModel, SIGNAL(cellValuesChanged(QicsRegion)), this, SLOT(onCellValuesChanged(QicsRegion)));
 
         connect(m_userModel, SIGNAL(rowsInserted(int,int)), this, SLOT(onRowsAdded(int,int)));
         connect(m_userModel, SIGNAL(rowsDeleted(int,int)), this, SLOT(onRowsRemoved(int,int)));
@@ -111,6 +111,7 @@ void QicsTreeTable::doInit(QicsDataModel *model, bool useHeader)
     m_sortOrder = Qics::Ascending;
     m_from = 0; m_to = -1;
     m_func = 0;
+    m_groupsSorted = false;
 
     m_treeInHeader = useHeader;
     m_groupColsShown = false;
@@ -216,6 +217,11 @@ void QicsTreeTable::removeSpecialRow(int index)
 void QicsTreeTable::removeSpecialRows()
 {
     m_topGroup->clear();
+    m_changedGroups.clear();
+    m_changedRows.clear();
+    m_unsortedGroups.clear();
+    m_groupsSorted = false;
+    m_aggregateValues.clear();
 
     m_rowGroupMap.clear();
 
@@ -464,48 +470,37 @@ void QicsTreeTable::doGroupTable()
 
         QicsViewTreeDataModel* model = viewModel();
 
-        QHash<QString, TreeItem*> map;
         TreeItem *root = new TreeItem();
         root->row = 0;
 
-        // build tree
-        for (int i = 0; i < model->numRows(); ++i) {
-            // make id string
-            QString s_id, s_item,label;
-            int group;
-            TreeItem *wr = 0;
-            for (int k = 0; k < m_groups.size(); ++k) {
-                s_item = model->itemString(i, (group=m_groups.at(k)));
-                s_id += QString("%1.%2.").arg(group).arg(qicsCryptData(s_item.toLocal8Bit()).constData());
-
-                if ( m_treeMode == Tree ) {
-                    if (!map.contains(s_id)) {
-                        wr = new TreeItem(k ? wr : root);
-                        map[s_id] = wr;
-                    } else
-                        wr = map.value(s_id);
-                    wr->content = s_item;
-                    wr->group = group;
-                } else {
-                    if ( k )
-                        label +=QString(" => %1").arg(s_item);
-                    else
-                        label +=QString("%1").arg(s_item);
+        // build tree: every node finds its children by the typed value
+        // of their cells, so rows are grouped without making strings
+        const int rows = model->numRows();
+        const int levels = m_groups.size();
+        for (int i = 0; i < rows; ++i) {
+            TreeItem *wr = root;
+            for (int k = 0; k < levels; ++k) {
+                const int group = m_groups.at(k);
+                const QicsDataItem *itm = model->item(i, group);
+                const QicsGroupKey key(itm);
+
+                TreeItem *child = wr->children.value(key);
+                if (!child) {
+                    child = new TreeItem(wr);
+                    child->key = key;
+                    child->key.setText(itm ? itm->string() : QString());
+                    child->group = group;
+                    wr->children.insert(key, child);
                 }
-            }
-            if ( m_treeMode != Tree ) {
-                if (!map.contains(s_id)) {
-                    wr = new TreeItem(root);
-                    map[s_id] = wr;
-                    wr->content = label;
-                    wr->group = group = m_groups.first();
-                } else
-                    wr = map.value(s_id);
+                wr = child;
             }
             TreeItem *wi = new TreeItem(wr);
             wi->row = i;
         }
 
+        if (m_treeMode != Tree)
+            doFlattenTree(root);
+
         // now we have this tree - time to convert it into rows
         QVector<int> v;
 
@@ -515,8 +510,6 @@ void QicsTreeTable::doGroupTable()
 
         // clear all the older items
         delete root;
-        //qDeleteAll(map);
-        map.clear();
 
         //qDebug() << v;
 
@@ -540,6 +533,8 @@ void QicsTreeTable::doGroupTable()
         }
     }
 
+    doAggregateGroups();
+
     if (m_summarizer && m_groups.size()) {
         for (int i = 0; i < topGroupRef().count(); ++i)
             iterateGroups(topGroupRef().childAt(i));
@@ -550,6 +545,49 @@ void QicsTreeTable::doGroupTable()
     emit groupingChanged();
 }
 
+void QicsTreeTable::doFlattenTree(TreeItem *root)
+{
+    // depth-first, so the groups keep the order of their parents
+    QList<TreeItem*> leaves;
+    QList<TreeItem*> stack;
+    stack.append(root);
+    while (!stack.isEmpty()) {
+        TreeItem *ti = stack.takeLast();
+        if (ti->children.isEmpty()) {
+            if (ti != root)
+                leaves.append(ti);
+            continue;
+        }
+        for (int i = ti->list.size()-1; i >= 0; --i)
+            stack.append(ti->list.at(i));
+    }
+
+    QList<TreeItem*> flat;
+    for (int i = 0; i < leaves.size(); ++i) {
+        TreeItem *leaf = leaves.at(i);
+
+        QStringList labels;
+        for (TreeItem *ti = leaf; ti != root; ti = ti->parent)
+            labels.prepend(ti->key.text());
+
+        // a flat group is labeled, and so ordered, by all its values
+        TreeItem *wr = new TreeItem();
+        wr->parent = root;
+        wr->key = QicsGroupKey(labels.join(" => "));
+        wr->group = m_groups.first();
+        wr->list = leaf->list;
+        leaf->list.clear();
+        for (int j = 0; j < wr->list.size(); ++j)
+            wr->list.at(j)->parent = wr;
+
+        flat.append(wr);
+    }
+
+    qDeleteAll(root->list);
+    root->list = flat;
+    root->children.clear();
+}
+
 void QicsTreeTable::doConvertTree(TreeItem *ti, QicsViewTreeDataModel* model, QVector<int> *ord, int deep,
                                   QicsExpandableStaticRowData *lastRow,
                                   QicsGroupInfo *group)
@@ -562,13 +600,14 @@ void QicsTreeTable::doConvertTree(TreeItem *ti, QicsViewTreeDataModel* model, QV
         ord->append(sr_index);
         m_rowGroupMap[sr_index] = group;
 
-        m_groupData[ti->group].add(sr_index, ti->content);
+        m_groupData[ti->group].add(sr_index, ti->key);
         group->setHeaderIndex(sr_index);
         group->setColumnIndex(ti->group);
         group->setLevel(deep);
 
         group->setContent(groupText(ti->group));
-        group->setData(ti->content);
+        group->setData(ti->key.text());
+        group->setKey(ti->key);
         addSpecialRow(sr_index, erow = new QicsExpandableStaticRowData(this, group));
 
         if (lastRow)
@@ -610,9 +649,10 @@ void QicsTreeTable::setSummaryPolicy(int policy)
     m_summaryPolicy = (QicsSummaryPolicy)policy;
 
     setRepaintBehavior(Qics::RepaintOff);
-    QSet<int>::const_iterator it;
-    for (it = m_specialRows.constBegin(); it != m_specialRows.constEnd(); ++it) {
-        QicsExpandableStaticRowData *erow = qobject_cast<QicsExpandableStaticRowData*>(specialRowData(*it));
+
+    // top level groups pass their state down to the open subgroups
+    for (int i = 0; i < m_topGroup->count(); ++i) {
+        QicsExpandableStaticRowData *erow = m_topGroup->childAt(i)->headerRowData();
         if (erow)
             erow->doExpand(erow->m_open, true, false);
     }
@@ -629,6 +669,528 @@ void QicsTreeTable::iterateGroups(QicsGroupInfo *gi)
             iterateGroups(gi->childAt(i));
 }
 
+QicsGroupInfo *QicsTreeTable::doFindGroup(QicsGroupInfo *parent, int col, const QicsGroupKey &key) const
+{
+    QMap<int, GroupItem>::const_iterator git = m_groupData.constFind(col);
+    if (git == m_groupData.constEnd())
+        return 0;
+
+    QMap<QicsGroupKey, QList<int> >::const_iterator it = git->content.constFind(key);
+    if (it == git->content.constEnd())
+        return 0;
+
+    // the same value may head a group under several parents
+    const QList<int> &headers = it.value();
+    for (int i = 0; i < headers.size(); ++i) {
+        QicsGroupInfo *gi = m_rowGroupMap.value(headers.at(i));
+        if (gi && gi->parentGroup() == parent)
+            return gi;
+    }
+
+    return 0;
+}
+
+QicsGroupInfo *QicsTreeTable::doCreateGroup(QicsGroupInfo *parent, int level, int col, const QicsGroupKey &key)
+{
+    QicsViewTreeDataModel *model = viewModel();
+
+    // special rows are always appended, so no other row moves
+    QicsGroupInfo *gi = parent->addGroup();
+    const int header = model->numRows();
+    m_rowGroupMap[header] = gi;
+
+    m_groupData[col].add(header, key);
+    gi->setHeaderIndex(header);
+    gi->setColumnIndex(col);
+    gi->setLevel(level);
+
+    gi->setContent(groupText(col));
+    gi->setData(key.text());
+    gi->setKey(key);
+    doInitAggregates(gi);
+
+    QicsExpandableStaticRowData *erow = new QicsExpandableStaticRowData(this, gi);
+    addSpecialRow(header, erow);
+
+    // the summary row stays the last child of the parent
+    if (parent != m_topGroup) {
+        QicsExpandableStaticRowData *perow = parent->headerRowData();
+        perow->insertChild(perow->m_list.size()-1, header);
+        doHideInClosedGroup(header, parent);
+    }
+
+    const int summary = model->numRows();
+    addSpecialRow(summary, new QicsSpecialRowData(this));
+    erow->addChild(summary);
+    m_rowGroupMap[summary] = gi;
+    gi->setSummaryIndex(summary);
+    m_summaryRows.insert(summary);
+
+    if (parent != m_topGroup)
+        doHideInClosedGroup(summary, parent);
+
+    return gi;
+}
+
+void QicsTreeTable::doHideInClosedGroup(int index, QicsGroupInfo *group)
+{
+    // collapsing skips closed groups, so what they get must start hidden
+    QicsExpandableStaticRowData *erow = group->headerRowData();
+    if (erow && (!erow->isOpen() || dimensionManager()->isRowHidden(group->headerModelIndex())))
+        dimensionManager()->hideRow(index);
+}
+
+QicsGroupInfo *QicsTreeTable::doAddRowToGroups(int row, QicsGroupInfo *current)
+{
+    QicsViewTreeDataModel *model = viewModel();
+    QicsGroupInfo *group = m_topGroup;
+
+    for (int k = 0; k < m_groups.size(); ++k) {
+        const int col = m_groups.at(k);
+        const QicsDataItem *itm = model->item(row, col);
+        const QicsGroupKey key(itm);
+
+        QicsGroupInfo *child = doFindGroup(group, col, key);
+        if (!child) {
+            QicsGroupKey labeled(key);
+            labeled.setText(itm ? itm->string() : QString());
+            child = doCreateGroup(group, k, col, labeled);
+        }
+        group = child;
+    }
+
+    if (group == current)
+        return group;
+
+    group->addRow(row);
+    m_rowGroupMap[row] = group;
+    doAggregateRow(row, group, true);
+
+    QicsExpandableStaticRowData *erow = group->headerRowData();
+    erow->insertChild(erow->m_list.size()-1, row);
+    doHideInClosedGroup(row, group);
+
+    m_changedRows.insert(row);
+    doMarkGroupChanged(group);
+    doMarkGroupUnsorted(group);
+
+    return group;
+}
+
+void QicsTreeTable::doRemoveRowFromGroup(int row, QicsGroupInfo *group)
+{
+    doAggregateRow(row, group, false);
+    group->m_rows.removeOne(row);
+
+    QicsExpandableStaticRowData *erow = group->headerRowData();
+    if (erow) {
+        const int i = erow->m_list.indexOf(row);
+        if (i >= 0)
+            erow->m_list.remove(i);
+    }
+
+    if (m_rowGroupMap.value(row) == group)
+        m_rowGroupMap.remove(row);
+
+    doMarkGroupChanged(group);
+
+    // drop the groups which were left empty
+    while (group != m_topGroup && group->m_rows.isEmpty() && group->m_groups.isEmpty()) {
+        QicsGroupInfo *parent = group->parentGroup();
+        doRemoveGroup(group);
+        group = parent;
+    }
+}
+
+void QicsTreeTable::doRemoveGroup(QicsGroupInfo *group)
+{
+    QicsGroupInfo *parent = group->parentGroup();
+
+    if (parent != m_topGroup) {
+        QicsExpandableStaticRowData *perow = parent->headerRowData();
+        const int i = perow->m_list.indexOf(group->headerModelIndex());
+        if (i >= 0)
+            perow->m_list.remove(i);
+    }
+
+    GroupItem &gitem = m_groupData[group->columnIndex()];
+    QMap<QicsGroupKey, QList<int> >::iterator it = gitem.content.find(group->m_key);
+    if (it != gitem.content.end()) {
+        it->removeOne(group->headerModelIndex());
+        if (it->isEmpty())
+            gitem.content.erase(it);
+    }
+
+    // The header goes first, as disposing of it touches its children.
+    // Forget each index before the rows after it are renumbered.
+    const int header = group->headerModelIndex();
+    group->setHeaderIndex(-1);
+    doRemoveGroupRow(header);
+
+    const int summary = group->summaryModelIndex();
+    group->setSummaryIndex(-1);
+    doRemoveGroupRow(summary);
+
+    parent->m_groups.removeOne(group);
+    m_changedGroups.remove(group);
+    m_unsortedGroups.remove(group);
+    delete group;
+}
+
+void QicsTreeTable::doRemoveGroupRow(int index)
+{
+    if (index < 0)
+        return;
+
+    m_rowGroupMap.remove(index);
+    m_summaryRows.remove(index);
+    m_filteredRows.remove(index);
+    removeSpecialRow(index);
+
+    doShiftRowIndexes(index+1, -1);
+}
+
+void QicsTreeTable::doShiftRowIndexes(int from, int delta)
+{
+    if (!delta)
+        return;
+
+    QList<QPair<int, QicsGroupInfo*> > moved;
+    QMap<int, QicsGroupInfo*>::iterator it = m_rowGroupMap.lowerBound(from);
+    while (it != m_rowGroupMap.end()) {
+        moved.append(qMakePair(it.key() + delta, it.value()));
+        it = m_rowGroupMap.erase(it);
+    }
+    for (int i = 0; i < moved.size(); ++i)
+        m_rowGroupMap.insert(moved.at(i).first, moved.at(i).second);
+
+    QMap<int, GroupItem>::iterator git;
+    for (git = m_groupData.begin(); git != m_groupData.end(); ++git) {
+        QMap<QicsGroupKey, QList<int> >::iterator cit;
+        for (cit = git->content.begin(); cit != git->content.end(); ++cit)
+            for (int i = 0; i < cit->size(); ++i)
+                if ((*cit)[i] >= from)
+                    (*cit)[i] += delta;
+    }
+
+    QSet<int> *sets[] = { &m_summaryRows, &m_specialRows, &m_filteredRows, &m_changedRows };
+    for (int k = 0; k < 4; ++k) {
+        QSet<int> shifted;
+        QSet<int>::const_iterator sit;
+        for (sit = sets[k]->constBegin(); sit != sets[k]->constEnd(); ++sit)
+            shifted.insert(*sit >= from ? *sit + delta : *sit);
+        *sets[k] = shifted;
+    }
+
+    // only data rows have values, and the special rows follow them
+    QMap<int, QVector<QicsGroupKey> >::iterator vit;
+    for (vit = m_aggregateValues.begin(); vit != m_aggregateValues.end(); ++vit) {
+        if (from > vit->size())
+            continue;
+        if (delta > 0)
+            vit->insert(from, delta, QicsGroupKey());
+        else
+            vit->remove(qMax(from + delta, 0), qMin(-delta, from));
+    }
+
+    for (int i = 0; i < m_topGroup->count(); ++i)
+        doShiftGroupIndexes(m_topGroup->childAt(i), from, delta);
+}
+
+void QicsTreeTable::doShiftGroupIndexes(QicsGroupInfo *gi, int from, int delta)
+{
+    if (gi->m_hmi >= from)
+        gi->m_hmi += delta;
+    if (gi->m_smi >= from)
+        gi->m_smi += delta;
+
+    for (int i = 0; i < gi->m_rows.size(); ++i)
+        if (gi->m_rows.at(i) >= from)
+            gi->m_rows[i] += delta;
+
+    // the view model has renumbered its special rows already
+    QicsExpandableStaticRowData *erow = gi->headerRowData();
+    if (erow)
+        for (int i = 0; i < erow->m_list.size(); ++i)
+            if (erow->m_list.at(i) >= from)
+                erow->m_list[i] += delta;
+
+    QMap<int, QicsGroupAggregate>::iterator ait;
+    for (ait = gi->m_aggregates.begin(); ait != gi->m_aggregates.end(); ++ait)
+        ait->shiftRows(from, delta);
+
+    for (int i = 0; i < gi->count(); ++i)
+        doShiftGroupIndexes(gi->childAt(i), from, delta);
+}
+
+void QicsTreeTable::doMarkGroupChanged(QicsGroupInfo *gi)
+{
+    for (; gi && gi != m_topGroup; gi = gi->parentGroup())
+        m_changedGroups.insert(gi);
+}
+
+void QicsTreeTable::doMarkGroupUnsorted(QicsGroupInfo *gi)
+{
+    if (gi && gi != m_topGroup && m_groupsSorted && !m_sorted.isEmpty())
+        m_unsortedGroups.insert(gi);
+}
+
+static bool groupLevelLessThan(const QicsGroupInfo *a, const QicsGroupInfo *b)
+{
+    return (a->level() < b->level());
+}
+
+void QicsTreeTable::doRecalculateChangedGroups()
+{
+    if (m_summarizer && !m_changedGroups.isEmpty()) {
+        // parents first, as a full regroup does
+        QList<QicsGroupInfo*> groups = m_changedGroups.toList();
+        qStableSort(groups.begin(), groups.end(), groupLevelLessThan);
+
+        for (int i = 0; i < groups.size(); ++i) {
+            doPublishAggregates(groups.at(i));
+            m_summarizer->onGrouping(groups.at(i));
+        }
+    }
+
+    m_changedGroups.clear();
+}
+
+void QicsTreeTable::doFilterChangedRows()
+{
+    // the groups on the way from the changed rows to the top; the marked
+    // groups come with their parents already
+    QSet<QicsGroupInfo*> groups = m_changedGroups;
+    QSet<int>::const_iterator it;
+    for (it = m_changedRows.constBegin(); it != m_changedRows.constEnd(); ++it)
+        for (QicsGroupInfo *gi = m_rowGroupMap.value(*it); gi && gi != m_topGroup; gi = gi->parentGroup()) {
+            if (groups.contains(gi))
+                break;
+            groups.insert(gi);
+        }
+
+    // the rows first, as the groups are filtered when all their rows are
+    for (it = m_changedRows.constBegin(); it != m_changedRows.constEnd(); ++it) {
+        const int row = *it;
+        if (doFilterGroupKeyCheck(m_rowGroupMap.value(row)) || !doFilterRowPasses(row))
+            m_filteredRows.insert(row);
+        else
+            m_filteredRows.remove(row);
+    }
+
+    // then the groups, children before their parents
+    QList<QicsGroupInfo*> ordered = groups.toList();
+    qStableSort(ordered.begin(), ordered.end(), groupLevelLessThan);
+
+    for (int i = ordered.size() - 1; i >= 0; --i) {
+        QicsGroupInfo *gi = ordered.at(i);
+        QicsExpandableStaticRowData *erow = gi->headerRowData();
+        if (!erow)
+            continue;
+
+        // filtered by its value, or when none of its rows is left
+        bool filtered = doFilterGroupKeyCheck(gi);
+        if (!filtered && m_filters.count()) {
+            const QVector<int> &list = erow->m_list;
+            filtered = true;
+            for (int k = 0; filtered && k < list.size() - 1; ++k)
+                filtered = isRowFiltered(list.at(k));
+        }
+
+        const int indexes[] = { gi->headerModelIndex(), gi->summaryModelIndex() };
+        for (int k = 0; k < 2; ++k) {
+            if (filtered)
+                m_filteredRows.insert(indexes[k]);
+            else
+                m_filteredRows.remove(indexes[k]);
+        }
+    }
+
+    // and show or hide them, parents first
+    for (int i = 0; i < ordered.size(); ++i) {
+        QicsGroupInfo *gi = ordered.at(i);
+        doUpdateRowVisibility(gi->headerModelIndex(), gi->parentGroup());
+        doUpdateRowVisibility(gi->summaryModelIndex(), gi);
+    }
+
+    for (it = m_changedRows.constBegin(); it != m_changedRows.constEnd(); ++it)
+        doUpdateRowVisibility(*it, m_rowGroupMap.value(*it));
+
+    m_changedRows.clear();
+}
+
+bool QicsTreeTable::doFilterGroupKeyCheck(QicsGroupInfo *gi)
+{
+    for (; gi && gi != m_topGroup; gi = gi->parentGroup()) {
+        QicsListFilterDelegate *lf = qobject_cast<QicsListFilterDelegate*>(m_filters.value(gi->columnIndex()));
+        if (lf && !lf->match(gi->m_key.text(), -1, -1))
+            return true;
+    }
+
+    return false;
+}
+
+bool QicsTreeTable::doFilterRowPasses(int index)
+{
+    for (QMap<int, QPointer<QicsAbstractFilterDelegate> >::iterator it = m_filters.begin(); it != m_filters.end(); ++it) {
+        if (!it.value())
+            continue;
+        const int col = it.key();
+        QString s = viewModel()->itemString(index, col);
+        if (!it.value()->match(s, index, col))
+            return false;
+    }
+
+    return true;
+}
+
+void QicsTreeTable::doUpdateRowVisibility(int index, QicsGroupInfo *group)
+{
+    if (index < 0)
+        return;
+
+    bool hidden = isRowFiltered(index);
+
+    if (!hidden && group && group != m_topGroup) {
+        QicsExpandableStaticRowData *erow = group->headerRowData();
+        if (!erow || dimensionManager()->isRowHidden(group->headerModelIndex()))
+            hidden = true;
+        else if (index == group->summaryModelIndex())
+            hidden = erow->isRowHidden(index) ||
+                (!erow->isOpen() && m_summaryPolicy != SummaryAlwaysExpanded);
+        else
+            hidden = !erow->isOpen();
+    }
+
+    if (hidden)
+        dimensionManager()->hideRow(index);
+    else
+        dimensionManager()->showRow(index);
+}
+
+void QicsTreeTable::doAggregateGroups()
+{
+    m_aggregateValues.clear();
+
+    if (!m_summarizer || !m_groups.size() || m_summarizer->aggregates().isEmpty())
+        return;
+
+    QicsViewTreeDataModel *model = viewModel();
+    const int rows = m_userModel->numRows();
+
+    // take the values column by column, then add them row by row
+    const QMap<int, QicsSummarizer::Aggregate> &aggregates = m_summarizer->aggregates();
+    QMap<int, QicsSummarizer::Aggregate>::const_iterator it;
+    for (it = aggregates.constBegin(); it != aggregates.constEnd(); ++it) {
+        QVector<QicsGroupKey> &values = m_aggregateValues[it.key()];
+        values.resize(rows);
+        for (int row = 0; row < rows; ++row)
+            values[row] = QicsGroupKey(model->item(row, it.key()));
+    }
+
+    // all the groups, parents first
+    QList<QicsGroupInfo*> groups = m_topGroup->groups();
+    for (int i = 0; i < groups.size(); ++i) {
+        doInitAggregates(groups.at(i));
+        groups += groups.at(i)->groups();
+    }
+
+    QMap<int, QVector<QicsGroupKey> >::const_iterator vit;
+    for (int row = 0; row < rows; ++row)
+        for (QicsGroupInfo *gi = m_rowGroupMap.value(row); gi && gi != m_topGroup; gi = gi->parentGroup())
+            for (vit = m_aggregateValues.constBegin(); vit != m_aggregateValues.constEnd(); ++vit)
+                gi->m_aggregates[vit.key()].add(row, vit->at(row));
+
+    for (int i = 0; i < groups.size(); ++i)
+        doPublishAggregates(groups.at(i));
+}
+
+void QicsTreeTable::doInitAggregates(QicsGroupInfo *gi)
+{
+    gi->m_aggregates.clear();
+
+    if (!m_summarizer)
+        return;
+
+    QMap<int, QVector<QicsGroupKey> >::const_iterator it;
+    for (it = m_aggregateValues.constBegin(); it != m_aggregateValues.constEnd(); ++it) {
+        const QicsSummarizer::Aggregate func = m_summarizer->aggregate(it.key());
+        if (func != QicsSummarizer::NoAggregate)
+            gi->m_aggregates.insert(it.key(), QicsGroupAggregate(func));
+    }
+}
+
+void QicsTreeTable::doAggregateRow(int row, QicsGroupInfo *group, bool add)
+{
+    QicsViewTreeDataModel *model = viewModel();
+
+    QMap<int, QVector<QicsGroupKey> >::iterator it;
+    for (it = m_aggregateValues.begin(); it != m_aggregateValues.end(); ++it) {
+        QVector<QicsGroupKey> &values = *it;
+        if (row >= values.size())
+            values.resize(row + 1);
+
+        // rows are removed with the values they were added with
+        if (add)
+            values[row] = QicsGroupKey(model->item(row, it.key()));
+        const QicsGroupKey &key = values.at(row);
+
+        for (QicsGroupInfo *gi = group; gi && gi != m_topGroup; gi = gi->parentGroup()) {
+            QMap<int, QicsGroupAggregate>::iterator ait = gi->m_aggregates.find(it.key());
+            if (ait == gi->m_aggregates.end())
+                continue;
+
+            if (add)
+                ait->add(row, key);
+            else
+                ait->remove(row, key);
+        }
+    }
+}
+
+bool QicsTreeTable::doAggregateCell(int row, int col)
+{
+    QMap<int, QVector<QicsGroupKey> >::iterator it = m_aggregateValues.find(col);
+    if (it == m_aggregateValues.end() || row < 0)
+        return false;
+
+    if (row >= it->size())
+        it->resize(row + 1);
+
+    const QicsGroupKey key(viewModel()->item(row, col));
+    const QicsGroupKey old = it->at(row);
+    if (key == old)
+        return false;
+
+    (*it)[row] = key;
+
+    for (QicsGroupInfo *gi = m_rowGroupMap.value(row); gi && gi != m_topGroup; gi = gi->parentGroup()) {
+        QMap<int, QicsGroupAggregate>::iterator ait = gi->m_aggregates.find(col);
+        if (ait != gi->m_aggregates.end()) {
+            ait->remove(row, old);
+            ait->add(row, key);
+        }
+    }
+
+    return true;
+}
+
+void QicsTreeTable::doPublishAggregates(QicsGroupInfo *gi, int col)
+{
+    if (!m_summarizer || gi->summaryModelIndex() < 0)
+        return;
+
+    QMap<int, QicsGroupAggregate>::const_iterator it;
+    for (it = gi->m_aggregates.constBegin(); it != gi->m_aggregates.constEnd(); ++it) {
+        if (col != -1 && it.key() != col)
+            continue;
+
+        QicsDataItem *value = it->value();
+        m_summarizer->onAggregated(gi, it.key(), it->function(), value);
+        delete value;
+    }
+}
+
 QString QicsTreeTable::groupText(int id)
 {
     QicsDataModel* model = columnHeaderRef().gridInfo().dataModel();
@@ -648,39 +1210,180 @@ void QicsTreeTable::onCellValueChanged(int row, int col)
 
     // check if there is grouping by col
     if (m_groups.contains(col)) {
-        // regroup
-        QList<int> tmp(m_groups);
-        groupColumns(tmp);
-    } else {
+        QicsGroupInfo *group = m_rowGroupMap.value(row);
+
+        if (!canRegroupIncrementally() || !group) {
+            // regroup
+            QList<int> tmp(m_groups);
+            groupColumns(tmp);
+            return;
+        }
+
+        // move the row to the group of its new value; only the groups
+        // on the way are created, removed or summarized again
         setRepaintBehavior(Qics::RepaintOff);
-        doFilterTable();
+
+        doAggregateCell(row, col);
+
+        if (doAddRowToGroups(row, group) != group)
+            doRemoveRowFromGroup(row, group);
+        m_changedRows.insert(row);
+        doFilterChangedRows();
+        doRecalculateChangedGroups();
+
         doSortTable();
 
+        setRepaintBehavior(Qics::RepaintOn);
+        repaint();
+    } else {
+        setRepaintBehavior(Qics::RepaintOff);
+
+        // only the row can change its filter state, and only its group
+        // can get out of order
+        if (!m_groups.size())
+            doFilterTable();
+        else if (m_filters.count()) {
+            m_changedRows.insert(row);
+            doFilterChangedRows();
+        }
+        if (!m_groups.size() || m_sorted.contains(col)) {
+            doMarkGroupUnsorted(m_rowGroupMap.value(row));
+            doSortTable();
+        }
+
         // here we should handle summarizing...
+        if (doAggregateCell(row, col))
+            for (QicsGroupInfo *gi = m_rowGroupMap.value(row); gi && gi != m_topGroup; gi = gi->parentGroup())
+                doPublishAggregates(gi, col);
+
         if (m_summarizer)
-            m_summarizer->onCellValueChanged(row, col, m_rowGroupMap[row]);
+            m_summarizer->onCellValueChanged(row, col, m_rowGroupMap.value(row));
 
         setRepaintBehavior(Qics::RepaintOn);
         repaint();
     }
 }
 
+void QicsTreeTable::onCellValuesChanged(const QicsRegion &reg)
+{
+    const int top = qMax(reg.startRow(), 0);
+    const int bottom = qMin(reg.endRow(), m_userModel->numRows() - 1);
+    int left = qMax(reg.startColumn(), 0);
+    int right = qMin(reg.endColumn(), m_userModel->numColumns() - 1);
+    if (top > bottom || left > right)
+        return;
+
+    if (!m_treeInHeader) {
+        left++;
+        right++;
+    }
+
+    bool grouped = false, sorted = false;
+    for (int col = left; col <= right; ++col) {
+        grouped = grouped || m_groups.contains(col);
+        sorted = sorted || m_sorted.contains(col);
+    }
+
+    if (grouped) {
+        bool regroup = !canRegroupIncrementally();
+        for (int row = top; !regroup && row <= bottom; ++row)
+            regroup = !m_rowGroupMap.value(row);
+
+        if (regroup) {
+            QList<int> tmp(m_groups);
+            groupColumns(tmp);
+            return;
+        }
+    }
+
+    setRepaintBehavior(Qics::RepaintOff);
+
+    if (!m_groups.size()) {
+        doFilterTable();
+        doSortTable();
+    } else {
+        // one pass over the region; the groups touched are summarized,
+        // filtered and sorted once at the end
+        for (int row = top; row <= bottom; ++row) {
+            QicsGroupInfo *group = m_rowGroupMap.value(row);
+
+            for (int col = left; col <= right; ++col)
+                doAggregateCell(row, col);
+
+            if (grouped && doAddRowToGroups(row, group) != group) {
+                doRemoveRowFromGroup(row, group);
+                continue;
+            }
+
+            if (m_summarizer)
+                doMarkGroupChanged(group);
+            if (m_filters.count())
+                m_changedRows.insert(row);
+            if (sorted)
+                doMarkGroupUnsorted(group);
+        }
+
+        doFilterChangedRows();
+        doRecalculateChangedGroups();
+
+        if (grouped || sorted)
+            doSortTable();
+    }
+
+    setRepaintBehavior(Qics::RepaintOn);
+    repaint();
+}
+
 void QicsTreeTable::onRowsAdded(int count, int index)
 {
-    Q_UNUSED(index);
-    onRowsAdded(count);
+    if (!m_groups.size() || m_tmpGroups.size()) {
+        onRowsAdded(count);
+        return;
+    }
+
+    // The view model has moved the special rows behind the new rows,
+    // so renumber our indexes and place the new rows into groups.
+    setRepaintBehavior(Qics::RepaintOff);
+
+    doShiftRowIndexes(index, count);
+
+    for (int i = index; i < index + count; ++i)
+        doAddRowToGroups(i);
+    doFilterChangedRows();
+    doRecalculateChangedGroups();
+
+    doSortTable();
+
+    setRepaintBehavior(Qics::RepaintOn);
+    repaint();
 }
 
 void QicsTreeTable::beforeRowsAdded(int count, int index)
 {
-    Q_UNUSED(count);
-    Q_UNUSED(index);
+    if (!m_groups.size())
+        return;
 
-    if (m_groups.size()) {
+    if (!canRegroupIncrementally()) {
         // regroup
         m_tmpGroups = m_groups;
         setRepaintBehavior(Qics::RepaintOff);
         doUngroupTable();
+        return;
+    }
+
+    // rows are about to be deleted: take them out of their groups
+    // while their indexes are still valid
+    const int last = qMin(index - count, m_userModel->numRows());
+    if (count < 0 && index < last) {
+        setRepaintBehavior(Qics::RepaintOff);
+
+        for (int i = index; i < last; ++i) {
+            QicsGroupInfo *group = m_rowGroupMap.value(i);
+            if (group)
+                doRemoveRowFromGroup(i, group);
+            m_filteredRows.remove(i);
+            m_changedRows.remove(i);
+        }
     }
 }
 
@@ -699,14 +1402,25 @@ void QicsTreeTable::onRowsAdded(int count)
 
 void QicsTreeTable::onRowsRemoved(int count, int index)
 {
-    Q_UNUSED(count);
-    Q_UNUSED(index);
-
     if (m_tmpGroups.size()) {
         // regroup
         groupColumns(m_tmpGroups);
         m_tmpGroups.clear();
+        return;
     }
+
+    if (!m_groups.size())
+        return;
+
+    // the rows have left their groups in beforeRowsAdded()
+    doShiftRowIndexes(index + count, -count);
+    doFilterChangedRows();
+    doRecalculateChangedGroups();
+
+    doSortTable();
+
+    setRepaintBehavior(Qics::RepaintOn);
+    repaint();
 }
 
 void QicsTreeTable::onColumnsAdded(int count, int index)
@@ -864,12 +1578,12 @@ void QicsTreeTable::doFilterTable()
     if (!dataModel())
         return;
 
-    // unfilter all - ???
-    int rows = viewModel()->numRows();
-    for (int i = 0; i < rows; ++i)
-        rowRef(i).show();
-
     if (!m_groups.size()) {
+        // unfilter all
+        int rows = viewModel()->numRows();
+        for (int i = 0; i < rows; ++i)
+            rowRef(i).show();
+
 //        for (QMap<int, QicsAbstractFilterDelegate*>::const_iterator it = m_filters.constBegin(); it != m_filters.constEnd(); ++it) {
         for (QMap<int, QPointer<QicsAbstractFilterDelegate> >::const_iterator it = m_filters.constBegin(); it != m_filters.constEnd(); ++it) {
             QicsTable::setRowFilter(it.key(), it.value());
@@ -877,7 +1591,7 @@ void QicsTreeTable::doFilterTable()
         return;
     }
 
-    QMap<QString, QList<int> >::const_iterator it;
+    QMap<QicsGroupKey, QList<int> >::const_iterator it;
     QList<int> lr;
 
     // iterate over grouped columns to build m_filteredRows
@@ -890,9 +1604,9 @@ void QicsTreeTable::doFilterTable()
         if (!lf)
             continue;
 
-        const QMap<QString, QList<int> > data = m_groupData.value(group).content;//#90025
+        const QMap<QicsGroupKey, QList<int> > data = m_groupData.value(group).content;//#90025
         for (it = data.constBegin(); it != data.constEnd(); ++it) {
-            if (!lf->match(it.key(), -1, -1)) {
+            if (!lf->match(it.key().text(), -1, -1)) {
                 // get list of special rows
                 lr = it.value();
 
@@ -915,25 +1629,26 @@ void QicsTreeTable::doFilterTable()
         }
 
 
-    // hide all filtered rows
+    // Show or hide the rows of the open groups by the new filters.  The
+    // rows of closed groups are hidden anyway, so those are skipped.
     bool old_sig = dimensionManager()->emitSignals();
+    dimensionManager()->setEmitSignals(false);
 
-    for (int i = 0; i < m_filteredRows.size(); ++i)
-        rowRef(gridInfo().visualRowIndex(m_filteredRows.at(i))).hide();
+    for (int i = 0; i < m_topGroup->count(); ++i) {
+        QicsGroupInfo *gi = m_topGroup->childAt(i);
+        QicsExpandableStaticRowData *erow = gi->headerRowData();
+        if (!erow)
+            continue;
 
-    dimensionManager()->setEmitSignals(old_sig);
+        doUpdateRowVisibility(gi->headerModelIndex(), m_topGroup);
 
-    // restore tree state - reexpand top level items
-    const QMap<QString, QList<int> > data = m_groupData.value(m_groups.value(0)).content;//#90025
-    for (it = data.constBegin(); it != data.constEnd(); ++it) {
-        // get list of special rows
-        lr = it.value();
-        for (int j = 0; j < lr.size(); ++j) {
-            QicsExpandableStaticRowData *erow = qobject_cast<QicsExpandableStaticRowData*>(specialRowData(lr.value(j)));
-            if (erow)
-                erow->doExpand(erow->m_open, true, false);
-        }
+        if (erow->m_open)
+            erow->doExpand(true, false, false);
+        else
+            erow->doExpandSummary(true);
     }
+
+    dimensionManager()->setEmitSignals(old_sig);
 }
 
 bool QicsTreeTable::doFilterRowCheck(QicsExpandableStaticRowData *erow)
@@ -956,22 +1671,10 @@ bool QicsTreeTable::doFilterRowCheck(QicsExpandableStaticRowData *erow)
             } else
                 filter = false;
         } else {
-            bool pass = true;
-//            for (QMap<int, QicsAbstractFilterDelegate*>::iterator it = m_filters.begin(); it != m_filters.end(); ++it) {
-            for (QMap<int, QPointer<QicsAbstractFilterDelegate> >::iterator it = m_filters.begin(); it != m_filters.end(); ++it) {
-                if (!it.value())
-                    continue;
-                const int col = it.key();
-                const int row = idx;
-                QString s = viewModel()->itemString(row, col);
-                if (!it.value()->match(s, row, col)) {
-                    m_filteredRows.append(idx);
-                    pass = false;
-                    break;
-                }
-            }
-            if (pass)
+            if (doFilterRowPasses(idx))
                 filter = false;
+            else
+                m_filteredRows.insert(idx);
         }
     }
     return filter;
@@ -979,7 +1682,7 @@ bool QicsTreeTable::doFilterRowCheck(QicsExpandableStaticRowData *erow)
 
 void QicsTreeTable::doFilterRow(int index)
 {
-    m_filteredRows.append(index);
+    m_filteredRows.insert(index);
 
     QicsExpandableStaticRowData *erow = qobject_cast<QicsExpandableStaticRowData*>(specialRowData(index));
     if (!erow) return;
@@ -1001,6 +1704,7 @@ void QicsTreeTable::sortRows(QVector<int> colsnum, Qics::QicsSortOrder order,
     m_from = from;
     m_to = to;
     m_func = func;
+    m_groupsSorted = false;
 
     setRepaintBehavior(Qics::RepaintOff);
     doSortTable();
@@ -1013,6 +1717,7 @@ void QicsTreeTable::sortRows(QVector<int> colsnum, Qics::QicsSortOrder order,
 void QicsTreeTable::unsortRows()
 {
     m_sorted = QVector<int>();
+    m_groupsSorted = false;
 
     emit rowsSorted();
 }
@@ -1041,89 +1746,93 @@ void QicsTreeTable::doSortTable()
         return;
     }
 
-    // sort node items from all the groups
-    QVector<int> v;
-
-    // build list for the 1st group
-    GroupItem &gi = m_groupData[m_groups.first()];
-    QMap<QString, QList<int> >::const_iterator it;
-    QVector<int> list;
-    for (it = gi.content.begin(); it != gi.content.end(); ++it)
-        list.append(it.value().first());	// only 1 list item per key in 1st group
-
-    doProcessSort(list, v, 0);
-
-    gridInfo().rowOrdering()->reorder(v);
-
-    // sort leaf items from the last group
-    GroupItem &gi1 = m_groupData[m_groups.last()];
-    for (it = gi1.content.begin(); it != gi1.content.end(); ++it) {
-        for (int j = 0; j < it.value().count(); j++) {
-            QicsExpandableStaticRowData *erow = qobject_cast<QicsExpandableStaticRowData*>(specialRowData(it.value().at(j)));
-            if (!erow || erow->m_list.isEmpty()) continue;
-
-            int from = gridInfo().visualRowIndex(erow->m_list.first());
-            int to = gridInfo().visualRowIndex(erow->m_list.last())-1;   // -1 because skipping summary row
+    // m_groupData holds the values of the groups in order already, so a
+    // single pass over it gives the groups of every parent by value
+    GroupOrder ordered;
+    QMap<int, GroupItem>::const_iterator git;
+    QMap<QicsGroupKey, QList<int> >::const_iterator it;
+    for (git = m_groupData.constBegin(); git != m_groupData.constEnd(); ++git)
+        for (it = git->content.constBegin(); it != git->content.constEnd(); ++it)
+            for (int i = 0; i < it->size(); ++i) {
+                QicsGroupInfo *gi = m_rowGroupMap.value(it->at(i));
+                if (gi)
+                    ordered[gi->parentGroup()].append(gi);
+            }
 
-            gridInfo().orderRowsBy(m_sorted, m_sortOrder, from, to, m_func, true);
+    // build the new order of all the rows; the rows of the leaf groups
+    // which are not in order yet are collected in ranges to be sorted
+    // at once
+    QVector<int> v;
+    QVector<int> rows, bounds, offsets;
+    QList<QicsGroupInfo*> leaves;
+    doProcessSort(m_topGroup, ordered, v, rows, bounds, offsets, leaves);
+
+    if (!rows.isEmpty() && !m_sorted.isEmpty()) {
+        bounds.append(rows.size());
+        gridInfo().rowOrdering()->sortRanges(m_sorted, m_sortOrder, rows, bounds, m_func);
+
+        // keep them sorted in their groups too, for the next time
+        for (int i = 0; i < offsets.size(); ++i) {
+            qCopy(rows.constBegin() + bounds.at(i), rows.constBegin() + bounds.at(i+1),
+                v.begin() + offsets.at(i));
+            qCopy(rows.constBegin() + bounds.at(i), rows.constBegin() + bounds.at(i+1),
+                leaves.at(i)->headerRowData()->m_list.begin());
         }
     }
-}
 
-void QicsTreeTable::doProcessSort(QVector<int> l, QVector<int>& v, int deep)
-{
-    if (deep < m_groups.count()) {
-
-        int group = m_groups[deep];
-        if (m_sorted.contains(group)) {
-            /*	A quite slow place - we are building map ordered by unique keys
-            and then filling list of row indexes in appropriate order.
-            But to get column key from node row index, we are passing deep
-            through all the column items sequentally for every row.
-            This is slowdown...
-            Perhaps we should be able to use own sorter here?
-            */
-            GroupItem &gi = m_groupData[group];
-            QMap<QString, QList<int> >::const_iterator it;
-            QMap<QString, int> map;
-            for (int i = 0; i < l.count()-(!!deep); ++i) {            // -1 because skipping summary row
-                int idx = l[i];
-                for (it = gi.content.begin(); it != gi.content.end(); ++it)
-                    if ((*it).contains(idx)) {
-                        map[it.key()] = idx;
-                        break;
-                    }
-            }
+    m_unsortedGroups.clear();
+    m_groupsSorted = true;
 
-            // we have to remember the last item (as it is the summary row)
-            int last = l.last();
+    // install it with a single change of the order
+    gridInfo().rowOrdering()->reorder(v);
+    gridInfo().redrawAllGrids(Qics::RowIndex);
+}
 
-            // QMap holds items in ascending order - so we're just iterating here
-            l.clear();
-            QMap<QString, int>::const_iterator it1;
-            if (m_sortOrder == Qics::Ascending) {
-                for (it1 = map.begin(); it1 != map.end(); ++it1)
-                    l.append(*it1);
+void QicsTreeTable::doProcessSort(QicsGroupInfo *gi, const GroupOrder &ordered, QVector<int> &v,
+                                  QVector<int> &rows, QVector<int> &bounds, QVector<int> &offsets,
+                                  QList<QicsGroupInfo*> &leaves)
+{
+    if (gi != m_topGroup)
+        v.append(gi->m_hmi);
+
+    if (gi->count()) {
+        const bool sorted = m_sorted.contains(gi->childAt(0)->columnIndex());
+        GroupOrder::const_iterator it = ordered.constFind(gi);
+
+        // top level groups are in the order of their values anyway
+        if (it != ordered.constEnd() && (sorted || gi == m_topGroup)) {
+            const QList<QicsGroupInfo*> &groups = it.value();
+            if (sorted && m_sortOrder == Qics::Descending) {
+                for (int i = groups.size()-1; i >= 0; --i)
+                    doProcessSort(groups.at(i), ordered, v, rows, bounds, offsets, leaves);
             } else {
-                for (it1 = map.begin(); it1 != map.end(); ++it1)
-                    l.prepend(*it1);
+                for (int i = 0; i < groups.size(); ++i)
+                    doProcessSort(groups.at(i), ordered, v, rows, bounds, offsets, leaves);
             }
+        } else {
+            for (int i = 0; i < gi->count(); ++i)
+                doProcessSort(gi->childAt(i), ordered, v, rows, bounds, offsets, leaves);
+        }
+    } else if (gi != m_topGroup) {
+        const QVector<int> &list = gi->headerRowData()->children();
+        const int size = list.size()-1;   // -1 because skipping summary row
 
-            // and append the summary row as well
-            if (deep)
-                l.append(last);
+        if (m_groupsSorted && !m_unsortedGroups.contains(gi)) {
+            for (int i = 0; i < size; ++i)
+                v.append(list.at(i));
+        } else {
+            offsets.append(v.size());
+            bounds.append(rows.size());
+            leaves.append(gi);
+            for (int i = 0; i < size; ++i) {
+                v.append(list.at(i));
+                rows.append(list.at(i));
+            }
         }
     }
 
-    for (int i = 0; i < l.count(); ++i) {
-        v.append(l[i]);
-        QicsExpandableStaticRowData *erow = qobject_cast<QicsExpandableStaticRowData*>(specialRowData(l[i]));
-        if (!erow || erow->m_list.isEmpty())
-            continue;
-
-        QVector<int> l1(erow->m_list);
-        doProcessSort(l1, v, deep+1);
-    }
+    if (gi != m_topGroup)
+        v.append(gi->m_smi);
 }
 
 /////////////////////////////////////////////////////////////////////////////////
@@ -1249,12 +1958,16 @@ void QicsTreeTable::setSummarizer(QicsSummarizer *summarizer)
 {
     delete m_summarizer;
     m_summarizer = summarizer;
+
+    doAggregateGroups();
 }
 
 void QicsTreeTable::removeSummarizer()
 {
     delete m_summarizer;
     m_summarizer = 0;
+
+    doAggregateGroups();
 }
 
 
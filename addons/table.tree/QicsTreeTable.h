@@ -16,6 +16,7 @@
 #include <QicsTable.h>
 
 #include <QicsGroupInfo.h>
+#include <QicsGroupKey.h>
 #include <QicsTreeDataModel.h>
 
 /*!
@@ -514,8 +515,8 @@ public:
     /*!
     * Returns list of filtered rows.
     */
-    inline const QList<int> &filteredRows() const
-    { return m_filteredRows; }
+    inline QList<int> filteredRows() const
+    { return m_filteredRows.toList(); }
 
     /*!
     * Performs multicolumn sorting of rows by \a columns list,
@@ -619,6 +620,7 @@ protected:
         TreeItem(TreeItem *root = 0)	// -1 means special
         {
             row = -1;
+            parent = root;
             if (root)
                 root->list.append(this);
         }
@@ -630,20 +632,23 @@ protected:
         }
 
         QList<TreeItem*>	list;
+        // groups in list by their keys
+        QHash<QicsGroupKey, TreeItem*>	children;
+        TreeItem	*parent;
         int		row;
-        QString	content;
+        QicsGroupKey	key;
         int		group;
     };
 
 
     struct GroupItem
     {
-        void add(int _row, const QString& _content)
+        void add(int _row, const QicsGroupKey& _key)
         {
-            content[_content].append(_row);
+            content[_key].append(_row);
         }
 
-        QMap<QString, QList<int> > content;
+        QMap<QicsGroupKey, QList<int> > content;
     };
 
 signals:
@@ -837,6 +842,15 @@ protected slots:
     */
     void onCellValueChanged(int row, int col);
 
+    /*!
+    * Called when the values in region \a reg of the user model have
+    * changed in a batch of changes.  The groups touched are summarized
+    * again by QicsSummarizer::onGrouping() instead of calling
+    * QicsSummarizer::onCellValueChanged() for every cell.
+    * \since 3.1
+    */
+    void onCellValuesChanged(const QicsRegion &reg);
+
     /*!
     * Called after \a count rows have been added to the table at \a index.
     */
@@ -894,12 +908,141 @@ protected:
     */
     void doUngroupTable();
 
+    /*! \internal
+    * Replaces the groups of all levels under \a root by single level
+    * groups of their values, for the flat tree modes.
+    */
+    void doFlattenTree(TreeItem *root);
+
     /*! \internal
     * Converts the tree representation of the table contents into the rows.
     */
     void doConvertTree(TreeItem *ti, class QicsViewTreeDataModel* model, QVector<int> *ord, int deep,
         QicsExpandableStaticRowData *lastRow, QicsGroupInfo *group);
 
+    /*! \internal
+    * Returns true if changes of grouped values and inserted or deleted
+    * rows can be applied to the existing groups instead of regrouping.
+    */
+    inline bool canRegroupIncrementally() const
+    { return m_treeMode == Tree; }
+
+    /*! \internal
+    * Returns the child of \a parent grouping \a key of column \a col,
+    * or 0 if there is none.
+    */
+    QicsGroupInfo *doFindGroup(QicsGroupInfo *parent, int col, const QicsGroupKey &key) const;
+
+    /*! \internal
+    * Creates a group of \a key of column \a col at \a level under
+    * \a parent, with its header and summary rows.
+    */
+    QicsGroupInfo *doCreateGroup(QicsGroupInfo *parent, int level, int col, const QicsGroupKey &key);
+
+    /*! \internal
+    * Hides row \a index, just put into \a group, if the group is
+    * closed or hidden.
+    */
+    void doHideInClosedGroup(int index, QicsGroupInfo *group);
+
+    /*! \internal
+    * Adds data row \a row to the group of its values, creating the
+    * groups which do not exist yet, and returns that group.  Does nothing
+    * if the row belongs to \a current.
+    */
+    QicsGroupInfo *doAddRowToGroups(int row, QicsGroupInfo *current = 0);
+
+    /*! \internal
+    * Removes data row \a row from \a group, and removes the groups
+    * which are left empty.
+    */
+    void doRemoveRowFromGroup(int row, QicsGroupInfo *group);
+
+    /*! \internal
+    * Removes the empty \a group with its header and summary rows.
+    */
+    void doRemoveGroup(QicsGroupInfo *group);
+
+    /*! \internal
+    * Removes special row \a index of a group and renumbers the rows after it.
+    */
+    void doRemoveGroupRow(int index);
+
+    /*! \internal
+    * Adds \a delta to every row index kept for the groups which is not
+    * less than \a from.
+    */
+    void doShiftRowIndexes(int from, int delta);
+
+    /*! \internal
+    * Called by doShiftRowIndexes() for \a gi and its subgroups.
+    */
+    void doShiftGroupIndexes(QicsGroupInfo *gi, int from, int delta);
+
+    /*! \internal
+    * Marks \a gi and its parent groups for summarizing.
+    */
+    void doMarkGroupChanged(QicsGroupInfo *gi);
+
+    /*! \internal
+    * Calls the summarizer for the groups marked by doMarkGroupChanged().
+    */
+    void doRecalculateChangedGroups();
+
+    /*! \internal
+    * Filters the rows marked in m_changedRows and the groups on their way
+    * to the top, along with the groups marked by doMarkGroupChanged(),
+    * and shows or hides them.  The rest of the table is left alone.
+    */
+    void doFilterChangedRows();
+
+    /*! \internal
+    * Returns \a true if the value of \a gi or of one of its parent groups
+    * is filtered off.
+    */
+    bool doFilterGroupKeyCheck(QicsGroupInfo *gi);
+
+    /*! \internal
+    * Returns \a true if data row \a index passes all the filters.
+    */
+    bool doFilterRowPasses(int index);
+
+    /*! \internal
+    * Shows or hides row \a index of \a group (header rows of top level
+    * groups belong to the top group) according to the filters and to
+    * the state of the group.
+    */
+    void doUpdateRowVisibility(int index, QicsGroupInfo *group);
+
+    /*! \internal
+    * Takes the values of the columns summarized by the summarizer and
+    * computes the aggregates of all the groups.
+    */
+    void doAggregateGroups();
+
+    /*! \internal
+    * Sets the aggregates of the summarizer to \a gi, without values.
+    */
+    void doInitAggregates(QicsGroupInfo *gi);
+
+    /*! \internal
+    * Adds the values of data row \a row to the aggregates of \a group
+    * and its parents if \a add is true, removes them otherwise.
+    */
+    void doAggregateRow(int row, QicsGroupInfo *group, bool add);
+
+    /*! \internal
+    * Moves the aggregates of the groups of \a row from the old value of
+    * cell \a row, \a col to the new one.  Returns true if they changed.
+    */
+    bool doAggregateCell(int row, int col);
+
+    /*! \internal
+    * Passes the aggregates of \a gi, or only that of \a col if it is
+    * not -1, to the summarizer.
+    */
+    void doPublishAggregates(QicsGroupInfo *gi, int col = -1);
+
     /*! \internal
     * Filters the entire table with the current installed filters.
     */
@@ -917,10 +1060,24 @@ protected:
     */
     void doSortTable();
 
+    typedef QHash<QicsGroupInfo*, QList<QicsGroupInfo*> > GroupOrder;
+
+    /*! \internal
+    * Called by doSortTable(), appends the rows of \a gi to \a v, with
+    * the child groups taken from \a ordered if they are sorted.  The rows
+    * of leaf groups which are to be sorted are also appended to \a rows
+    * and the groups to \a leaves; \a bounds and \a offsets get where
+    * each of them starts in \a rows and in \a v.
+    */
+    void doProcessSort(QicsGroupInfo *gi, const GroupOrder &ordered, QVector<int> &v,
+        QVector<int> &rows, QVector<int> &bounds, QVector<int> &offsets,
+        QList<QicsGroupInfo*> &leaves);
+
     /*! \internal
-    * Called by doSortTable(), makes actual sorting of the rows.
+    * Marks the leaf group \a gi to be sorted again by the next
+    * doSortTable().
     */
-    void doProcessSort(QVector<int> l, QVector<int>& v, int deep);
+    void doMarkGroupUnsorted(QicsGroupInfo *gi);
 
     /*! \internal
     * Expands or collapses all the tree items according to \a expand.
@@ -958,11 +1115,21 @@ protected:
     QMap<int, GroupItem> m_groupData;
     QicsGroupInfo *m_topGroup;
     QMap<int, QicsGroupInfo*> m_rowGroupMap;
+    QSet<QicsGroupInfo*> m_changedGroups;
+    // data rows which were added or changed since they were filtered
+    QSet<int> m_changedRows;
+    // values of the summarized columns by data row, to take them out of
+    // the aggregates when they change
+    QMap<int, QVector<QicsGroupKey> > m_aggregateValues;
 //    QMap<int, QicsAbstractFilterDelegate*>  m_filters;
         QMap<int, QPointer<QicsAbstractFilterDelegate> >  m_filters;
-    QList<int> m_filteredRows;
+    QSet<int> m_filteredRows;
 
     QVector<int> m_sorted;
+    // the leaf groups keep their rows sorted by m_sorted, except those
+    // in m_unsortedGroups, while m_groupsSorted is set
+    bool m_groupsSorted;
+    QSet<QicsGroupInfo*> m_unsortedGroups;
     QicsSortOrder m_sortOrder;
     int m_from;
     int m_to;
@@ -14,6 +14,7 @@
 #define QICSABSTRACTSORTERDELEGATE_H
 
 #include <Qt>
+#include <QVector>
 #include "QicsNamespace.h"
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -34,6 +35,7 @@
 
 class QicsDataItem;
 class QicsDataModel;
+class QicsSortKeyColumn;
 
 class QICS_EXPORT QicsAbstractSorterDelegate : public QObject
 {
@@ -50,6 +52,21 @@ public:
     */
     virtual int compare(const int &index1, const int &index2, const int &sortIndex) = 0;
 
+    /*!
+    * Fills \a keys with the sort keys of the model indices \a indices
+    * for \a sortIndex.  \a keys has already been reset to the size of
+    * the model, to the current sort order and to #sortingSensitivity().
+    *
+    * If the order defined by #compare() can be expressed with
+    * QicsSortKeyColumn keys, reimplement this method and return \b true.
+    * The sorter then extracts the keys once and compares them instead of
+    * calling #compare() for every pair of items.  The default
+    * implementation returns \b false.
+    * \since 3.1
+    */
+    virtual bool buildSortKeys(const QVector<int> &indices, int sortIndex,
+        QicsSortKeyColumn &keys);
+
 protected:
     int stringCompare(const QString &str1, const QString &str2);
     inline Qics::QicsSortOrder sortOrder() const {return m_sortOrder;}
@@ -68,7 +85,6 @@ private:
     Qics::QicsIndexType	m_type;		// row or column indicator
 
     friend class QicsSorter;
-    friend int delegateCompare(const int &_a, const int &_b);
 };
 
 #endif //QICSABSTRACTSORTERDELEGATE_H
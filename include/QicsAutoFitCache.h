@@ -0,0 +1,115 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#ifndef QICSAUTOFITCACHE_H
+#define QICSAUTOFITCACHE_H
+
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+#include "QicsRegion.h"
+
+class QicsDataModel;
+
+/*! \file */
+
+/*!
+* \internal
+* \class QicsAutoFitCache QicsAutoFitCache.h
+* \brief Remembers the content widths measured when fitting columns.
+*
+* Fitting a column to its contents asks the cell display of every cell
+* in the column for its size hint.  QicsAutoFitCache keeps the widths
+* that were measured, by model row and model column, so that fitting the
+* same column again only measures the cells which changed in between.
+*
+* The cache follows the data model it is attached to: changed cells are
+* forgotten, and inserted or deleted rows and columns shift the entries
+* which follow them, and a new model size reported without them drops
+* everything.  The widths of a column are also forgotten when the style
+* revision or the width of that column differ from those they were
+* measured with, see validateColumn().
+* \since 3.1
+*/
+class QICS_EXPORT QicsAutoFitCache : public QObject
+{
+    Q_OBJECT
+public:
+    /*!
+    * Constructs an empty cache.
+    */
+    QicsAutoFitCache(QObject *parent = 0);
+
+    /*!
+    * Attaches the cache to \a dm and removes all entries.
+    */
+    void setDataModel(QicsDataModel *dm);
+
+    /*!
+    * Removes the entries of model column \a col if they were measured
+    * with a style revision other than \a style_revision or a column
+    * width other than \a column_width, and records both for the entries
+    * stored from now on.  \a style_revision is meant to be the
+    * QicsStyleManager::columnStyleRevision() of the column, so that
+    * style changes elsewhere keep the entries.
+    */
+    void validateColumn(int col, int column_width, uint style_revision);
+
+    /*!
+    * Returns the width measured for the cell at model row \a row and
+    * model column \a col, or -1 if it has not been measured.
+    */
+    inline int width(int row, int col) const
+    {
+        if (row < 0 || col < 0 || col >= myColumns.size())
+            return -1;
+
+        const QVector<int> &widths = myColumns.at(col).widths;
+        return (row < widths.size() ? widths.at(row) - 1 : -1);
+    }
+
+    /*!
+    * Stores \a width for the cell at model row \a row and model column
+    * \a col.
+    */
+    void setWidth(int row, int col, int width);
+
+public slots:
+    /*!
+    * Removes all entries.
+    */
+    void clear();
+
+protected slots:
+    void handleModelChanged(const QicsRegion &reg);
+    void handleRowsInserted(int num, int pos);
+    void handleRowsDeleted(int num, int pos);
+    void handleColumnsInserted(int num, int pos);
+    void handleColumnsDeleted(int num, int pos);
+    void handleModelSizeChanged(int rows, int cols);
+
+private:
+    struct Column
+    {
+        Column() : columnWidth(-1), styleRevision(0) {}
+
+        // width + 1 of each row, so that 0 marks a row not measured yet
+        QVector<int> widths;
+        int columnWidth;
+        uint styleRevision;
+    };
+
+    QPointer<QicsDataModel> myDataModel;
+    QVector<Column> myColumns;
+};
+
+#endif //QICSAUTOFITCACHE_H
@@ -25,6 +25,7 @@
 //
 
 #include "QicsShared.h"
+#include "QicsTextLayoutCache.h"
 
 class QLineEdit;
 class QStyle;
@@ -79,6 +80,8 @@ public:
     }
 
     QLineEdit *lineEdit;
+    // shared by all text cell displays, like lineEdit
+    QicsTextLayoutCache layoutCache;
 };
 
 #endif //QICSCELLDISPLAY_P_H
@@ -410,6 +410,7 @@ protected slots:
     void handleModelColumnInsert(int ncols, int pos);
     void handleModelColumnDelete(int ncols, int pos);
     void handleOrderChanged(Qics::QicsIndexType type, int* visChange, int size);
+    void handleItemMoved(Qics::QicsIndexType type, int from, int to);
     void changeDataModel(QicsDataModel *old_dt, QicsDataModel *new_dt);
     //void gridDeleted();
 
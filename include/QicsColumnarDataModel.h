@@ -0,0 +1,235 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#ifndef QICSCOLUMNARDATAMODEL_H
+#define QICSCOLUMNARDATAMODEL_H
+
+#include <QString>
+#include <QVector>
+#include <QDate>
+#include "QicsDataModel.h"
+#include "QicsDataItem.h"
+
+class QicsColumnarColumn;
+
+/*!
+* \class QicsColumnarDataModel QicsColumnarDataModel.h
+* \brief A compact, column-oriented implementation of the QicsDataModel interface.
+*
+*    This model keeps every column as a contiguous, typed array instead of
+*    storing a separately allocated QicsDataItem for every cell.  A column
+*    holds either doubles, 64-bit integers, booleans, dates or strings.
+*    Strings are dictionary-encoded: every distinct value is stored once per
+*    column and cells only keep an integer id.  Empty cells are tracked in a
+*    null bitmap, so the memory used by a column is proportional to the
+*    number of rows and does not depend on how many cells are set.
+*
+*    The type of a column is defined by calling #setColumnType().  A column
+*    with type #AutoColumn picks its type from the first data item stored
+*    into it.  Data items which do not match the type of the column are
+*    converted, and stored as empty cells if the conversion is not possible.
+*    Integer items of any size are stored as 64-bit values, and float items
+*    are stored as doubles.
+*
+*    This model implementation is column-oriented.  Inserting and deleting
+*    columns does not touch the data of other columns and costs the same
+*    regardless of the number of rows.  Operations on whole rows
+*    (#insertRows(), #deleteRows(), #rowItems()) have to visit every column.
+*
+*    Data items are only created when they are requested through #item(),
+*    #rowItems() or #columnItems().  As allowed by the QicsDataModel API,
+*    the item returned by #item() is owned by the model and reused by
+*    subsequent calls, so it must be cloned if it is needed for a longer
+*    time.  Vectors returned by #rowItems() and #columnItems() stay valid
+*    until the next call to one of these methods.
+*
+*    Here is an example of data model creation and usage.
+\code
+QicsColumnarDataModel *columns = new QicsColumnarDataModel(1000000, 3);
+columns->setColumnType(0, QicsColumnarDataModel::StringColumn);
+columns->setColumnType(1, QicsColumnarDataModel::DoubleColumn);
+columns->setColumnType(2, QicsColumnarDataModel::Int64Column);
+
+QicsDataModel *data_table = columns;
+
+for(int row = 0; row < 1000000; ++row)
+{
+    data_table->setItem(row, 0, QString("SYM%1").arg(row % 500));
+    data_table->setItem(row, 1, row * 0.25);
+    data_table->setItem(row, 2, qlonglong(row));
+}
+\endcode
+* \since 3.1
+*/
+////////////////////////////////////////////////////
+
+/*! \file */
+
+////////////////////////////////////////////////////
+
+class QICS_EXPORT QicsColumnarDataModel: public QicsDataModel
+{
+    Q_OBJECT
+public:
+    /*!
+    * Specifies the storage type of a column.
+    * \arg \b AutoColumn The type is chosen by the first item stored in the column.
+    * \arg \b DoubleColumn Values are stored as doubles.
+    * \arg \b Int64Column Values are stored as 64-bit integers.
+    * \arg \b BoolColumn Values are stored as bits.
+    * \arg \b DateColumn Values are stored as julian days.
+    * \arg \b StringColumn Values are stored as ids into a per-column string dictionary.
+    */
+    enum ColumnType {
+        AutoColumn = 0,
+        DoubleColumn,
+        Int64Column,
+        BoolColumn,
+        DateColumn,
+        StringColumn
+    };
+
+    /*!
+    * Constructor.  All columns initially have the #AutoColumn type.
+    */
+    QicsColumnarDataModel(int num_rows = 0, int num_cols = 0,
+        QObject *parent = 0);
+    virtual ~QicsColumnarDataModel();
+
+    /*!
+    * Returns the storage type of column \a col.
+    */
+    ColumnType columnType(int col) const;
+
+    /*!
+    * Sets the storage type of column \a col to \a type.  Values already
+    * stored in the column are converted to the new type.  Values which
+    * can not be converted are cleared.  Setting the type to #AutoColumn
+    * clears the column.
+    */
+    void setColumnType(int col, ColumnType type);
+
+    /*!
+    * Returns \b true if cell (\a row, \a col) contains no value.
+    * This is faster than checking the result of #item() for 0.
+    */
+    bool isNull(int row, int col) const;
+
+    /*!
+    * Returns the value of cell (\a row, \a col) as a double without creating
+    * a data item.  \a ok is set to \b false if the cell is empty or
+    * the value can not be converted to a number.
+    */
+    double number(int row, int col, bool *ok = 0) const;
+
+    /*!
+    * Returns the number of distinct strings stored in the dictionary of
+    * string column \a col, or 0 if \a col is not a string column.
+    */
+    int dictionarySize(int col) const;
+
+    /*!
+    * Removes the strings which are no longer referenced by any cell from
+    * the dictionary of string column \a col.
+    */
+    void compactDictionary(int col);
+
+    virtual const QicsDataItem *item(int row, int col) const;
+    virtual QString itemString(int row, int col) const;
+    virtual QicsDataModelRow rowItems(int row, int first_col, int last_col) const;
+    virtual QicsDataModelColumn columnItems(int col, int first_row, int last_row) const;
+
+    virtual void setColumnItems(int col, const QicsDataModelColumn &v);
+    virtual void setRowItems(int row, const QicsDataModelRow &v);
+
+    virtual bool isRowEmpty(int row) const;
+    virtual bool isColumnEmpty(int column) const;
+    virtual bool isCellEmpty(int row, int col) const;
+
+    /*!
+    * Foundry method to create new instances of QicsColumnarDataModel.
+    * Methods of this type can be passed to a QicsTable constructor in
+    * order to create custom data models for row and column headers.
+    */
+    static QicsDataModel *create(int num_rows = 0 , int num_cols = 0, QObject *parent = 0);
+
+public slots:
+    virtual void setItem(int row, int col, const QicsDataItem &item);
+
+    virtual void insertColumns(int number_of_columns, int starting_position);
+    virtual void insertRows(int number_of_rows, int starting_position);
+    virtual void addColumns(int num);
+    virtual void addRows(int num);
+
+    virtual void clearItem (int row, int col);
+    virtual void clearModel();
+    virtual void deleteRow (int row);
+    virtual void deleteColumn (int col);
+    virtual void deleteRows(int num_rows, int start_row);
+    virtual void deleteColumns(int num_cols, int start_col);
+
+protected:
+    /*!
+    * \internal
+    * Stores \a it into cell (\a row, \a col) without emitting any signal.
+    */
+    void storeItem(int row, int col, const QicsDataItem &it);
+
+    /*!
+    * \internal
+    * Returns a newly allocated data item holding the value of
+    * cell (\a row, \a col), or 0 if the cell is empty.
+    */
+    QicsDataItem *createItem(int row, int col) const;
+
+    /*!
+    * \internal
+    * Drops data items handed out by #rowItems() and #columnItems().
+    */
+    void releaseScratchItems() const;
+
+    /*!
+    *\internal
+    * The column storage.  Columns are never shared, a 0 pointer
+    * is never stored here.
+    */
+    QVector<QicsColumnarColumn *> myColumns;
+
+private:
+    /*!
+    * \internal
+    * Number of reusable item sets returned by #item().
+    */
+    enum { ItemSlots = 4 };
+
+    /*!
+    * \internal
+    * Reusable items which are returned by #item().  The slots are used
+    * in round-robin order, so that a few items may be held at the same time.
+    */
+    mutable QicsDataDouble myDoubleItems[ItemSlots];
+    mutable QicsDataLongLong myInt64Items[ItemSlots];
+    mutable QicsDataBool myBoolItems[ItemSlots];
+    mutable QicsDataDate myDateItems[ItemSlots];
+    mutable QicsDataString myStringItems[ItemSlots];
+    mutable int myItemSlot;
+
+    /*!
+    * \internal
+    * Items created for #rowItems() and #columnItems().
+    */
+    mutable QVector<QicsDataItem *> myScratchItems;
+};
+
+#endif //QICSCOLUMNARDATAMODEL_H
+
+
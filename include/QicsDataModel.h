@@ -20,6 +20,7 @@
 #include "QicsNamespace.h"
 #include "QicsDataItem.h"
 #include "QicsRegion.h"
+#include "QicsDirtyRegionSet.h"
 
 
 /*! \file */
@@ -255,6 +256,42 @@ public:
     */
     inline void notifyRegionChanged(const QicsRegion &reg) { emit modelChanged(reg); }
 
+    /*!
+    * Starts a batch of changes.  Until the matching endBatch() call,
+    * the model collects the cells whose values change instead of
+    * emitting #modelChanged() and #cellValueChanged() for every one of
+    * them, and emits #modelSizeChanged() only once.  At the end of the
+    * batch, #modelChanged() and #cellValuesChanged() are emitted once
+    * for each of a few merged regions which cover every changed cell;
+    * #cellValueChanged() is not emitted for the cells of a batch.
+    *
+    * Rows and columns which are inserted or deleted during a batch are
+    * still reported at once, so that sorters, style and dimension managers
+    * stay in step with the model.  The changes collected up to that
+    * point are reported first, while their coordinates are still valid.
+    *
+    * Unlike setEmitSignals(false), a batch does not lose any change.
+    * Batches may be nested; only the outermost endBatch() reports the
+    * changes.
+    * \sa endBatch(), QicsDataModelBatch
+    * \since 3.1
+    */
+    void beginBatch();
+
+    /*!
+    * Ends a batch of changes started by beginBatch(), and reports the
+    * changes collected since.
+    * \since 3.1
+    */
+    void endBatch();
+
+    /*!
+    * Returns \b true if a batch of changes is in progress.
+    * \sa beginBatch()
+    * \since 3.1
+    */
+    inline bool isInBatch() const { return (myBatchDepth > 0); }
+
     /*!
     * Returns true if \a row does not contain any data, false otherwise.
     * Should be reimplemented in real data model.
@@ -625,6 +662,14 @@ signals:
     */
     void cellValueChanged( int row, int col );
     /*!
+    * This signal is emitted at the end of a batch of changes, once for
+    * every merged region \a reg that covers cells whose values changed
+    * during the batch.  It replaces #cellValueChanged() for those cells.
+    * \sa QicsDataModel::beginBatch()
+    * \since 3.1
+    */
+    void cellValuesChanged(const QicsRegion &reg);
+    /*!
     * This signal is emitted when data in the model start to change rows size.
     * it is not emitted on creation or destruction of the model.
     * If \a num_rows < 0 rows ere preparing for deletion, otherwise inserting.
@@ -655,6 +700,50 @@ protected:
     */
     inline void setNumColumns(int ncols) { myNumColumns = ncols; }
 
+    /*!
+    * \internal
+    * Reports that the value of cell (\a row, \a col) changed, by
+    * emitting #modelChanged() and #cellValueChanged(), or by collecting
+    * the cell during a batch.  Does nothing if signals are off.
+    * \since 3.1
+    */
+    void reportCellChanged(int row, int col);
+
+    /*!
+    * \internal
+    * Reports that the values in \a reg changed, by emitting
+    * #modelChanged() or by collecting the region during a batch.
+    * Does nothing if signals are off.
+    * \since 3.1
+    */
+    void reportRegionChanged(const QicsRegion &reg);
+
+    /*!
+    * \internal
+    * Reports that \a num rows or columns (depending on \a type) were
+    * inserted at \a position, or deleted if \a num is negative, by
+    * emitting #modelSizeChanged().  During a batch, only one
+    * #modelSizeChanged() is emitted at the end.
+    * \since 3.1
+    */
+    void reportSizeChanged(int position, int num, Qics::QicsIndexType type);
+
+    /*!
+    * \internal
+    * Reports that the size of the model changed, by emitting
+    * #modelSizeChanged() now or at the end of the batch.
+    * \since 3.1
+    */
+    void reportSizeChanged();
+
+    /*!
+    * \internal
+    * Emits the changes of values collected so far in the current batch.
+    * Subclasses call this before inserting or deleting rows or columns.
+    * \since 3.1
+    */
+    void flushBatchedChanges();
+
     /*!
     * \internal
     * The number of columns in the model
@@ -674,6 +763,13 @@ protected:
     bool m_emitSignals;
 
 private:
+    // nesting depth of beginBatch() calls
+    int myBatchDepth;
+    // regions changed during the current batch
+    QicsDirtyRegionSet myBatchRegions;
+    // set if the size of the model changed during the current batch
+    bool myBatchSizeChanged;
+
     /*!
     * \internal
     * This method should never be called.  That's why it's private.
@@ -698,6 +794,45 @@ inline bool QicsDataModel::contains(int row, int col) const
         row < 0 || col < 0)? false: true );
 }
 
+
+/*!
+* \class QicsDataModelBatch QicsDataModel.h
+* \brief Groups the changes made to a data model within a scope.
+*
+* QicsDataModelBatch calls QicsDataModel::beginBatch() when it is
+* constructed and QicsDataModel::endBatch() when it is destroyed:
+*
+* \code
+* {
+*     QicsDataModelBatch batch(model);
+*     for (int i = 0; i < quotes.size(); ++i)
+*         model->setItem(quotes[i].row, 2, quotes[i].price);
+* } // one modelChanged() per merged region is emitted here
+* \endcode
+* \since 3.1
+*/
+class QICS_EXPORT QicsDataModelBatch
+{
+public:
+    explicit QicsDataModelBatch(QicsDataModel *model)
+        : myModel(model)
+    {
+        if (myModel)
+            myModel->beginBatch();
+    }
+
+    ~QicsDataModelBatch()
+    {
+        if (myModel)
+            myModel->endBatch();
+    }
+
+private:
+    Q_DISABLE_COPY(QicsDataModelBatch)
+
+    QicsDataModel *myModel;
+};
+
 #endif //QICSDATAMODEL_H
 
 
@@ -20,6 +20,7 @@
 #include <QDomElement>
 #include "QicsNamespace.h"
 #include "QicsGridInfo.h"
+#include "QicsIndexSet.h"
 
 /*!
 * \internal
@@ -615,6 +616,34 @@ public:
     */
     bool isColumnHidden(int col) const;
 
+    /*!
+    * Returns the first row at or after \a row which is not hidden.
+    * Runs of hidden rows are skipped in O(log n) time.
+    * \since 3.1
+    */
+    int nextVisibleRow(int row) const;
+
+    /*!
+    * Returns the last row at or before \a row which is not hidden,
+    * or -1 if there is none.
+    * \since 3.1
+    */
+    int previousVisibleRow(int row) const;
+
+    /*!
+    * Returns the first column at or after \a col which is not hidden.
+    * Runs of hidden columns are skipped in O(log n) time.
+    * \since 3.1
+    */
+    int nextVisibleColumn(int col) const;
+
+    /*!
+    * Returns the last column at or before \a col which is not hidden,
+    * or -1 if there is none.
+    * \since 3.1
+    */
+    int previousVisibleColumn(int col) const;
+
     inline void setCellWidthMode(QicsCellWidthMode mode) {myCellWidthMode=mode;}
 
     inline QicsCellWidthMode cellWidthMode() const { return myCellWidthMode; }
@@ -635,6 +664,22 @@ public:
     */
     inline void setEmitSignals(bool b)  { myEmitSignalsFlag = b; }
 
+    /*!
+    * \internal
+    * Returns a counter which changes whenever the set of hidden rows or
+    * the number of rows changes without dimensionChanged() being emitted.
+    * \since 3.1
+    */
+    uint rowRevision() const;
+
+    /*!
+    * \internal
+    * Returns a counter which changes whenever the set of hidden columns or
+    * the number of columns changes without dimensionChanged() being emitted.
+    * \since 3.1
+    */
+    uint columnRevision() const;
+
 public slots:
     /*!
     * \internal
@@ -1419,8 +1464,8 @@ protected:
     QicsOverrideSettingL myRowOverrides;
     QicsOverrideSettingL myColumnOverrides;
 
-    QSet<int> myHiddenRows;
-    QSet<int> myHiddenColumns;
+    QicsIndexSet myHiddenRows;
+    QicsIndexSet myHiddenColumns;
 
     /*!
     * \internal
@@ -1524,6 +1569,14 @@ protected:
     */
     bool myEmitSignalsFlag;
 
+    /*!
+    * \internal
+    * Bumped on row/column changes that are not announced by
+    * dimensionChanged().
+    */
+    uint myRowRevision;
+    uint myColumnRevision;
+
     QVector< QMap<int, int> > myFontSizeVector;
 
     friend class QicsDimensionManager::QicsRowHeight;
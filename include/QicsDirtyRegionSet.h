@@ -0,0 +1,83 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#ifndef QICSDIRTYREGIONSET_H
+#define QICSDIRTYREGIONSET_H
+
+#include <QVector>
+#include "QicsRegion.h"
+
+/*! \file */
+
+/*!
+* \class QicsDirtyRegionSet QicsDirtyRegionSet.h
+* \brief A small set of disjoint regions that need to be repainted.
+*
+* Every region added to the set is merged with the regions it overlaps.
+* It is also merged with any region whose bounding region with it covers
+* no more cells than the two of them, so adjacent cells of a row or a
+* column collapse into one region.  Regions far apart are kept separate,
+* so that two changing cells at opposite corners of a grid do not cause
+* the whole grid to be repainted.
+*
+* When there would be more than maxRegions() regions, the two regions
+* whose bounding region adds the fewest cells are merged.
+* \since 3.1
+*/
+class QICS_EXPORT QicsDirtyRegionSet
+{
+public:
+    /*!
+    * Constructs an empty set which keeps at most \a max_regions regions.
+    */
+    explicit QicsDirtyRegionSet(int max_regions = 16);
+
+    /*!
+    * Returns the largest number of regions the set keeps.
+    */
+    inline int maxRegions() const { return myMaxRegions; }
+
+    /*!
+    * Returns \b true if the set has no regions.
+    */
+    inline bool isEmpty() const { return myRegions.isEmpty(); }
+
+    /*!
+    * Returns the regions in the set.  No two of them overlap.
+    */
+    inline const QVector<QicsRegion> &regions() const { return myRegions; }
+
+    /*!
+    * Removes all regions.
+    */
+    void clear();
+
+    /*!
+    * Adds \a reg to the set.  Invalid regions are ignored.
+    */
+    void add(const QicsRegion &reg);
+
+    /*!
+    * Returns the bounding region of all regions in the set, or an
+    * invalid region if the set is empty.
+    */
+    QicsRegion boundingRegion() const;
+
+private:
+    // adds reg, merging it with the regions it should be merged with
+    void merge(QicsRegion reg);
+
+    QVector<QicsRegion> myRegions;
+    int myMaxRegions;
+};
+
+#endif //QICSDIRTYREGIONSET_H
@@ -14,6 +14,7 @@
 #define QICSGRID_H
 
 #include <QVector>
+#include <QtAlgorithms>
 #include "QicsGridInfo.h"
 #include "QicsRegion.h"
 #include "QicsICell.h"
@@ -41,55 +42,72 @@ public:
     QicsPositionList(int base)  { setFirstIndex(base); init(); }
 
     inline int firstIndex() const  { return myBase; }
-    inline void setFirstIndex(int base)  { myBase = base; }
+    inline void setFirstIndex(int base)  { myBase = base; myEnd = base; }
 
-    inline int lastIndex() const { return myBase + size() - 1; }
+    inline int lastIndex() const { return myEnd - 1; }
 
+    /*!
+    * Appends the position of the next visible index.
+    */
     inline void push_back(const int &val)
-    { myPositions.push_back(val); }
+    {
+        myIndexes.push_back(myEnd);
+        myPositions.push_back(val);
+        ++myEnd;
+    }
+
+    /*!
+    * Appends \a num hidden indices, whatever their number, in O(1) time.
+    */
+    inline void skip(int num) { myEnd += num; }
 
     inline int at(int idx) const;
 
     inline int operator[](int idx) const { return at(idx); }
 
-    inline void clear() { myPositions.clear(); }
+    inline void clear() { myIndexes.clear(); myPositions.clear(); myEnd = myBase; }
 
-    inline int size() const { return myPositions.size(); }
+    inline int size() const { return myEnd - myBase; }
 
+    /*!
+    * Iterates over the positions of the visible indices only.
+    */
     inline iterator begin() const { return myPositions.begin(); }
     inline iterator end() const { return myPositions.end(); }
 
-    inline int firstVisible() const;
-    inline int lastVisible() const;
+    inline int firstVisible() const
+    { return (myIndexes.isEmpty() ? -1 : myIndexes.first()); }
+    inline int lastVisible() const
+    { return (myIndexes.isEmpty() ? -1 : myIndexes.last()); }
 
 protected:
-    inline void init() { myPositions.reserve(50); }
+    inline void init() { myIndexes.reserve(50); myPositions.reserve(50); }
+
+    // Only visible indices are stored, so that long runs of
+    // hidden rows or columns take no space.
+    QVector<int> myIndexes;
     QVector<int> myPositions;
     int myBase;
+    int myEnd;
 };
 
 inline int QicsPositionList::at(int idx) const
 {
-    if ((idx >= myBase) && (idx-myBase<size()))
-        return (myPositions.at(idx - myBase));
-    else
+    if ((idx < myBase) || (idx >= myEnd))
         return -1;
-}
 
-inline int QicsPositionList::firstVisible() const
-{
-    for (int i = firstIndex(); i <= lastIndex(); ++i)
-        if (at(i) >= 0) return i;
+    // without hidden indices before idx, it is found directly
+    const int k = idx - myBase;
+    if (k < myIndexes.size() && myIndexes.at(k) == idx)
+        return myPositions.at(k);
 
-    return -1;
-}
+    QVector<int>::const_iterator it =
+        qBinaryFind(myIndexes.constBegin(), myIndexes.constEnd(), idx);
 
-inline int QicsPositionList::lastVisible() const
-{
-    for (int i = lastIndex(); i >= firstIndex(); --i)
-        if (at(i) >= 0) return i;
+    if (it == myIndexes.constEnd())
+        return -1;
 
-    return -1;
+    return myPositions.at(it - myIndexes.constBegin());
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -359,6 +377,13 @@ protected:
         const QicsICell &start,
         Qics::QicsIndexType indexType = Qics::RowAndColumnIndex);
 
+    /*!
+    * \internal
+    * Returns the first row or column after the run of hidden ones which
+    * starts at \a index, cut off just past \a last.
+    */
+    int hiddenRunEnd(Qics::QicsIndexType type, int index, int last) const;
+
     /*!
     * \internal
     * returns the cell display object for the cell (\a row, \a col ).
@@ -1117,6 +1117,16 @@ signals:
     */
     void valueChanged(int row, int col);
 
+    /*!
+    * This signal is emitted at the end of a batch of changes to the data
+    * model, once for every region \a reg whose values changed.  The region
+    * is expressed in \b model coordinates, as it may not be contiguous
+    * in the grid.
+    * \sa QicsDataModel::beginBatch()
+    * \since 3.1
+    */
+    void valuesChanged(const QicsRegion &reg);
+
 protected:
     virtual void setAttr(QicsCellStyle::QicsCellStyleProperty attr, const void *val);
     virtual void *getAttr(QicsCellStyle::QicsCellStyleProperty attr) const;
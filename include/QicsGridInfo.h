@@ -19,11 +19,13 @@
 #include "QicsNamespace.h"
 #include "QicsICell.h"
 #include "QicsRegion.h"
+#include "QicsDirtyRegionSet.h"
 #include "QicsSorter.h"
 #include "QicsDataModelDefault.h"
 
 
 class QMouseEvent;
+class QTimer;
 class QMimeData;
 class QicsKeyboardManager;
 class QicsDataModel;
@@ -236,6 +238,28 @@ public:
     */
     void revertGridRepaintBehavior();
 
+    /*!
+    * Returns the shortest time, in milliseconds, between two repaints
+    * caused by changes in the data model.  0 means that every change is
+    * repainted at once.
+    * \sa setRefreshInterval()
+    * \since 3.1
+    */
+    inline int refreshInterval() const { return myRefreshInterval; }
+
+    /*!
+    * Sets the shortest time between two repaints caused by changes in the
+    * data model to \a msecs milliseconds.  Changes made in the meantime
+    * are collected and repainted together, so that a data model which
+    * changes thousands of times per second costs no more than one repaint
+    * per interval.  If \a msecs is 0 (the default), every change is
+    * repainted at once.  Changes still waiting are repainted if the
+    * interval is shortened to 0.
+    * \sa flushModelChanges()
+    * \since 3.1
+    */
+    void setRefreshInterval(int msecs);
+
     /*!
     * \internal
     * Causes this table to become the master for columns in another \a grid.
@@ -326,6 +350,40 @@ public:
         DataItemComparator func = 0,
         bool models = false);
 
+    /*!
+    * \internal
+    * Like orderRowsBy(), but sorts on a worker thread.  The grids keep
+    * the current order until orderingFinished() is signaled.
+    */
+    void orderRowsByAsync(const QVector<int> &columns,
+        QicsSortOrder order = Qics::Ascending,
+        int from = 0, int to = -1,
+        DataItemComparator func = 0,
+        bool models = false);
+
+    /*!
+    * \internal
+    * Like orderColumnsBy(), but sorts on a worker thread.  The grids keep
+    * the current order until orderingFinished() is signaled.
+    */
+    void orderColumnsByAsync(const QVector<int> &rows,
+        QicsSortOrder order = Qics::Ascending,
+        int from = 0, int to = -1,
+        DataItemComparator func = 0,
+        bool models = false);
+
+    /*!
+    * \internal
+    * Cancels the background sorts of rows and columns, if any.
+    */
+    void cancelOrdering();
+
+    /*!
+    * \internal
+    * Returns true while rows or columns are sorted in background.
+    */
+    bool isOrdering() const;
+
     /*!
     * \internal
     * Returns the row ordering sort object.
@@ -579,6 +637,18 @@ signals:
     */
     void modelReordered(Qics::QicsIndexType);
 
+    /*!
+    * Signaled while rows or columns are sorted in background.
+    * \a percent is the part of the sort done so far.
+    */
+    void orderingProgress(Qics::QicsIndexType type, int percent);
+
+    /*!
+    * Signaled when a background sort of rows or columns has ended.
+    * \a applied is false if the sort was cancelled or dropped.
+    */
+    void orderingFinished(Qics::QicsIndexType type, bool applied);
+
     /*!
     * This signal is emitted when the current cell of the grids associated
     * with this object changes.  The cell (\a new_row, \a new_col ) is
@@ -593,6 +663,16 @@ signals:
     */
     void cellValueChanged(int row, int col);
 
+    /*!
+    * This signal is emitted at the end of a batch of changes to the data
+    * model, once for every region \a reg whose values changed.  Unlike
+    * #cellValueChanged(), \a reg is expressed in \b model coordinates,
+    * and the changes are not propagated to the selected cells.
+    * \sa QicsDataModel::beginBatch()
+    * \since 3.1
+    */
+    void cellValuesChanged(const QicsRegion &reg);
+
     /*!
     * This signal is emitted when traversed to other cell.
     */
@@ -726,6 +806,14 @@ public slots:
     */
     virtual void redrawModel(const QicsRegion &r, bool model = true);
 
+    /*!
+    * Repaints the changes in the data model which are waiting for the
+    * refresh interval to end.
+    * \sa setRefreshInterval()
+    * \since 3.1
+    */
+    void flushModelChanges();
+
     /*!
     * \internal
     * Sets the value of the appropriate cell of this object's data model.
@@ -792,6 +880,19 @@ protected slots:
     */
     void propagateChangesFromCell(int row, int col);
 
+    /*!
+    * \internal
+    * Called when a background sort has ended.
+    */
+    void handleOrderingFinished(Qics::QicsIndexType type, bool applied);
+
+    /*!
+    * \internal
+    * Called when a region of the data model changed.  Repaints it at
+    * once, or queues it if there is a refresh interval.
+    */
+    void handleModelChanged(const QicsRegion &r);
+
 protected:
     /*!
     * \internal
@@ -887,6 +988,30 @@ private:
 
     QicsRepaintBehavior myPrevGridRepaintBehavior;
 
+    /*!
+    * \internal
+    * shortest time between two repaints of model changes, in milliseconds
+    */
+    int myRefreshInterval;
+
+    /*!
+    * \internal
+    * fires at the end of the refresh interval, if changes are waiting
+    */
+    QTimer *myRefreshTimer;
+
+    /*!
+    * \internal
+    * visual regions of the changes waiting for the refresh interval
+    */
+    QicsDirtyRegionSet myPendingChanges;
+
+    /*!
+    * \internal
+    * set if a waiting change needs all grids to be repainted
+    */
+    bool myPendingFullRedraw;
+
     /*!
     * \internal
     * Holds the current cell.
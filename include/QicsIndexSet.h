@@ -0,0 +1,127 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#ifndef QICSINDEXSET_H
+#define QICSINDEXSET_H
+
+#include <QVector>
+#include <QList>
+#include "QicsNamespace.h"
+
+/*! \file */
+
+/*!
+* \class QicsIndexSet QicsIndexSet.h
+* \brief A set of non-negative row or column indices.
+*
+* QicsIndexSet stores its members as a bitmap, together with a Fenwick
+* tree of the number of members in every 64 bit word of the bitmap.
+* Membership tests take O(1) time; adding or removing a member, counting
+* the members in a range and finding the nearest index that is \b not a
+* member take O(log n) time, however long the runs of members are.
+*
+* The dimension manager keeps hidden rows and columns in a QicsIndexSet
+* so that layout can jump over long runs of filtered rows.
+* \since 3.1
+*/
+class QICS_EXPORT QicsIndexSet
+{
+public:
+    QicsIndexSet();
+
+    /*!
+    * Returns the number of members.
+    */
+    inline int count() const { return myCount; }
+
+    /*!
+    * Returns \b true if the set has no members.
+    */
+    inline bool isEmpty() const { return (myCount == 0); }
+
+    /*!
+    * Removes all members.
+    */
+    void clear();
+
+    /*!
+    * Returns \b true if \a index is a member.
+    */
+    inline bool contains(int index) const
+    {
+        return (index >= 0 && (index >> 6) < myWords.size() &&
+            (myWords.at(index >> 6) & (Q_UINT64_C(1) << (index & 63))));
+    }
+
+    /*!
+    * Adds \a index to the set.  Returns \b false if it was a member already.
+    */
+    bool insert(int index);
+
+    /*!
+    * Removes \a index from the set.  Returns \b false if it was not a member.
+    */
+    bool remove(int index);
+
+    /*!
+    * Returns the number of members from \a first to \a last, inclusive.
+    */
+    int count(int first, int last) const;
+
+    /*!
+    * Returns the smallest index not less than \a index which is not
+    * a member.
+    */
+    int nextAbsent(int index) const;
+
+    /*!
+    * Returns the largest index not greater than \a index which is not
+    * a member, or -1 if there is none.
+    */
+    int previousAbsent(int index) const;
+
+    /*!
+    * Moves all members from \a start onwards up by \a num, as needed
+    * when \a num rows or columns are inserted at \a start.
+    */
+    void insertSpace(int start, int num);
+
+    /*!
+    * Drops the members from \a start to \a start + \a num - 1 and moves
+    * the members after them down by \a num, as needed when \a num rows
+    * or columns are deleted at \a start.
+    */
+    void removeSpace(int start, int num);
+
+    /*!
+    * Returns all members in ascending order.
+    */
+    QList<int> toList() const;
+
+private:
+    // number of members in [0, index)
+    int rank(int index) const;
+    // number of members in words [0, word)
+    int countBefore(int word) const;
+    // index of the word holding the absent bit of rank \a rank (0-based),
+    // or myWords.size() if there are not that many absent bits
+    int selectAbsentWord(int rank) const;
+    void addToTree(int word, int delta);
+    void rebuildTree();
+
+    QVector<quint64> myWords;
+    // 1-based Fenwick tree of member counts per word
+    QVector<int> myTree;
+    int myCount;
+};
+
+#endif //QICSINDEXSET_H
@@ -13,13 +13,16 @@
 #ifndef QICSMAPPEDDIMENSIONMANAGER_H
 #define QICSMAPPEDDIMENSIONMANAGER_H
 
+#include <QObject>
 #include "QicsNamespace.h"
+#include "QicsOffsetIndex.h"
 
 
 class QicsRegion;
 class QicsGrid;
 class QicsGridInfo;
 class QicsDimensionManager;
+class QicsSorter;
 class QFont;
 
 ///////////////////////////////////////////////////////////////////////////
@@ -35,6 +38,12 @@ class QFont;
 * Internally, it only holds pointers to the underlying DimensionManager
 * which the GridInfo really uses, and the GridInfo.  Most calls simply
 * do the transform and forward them.
+*
+* The heights of all rows and the widths of all columns, in visual
+* order, are also kept in a QicsOffsetIndex so that the extent of large
+* regions and the row or column at a given offset are found in O(log n)
+* time.  The index is built on first use and kept up to date as single
+* rows and columns change.
 */
 
 ////////////////////////////////////////////////////
@@ -43,8 +52,9 @@ class QFont;
 
 ////////////////////////////////////////////////////
 
-class QICS_EXPORT QicsMappedDimensionManager
+class QICS_EXPORT QicsMappedDimensionManager : public QObject
 {
+    Q_OBJECT
 public:
     /*!
     * Constructor for the class.  The style manager \a sm is used
@@ -342,6 +352,59 @@ public:
     */
     int regionWidth(const QicsRegion &region) const;
 
+    /*!
+    * Returns the offset of the top of row \a row from the top of row 0,
+    * including the grid lines between the visible rows above it.
+    * \since 3.1
+    */
+    int rowOffset(int row) const;
+    /*!
+    * Returns the visible row which covers offset \a y from the top of
+    * row 0, or -1 if there is no such row.
+    * \since 3.1
+    */
+    int rowAtOffset(int y) const;
+
+    /*!
+    * Returns the offset of the left side of column \a col from the left
+    * side of column 0, including the grid lines between the visible
+    * columns before it.
+    * \since 3.1
+    */
+    int columnOffset(int col) const;
+    /*!
+    * Returns the visible column which covers offset \a x from the left
+    * side of column 0, or -1 if there is no such column.
+    * \since 3.1
+    */
+    int columnAtOffset(int x) const;
+
+    /*!
+    * Returns the first visible row at or after \a row, or -1 if there
+    * is none.  Runs of hidden rows are skipped in O(log n) time.
+    * \since 3.1
+    */
+    int nextVisibleRow(int row) const;
+    /*!
+    * Returns the last visible row at or before \a row, or -1 if there
+    * is none.
+    * \since 3.1
+    */
+    int previousVisibleRow(int row) const;
+
+    /*!
+    * Returns the first visible column at or after \a col, or -1 if
+    * there is none.  Runs of hidden columns are skipped in O(log n) time.
+    * \since 3.1
+    */
+    int nextVisibleColumn(int col) const;
+    /*!
+    * Returns the last visible column at or before \a col, or -1 if
+    * there is none.
+    * \since 3.1
+    */
+    int previousVisibleColumn(int col) const;
+
     /*!
     * Temporarily override the height of row \a row to \height pixels.
     * The height of the row can be reset by calling #resetRowHeight().
@@ -414,9 +477,38 @@ public:
 
     inline QicsDimensionManager *dimensionManager() const {return myDM;}
 
+private slots:
+    void invalidateOffsets();
+    void updateOffsets(Qics::QicsIndexType type, int start, int end);
+
 private:
+    struct QicsOffsetCache
+    {
+        QicsOffsetIndex index;
+        bool valid;
+        // revisions of the dimension manager and the sorter the
+        // index was built from
+        uint revision;
+        uint orderRevision;
+        const QicsSorter *sorter;
+    };
+
+    inline QicsOffsetCache &offsetCache(Qics::QicsIndexType type) const
+    { return (type == Qics::RowIndex ? myRowOffsets : myColumnOffsets); }
+
+    bool isOffsetIndexCurrent(Qics::QicsIndexType type) const;
+    // returns the index of all rows or columns, rebuilding it if it is stale
+    const QicsOffsetIndex &offsetIndex(Qics::QicsIndexType type) const;
+    // extent of visual row or column, or -1 if it is hidden
+    int visualExtent(Qics::QicsIndexType type, int index) const;
+    // width of the grid line after every visible row or column
+    int lineWidth(Qics::QicsIndexType type) const;
+
     QicsDimensionManager *myDM;
     QicsGridInfo *myInfo;
+
+    mutable QicsOffsetCache myRowOffsets;
+    mutable QicsOffsetCache myColumnOffsets;
 };
 
 #endif //QICSMAPPEDDIMENSIONMANAGER_H
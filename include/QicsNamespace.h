@@ -141,10 +141,15 @@ public:
     * Denotes the sort algorithm which is used.
     * \arg \b QicsStableSort Used non-destructive, stable sort algorithm.
     * \arg \b QicsQuickSort Default quick sort algorithm.
+    * \arg \b QicsParallelStableSort Stable merge sort which spreads the
+    *          comparisons over several threads.  Falls back to
+    *          QicsStableSort for sorter delegates that do not build sort keys.
+    *          (since 3.1)
     */
     enum QicsSortMode {
         QicsStableSort = 0,
-        QicsQuickSort
+        QicsQuickSort,
+        QicsParallelStableSort
     };
 
     /*!
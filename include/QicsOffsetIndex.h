@@ -0,0 +1,123 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#ifndef QICSOFFSETINDEX_H
+#define QICSOFFSETINDEX_H
+
+#include <QVector>
+#include "QicsNamespace.h"
+
+/*! \file */
+
+/*!
+* \class QicsOffsetIndex QicsOffsetIndex.h
+* \brief Prefix sums over the extents of a sequence of rows or columns.
+*
+* QicsOffsetIndex keeps the height of every row (or the width of every
+* column) in a Fenwick tree, together with the number of entries that
+* are not hidden.  Changing one extent, the offset of an entry, the
+* extent of a range of entries and the entry at a given offset all take
+* O(log n) time.
+*
+* Hidden entries have no extent.  Queries take the width of the grid
+* line that follows every visible entry as an argument, so that the
+* index does not have to be rebuilt when grid lines change.
+* \since 3.1
+*/
+class QICS_EXPORT QicsOffsetIndex
+{
+public:
+    QicsOffsetIndex();
+
+    /*!
+    * Returns the number of entries.
+    */
+    inline int size() const { return myExtents.size(); }
+
+    /*!
+    * Removes all entries.
+    */
+    void clear();
+
+    /*!
+    * Rebuilds the index from \a extents in O(n) time.  A negative
+    * extent marks a hidden entry.
+    */
+    void reset(const QVector<int> &extents);
+
+    /*!
+    * Sets the extent of entry \a index to \a extent, or hides the
+    * entry if \a extent is negative.
+    */
+    void setExtent(int index, int extent);
+
+    /*!
+    * Returns the extent of entry \a index, or -1 if it is hidden.
+    */
+    inline int extent(int index) const { return myExtents.at(index); }
+
+    /*!
+    * Returns true if entry \a index is hidden.
+    */
+    inline bool isHidden(int index) const { return (myExtents.at(index) < 0); }
+
+    /*!
+    * Returns the offset of entry \a index from the start of entry 0,
+    * counting \a lineWidth after every visible entry before it.
+    * \a index may be size() to get the extent of all entries.
+    */
+    qint64 offset(int index, int lineWidth = 0) const;
+
+    /*!
+    * Returns the sum of the extents of the visible entries from
+    * \a first to \a last, inclusive.
+    */
+    qint64 rangeExtent(int first, int last) const;
+
+    /*!
+    * Returns the number of visible entries from \a first to \a last,
+    * inclusive.
+    */
+    int visibleCount(int first, int last) const;
+
+    /*!
+    * Returns the visible entry which covers \a pos, where every visible
+    * entry is followed by \a lineWidth.  Returns -1 if \a pos is before
+    * the first entry or after the last one.
+    */
+    int indexAt(qint64 pos, int lineWidth = 0) const;
+
+    /*!
+    * Returns the first visible entry not before \a index, or -1 if
+    * there is none.
+    */
+    int nextVisible(int index) const;
+
+    /*!
+    * Returns the last visible entry not after \a index, or -1 if
+    * there is none.
+    */
+    int previousVisible(int index) const;
+
+private:
+    // sums of entries [0, index) of both trees
+    void prefix(int index, qint64 &extent, int &count) const;
+    // the visible entry of rank \a rank (0-based), or size()
+    int selectVisible(int rank) const;
+
+    QVector<int> myExtents;
+    // 1-based Fenwick trees of extents and of visible entries
+    QVector<qint64> myExtentTree;
+    QVector<int> myCountTree;
+};
+
+#endif //QICSOFFSETINDEX_H
@@ -411,6 +411,7 @@ protected slots:
     void handleModelRowInsert(int nrows, int pos);
     void handleModelRowDelete(int nrows, int pos);
     void handleOrderChanged(Qics::QicsIndexType type, int* visChange, int size);
+    void handleItemMoved(Qics::QicsIndexType type, int from, int to);
     void changeDataModel(QicsDataModel *old_dt, QicsDataModel *new_dt);
     //void gridDeleted();
 
@@ -18,6 +18,7 @@
 #include <QVector>
 #include <QPixmap>
 #include "QicsGrid.h"
+#include "QicsDirtyRegionSet.h"
 #include "QicsSpan.h"
 #include "QicsCellStyle.h"
 #include "QicsGridStyle.h"
@@ -662,6 +663,28 @@ protected:
     */
     void clearUnusedRect(QPainter *painter);
 
+    /*!
+    * \internal
+    * Returns \b true if the image buffer is up to date, so that scrolling
+    * along \a type can move its contents instead of repainting the grid.
+    * \since 3.1
+    */
+    bool canScrollImageBuffer(Qics::QicsIndexType type) const;
+
+    /*!
+    * \internal
+    * Moves the contents of the image buffer after the first visible row
+    * or column (depending on \a type) changed from \a old_first to the
+    * current one, and schedules a repaint of the cells which were
+    * exposed.  \a old_positions and \a old_last are the cell positions
+    * and the last visible row or column before the change.  Returns
+    * \b false if the old and new cells do not overlap, in which case
+    * the caller must repaint the whole grid.
+    * \since 3.1
+    */
+    bool scrollImageBuffer(Qics::QicsIndexType type, const QicsPositionList &old_positions,
+        int old_first, int old_last);
+
     virtual QRect drawCell(int row, int col, int x, int y,
         bool look_for_overflower, QPainter *painter, QicsGrid::DrawCellMode mode);
 
@@ -1101,7 +1124,12 @@ protected:
 
     int speedOfScroll;
 
-    QicsRegion m_paintRegion;
+    /*!
+    * \internal
+    * Regions which need to be repainted by the next paint event,
+    * unless the whole grid is repainted.
+    */
+    QicsDirtyRegionSet m_paintRegions;
 
       /*!
     * \internal
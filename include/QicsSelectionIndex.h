@@ -0,0 +1,99 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#ifndef QICSSELECTIONINDEX_H
+#define QICSSELECTIONINDEX_H
+
+#include <QVector>
+#include "QicsSelection.h"
+
+/*! \file */
+
+/*!
+* \class QicsSelectionIndex QicsSelectionIndex.h
+* \brief An index which answers selection queries without scanning a
+* QicsSelectionList.
+*
+* QicsSelectionIndex keeps, for rows and for columns, the sorted and
+* merged intervals covered by any selection and by selections of entire
+* rows or columns.  The remaining selections are split into bands of rows
+* in which the same selections apply, and each band keeps the merged
+* column intervals it covers.  Every query is then a binary search.
+*
+* The answers are the same as those of QicsSelectionList::isCellSelected(),
+* QicsSelectionList::isRowSelected() and QicsSelectionList::isColumnSelected()
+* for the list the index was built from.  The index does not follow
+* later changes of the list; it must be built again.
+* \since 3.1
+*/
+class QICS_EXPORT QicsSelectionIndex
+{
+public:
+    QicsSelectionIndex();
+
+    /*!
+    * Builds the index for the selections in \a list.
+    */
+    void build(const QVector<QicsSelection> &list);
+
+    /*!
+    * Removes everything from the index.
+    */
+    void clear();
+
+    /*!
+    * Returns \b true if no cell is selected.
+    */
+    inline bool isEmpty() const { return myRows.isEmpty(); }
+
+    /*!
+    * Returns \b true if cell (\a row, \a col) is selected.
+    */
+    bool isCellSelected(int row, int col) const;
+
+    /*!
+    * Returns \b true if any cell in \a row is selected, or if \a complete
+    * is \b true, if all of \a row is selected by one selection.
+    */
+    bool isRowSelected(int row, bool complete = true) const;
+
+    /*!
+    * Returns \b true if any cell in column \a col is selected, or if
+    * \a complete is \b true, if all of \a col is selected by one selection.
+    */
+    bool isColumnSelected(int col, bool complete = true) const;
+
+private:
+    struct Interval
+    {
+        int first;
+        int last;
+    };
+    typedef QVector<Interval> IntervalList;
+
+    static bool intervalLessThan(const Interval &a, const Interval &b);
+    static void mergeIntervals(IntervalList &list);
+    static bool covers(const IntervalList &list, int index);
+
+    // rows and columns which have any selected cell
+    IntervalList myRows;
+    IntervalList myColumns;
+    // rows and columns selected entirely by one selection
+    IntervalList myFullRows;
+    IntervalList myFullColumns;
+    // first rows of the bands the other selections split the rows into,
+    // and the columns those selections cover in each band
+    QVector<int> myBandStarts;
+    QVector<IntervalList> myBandColumns;
+};
+
+#endif //QICSSELECTIONINDEX_H
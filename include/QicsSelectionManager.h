@@ -17,6 +17,7 @@
 #include <QVector>
 #include "QicsRegion.h"
 #include "QicsSelection.h"
+#include "QicsSelectionIndex.h"
 
 //#define DEBUG_SELECTION 1
 
@@ -36,8 +37,10 @@ class QicsGridInfo;
 * also be performed by the programmer through the QicsTable API.
 *
 * When selection actions are made, the selection manager updates its
-* internal state, and also updates the style manager so that affected
-* cells have the correct QicsCellStyle::Selected state.
+* selection list, which cell displays query through isCellSelected(),
+* isRowSelected() and isColumnSelected().  Optionally it also updates the
+* style managers so that selected rows and columns have the
+* QicsCellStyle::Selected property set, see setMarkSelectionInStyles().
 */
 ////////////////////////////////////////////////////
 
@@ -86,6 +89,26 @@ public:
     */
     inline void setGridInfo(QicsGridInfo *gi) {myGridInfo = gi;}
 
+    /*! \internal
+    * Returns \b true if selecting entire rows and columns also sets the
+    * QicsCellStyle::Selected property of those rows and columns.
+    * \since 3.1
+    */
+    inline bool markSelectionInStyles() const
+    { return myMarkSelectionInStyles; }
+
+    /*! \internal
+    * If \a yes, selecting entire rows and columns also sets the
+    * QicsCellStyle::Selected property of each of them in the style
+    * managers of the table and its headers, as earlier versions always
+    * did.  This costs a style and a property write per row, and is only
+    * needed by code which reads the property back.  Only selections
+    * made afterwards are marked.  The default is \b false.
+    * \since 3.1
+    */
+    inline void setMarkSelectionInStyles(bool yes)
+    { myMarkSelectionInStyles = yes; }
+
     /*! \internal
     * Adds a header to the selection manager's list of headers.
     * This list is used when a selection has changed and we need to
@@ -214,6 +237,29 @@ public:
     */
     const QicsSelection* currentSelection() const;
 
+    /*! \internal
+    * Returns \b true if cell (\a row, \a col) is in the selection list.
+    * This gives the same answer as QicsSelectionList::isCellSelected(),
+    * but neither scans nor copies the list, so it can be called for every
+    * painted cell.  The current selection is not included.
+    * \since 3.1
+    */
+    bool isCellSelected(int row, int col) const;
+
+    /*! \internal
+    * Returns \b true if \a row is selected in the selection list.
+    * \sa isCellSelected(), QicsSelectionList::isRowSelected()
+    * \since 3.1
+    */
+    bool isRowSelected(int row, bool complete = true) const;
+
+    /*! \internal
+    * Returns \b true if column \a col is selected in the selection list.
+    * \sa isCellSelected(), QicsSelectionList::isColumnSelected()
+    * \since 3.1
+    */
+    bool isColumnSelected(int col, bool complete = true) const;
+
 public slots:
     /*! \internal
     * called when the ordering vector changes, and we have
@@ -221,6 +267,11 @@ public slots:
     */
     void orderChanged(Qics::QicsIndexType, int *visChange, int size);
     /*! \internal
+    * called when a single item of the ordering vector moved
+    * from \a from to \a to
+    */
+    void itemMoved(Qics::QicsIndexType type, int from, int to);
+    /*! \internal
     * Deletes \a num rows into the selection list, starting at \a start_position.
     */
     void deleteRows(int num, int start_position);
@@ -312,15 +363,18 @@ protected:
     void validateSelection(const QicsSelection &sel);
 
     /*! \internal
-    * Sets the QicsCellStyle::Selected property for each cell in \a selection
-    * to the state \a sel.
+    * Records that \a selection changed to the state \a sel: adds it to
+    * the affected region, emits #rowSelected() and #columnSelected() for
+    * selections of entire rows and columns if anything is connected to
+    * them, and sets the QicsCellStyle::Selected property if
+    * markSelectionInStyles() is \b true.
     */
     void setSelectionProperty(const QicsSelection &selection,
         QicsSelectionManager::QicsSelectState sel);
     /*! \internal
-    * Sets the QicsCellStyle::Selected property for each cell in the region
-    * starting at (\a begin_row, \a begin_col ) and ending at
-    * (\a end_row, \a end_col ) to the state \a sel.
+    * Records that the region starting at (\a begin_row, \a begin_col )
+    * and ending at (\a end_row, \a end_col ) changed to the state \a sel,
+    * as described above.
     * NOTE: param constraints:
     * begin_row <= end_row
     * begin_col <= end_col
@@ -363,6 +417,19 @@ protected:
     */
     void announceChanges(bool in_progress);
 
+    /*! \internal
+    * Returns the index of the selection list, building it if the list
+    * changed since it was last built.
+    */
+    const QicsSelectionIndex &selectionIndex() const;
+
+    /*! \internal
+    * Marks the index of the selection list as out of date.  Must be
+    * called whenever the selection list is modified.
+    */
+    inline void invalidateSelectionIndex() const
+    { mySelectionIndexValid = false; }
+
     // \internal the controlling gridinfo
     QicsGridInfo *myGridInfo;
     // \internal the style manager
@@ -379,6 +446,10 @@ protected:
     // \internal the current \b completed selection list
     QicsSelectionList mySelectionList;
 
+    // \internal index of mySelectionList, built on demand
+    mutable QicsSelectionIndex mySelectionIndex;
+    mutable bool mySelectionIndexValid;
+
     // \internal the current selection action list
     QicsSelectionList *mySelectionActionList;
 
@@ -397,6 +468,9 @@ protected:
 
     // \internal flag indicating if the selection changed during the last operation
     bool mySelectionChangedFlag;
+
+    // \internal if set, selections are also recorded in the style managers
+    bool myMarkSelectionInStyles;
 };
 
 #endif //QICSSELECTIONMANAGER_H
@@ -0,0 +1,199 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#ifndef QICSSORTKEYS_H
+#define QICSSORTKEYS_H
+
+#include <QString>
+#include <QVector>
+#include "QicsNamespace.h"
+
+class QicsDataItem;
+
+/*! \file */
+
+/*!
+* \struct QicsSortKey QicsSortKeys.h
+* \brief A typed, precomputed sort key of a single data item.
+*
+* The key classifies a value in the same way QicsStandardSorterDelegate
+* does: numbers are sorted before strings, empty strings are sorted last
+* and missing items are sorted last in ascending and first in descending
+* order.
+* \since 3.1
+*/
+struct QicsSortKey
+{
+    /*!
+    * Kind of the key.  The declaration order defines the order of the kinds.
+    */
+    enum Kind {
+        Number = 0,
+        String,
+        Empty,
+        Null
+    };
+
+    QicsSortKey() : kind(Null), isInteger(false) { number = 0; }
+
+    /*! Kind of the key. */
+    quint8 kind;
+    /*! \b true if #integer holds the value of a number key. */
+    bool isInteger;
+    union {
+        /*! Value of a number key if #isInteger is \b false. */
+        double number;
+        /*! Value of a number key if #isInteger is \b true. */
+        qint64 integer;
+    };
+};
+
+/*!
+* \class QicsSortKeyColumn QicsSortKeys.h
+* \brief Vector of sort keys for one row or column the table is sorted by.
+*
+* QicsSortKeyColumn holds one QicsSortKey (and, for string keys, one
+* QString) per model index.  It is filled once before sorting, so that
+* comparisons do not have to access the data model, clone data items or
+* parse strings.
+*
+* Sorter delegates fill key columns in
+* QicsAbstractSorterDelegate::buildSortKeys().
+* \since 3.1
+*/
+class QICS_EXPORT QicsSortKeyColumn
+{
+public:
+    QicsSortKeyColumn();
+
+    /*!
+    * Clears the column and makes room for \a size keys.  All keys are
+    * initially null.  Keys are compared in \a order, strings are compared
+    * with case sensitivity \a cs.
+    */
+    void reset(int size, Qics::QicsSortOrder order = Qics::Ascending,
+        Qt::CaseSensitivity cs = Qt::CaseSensitive);
+
+    /*!
+    * Returns the number of keys in the column.
+    */
+    inline int size() const { return myKeys.size(); }
+
+    /*!
+    * Returns the sort order of the column.
+    */
+    inline Qics::QicsSortOrder sortOrder() const
+    { return (myOrdFlip > 0 ? Qics::Ascending : Qics::Descending); }
+
+    /*!
+    * Returns case sensitivity used to compare string keys.
+    */
+    inline Qt::CaseSensitivity sortingSensitivity() const { return mySensitivity; }
+
+    /*!
+    * Sets key \a index to a missing value.
+    */
+    void setNull(int index);
+
+    /*!
+    * Sets key \a index to a numeric value \a d.
+    */
+    void setNumber(int index, double d);
+
+    /*!
+    * Sets key \a index to an exact integer value \a i.  Two integer keys
+    * are compared without converting them to doubles.
+    */
+    void setInteger(int index, qint64 i);
+
+    /*!
+    * Sets key \a index to a string.  Empty strings and strings which can
+    * be read as numbers are classified as QicsStandardSorterDelegate does.
+    */
+    void setString(int index, const QString &str);
+
+    /*!
+    * Sets key \a index to the key of \a item, which may be 0.
+    */
+    void setItem(int index, const QicsDataItem *item);
+
+    /*!
+    * Compares keys \a index1 and \a index2.  Returns a value < 0 if
+    * \a index1 sorts before \a index2, 0 if they are equal and > 0
+    * otherwise.
+    */
+    inline int compare(int index1, int index2) const
+    {
+        return compareKeys(myKeys.at(index1), myStrings.at(index1),
+            myKeys.at(index2), myStrings.at(index2), myOrdFlip, mySensitivity);
+    }
+
+    /*!
+    * Computes the key of \a item.  The string of a string key is stored
+    * in \a str.
+    */
+    static QicsSortKey makeKey(const QicsDataItem *item, QString &str);
+
+    /*!
+    * Computes the key of \a str.  \a str is cleared unless the key is a
+    * string key.
+    */
+    static QicsSortKey makeKey(QString &str);
+
+    /*!
+    * Compares two keys, see #compare().  \a ordFlip is 1 for ascending
+    * and -1 for descending order.
+    */
+    static inline int compareKeys(const QicsSortKey &k1, const QString &s1,
+        const QicsSortKey &k2, const QString &s2,
+        int ordFlip, Qt::CaseSensitivity cs)
+    {
+        if (k1.kind != k2.kind) {
+            // missing values go last in ascending, first in descending
+            // order, all others keep their place whatever the order is.
+            if (k1.kind == QicsSortKey::Null)
+                return ordFlip;
+            if (k2.kind == QicsSortKey::Null)
+                return -ordFlip;
+            return (k1.kind < k2.kind ? -1 : 1);
+        }
+
+        switch (k1.kind)
+        {
+        case QicsSortKey::Number:
+            if (k1.isInteger && k2.isInteger)
+                return (k1.integer == k2.integer ? 0 :
+                    ordFlip * (k1.integer < k2.integer ? -1 : 1));
+            else {
+                const double d1 = k1.isInteger ? double(k1.integer) : k1.number;
+                const double d2 = k2.isInteger ? double(k2.integer) : k2.number;
+                return (d1 == d2 ? 0 : ordFlip * (d1 < d2 ? -1 : 1));
+            }
+        case QicsSortKey::String:
+            return ordFlip * QString::compare(s1, s2, cs);
+        default:
+            break;
+        }
+
+        return 0;
+    }
+
+private:
+    QVector<QicsSortKey> myKeys;
+    QVector<QString> myStrings;
+    int myOrdFlip;
+    Qt::CaseSensitivity mySensitivity;
+};
+
+#endif //QICSSORTKEYS_H
+
+
@@ -18,9 +18,12 @@
 #include <QDomElement>
 #include "QicsNamespace.h"
 #include "QicsDataItem.h"
+#include "QicsRegion.h"
 
 class QicsDataModel;
 class QicsAbstractSorterDelegate;
+class QicsSortContext;
+class QicsSortJob;
 
 ///////////////////////////////////////////////////////////////////////////
 
@@ -103,14 +106,98 @@ public:
     * the end of the vector.
     * \param func an optional comparator function for data with
     * special requirements.
+    *
+    * All state of a sort is kept in a per-call context, so several sorters
+    * may sort at the same time.  With Qics::QicsParallelStableSort, ranges
+    * whose keys are precomputed are sorted by a parallel merge sort.
     */
     void sort(const QVector<int> &otherAxisesIndex,
         QicsSortOrder order = Qics::Ascending,
         int from = 0, int to = -1,
         DataItemComparator func = 0);
 
+    /*!
+    * Reorders the indices like sort(), but sorts on a worker thread.
+    * The sort keys are taken from the model before this call returns;
+    * the current order stays in effect until the sort has finished.
+    * Progress is reported by sortProgress().  When the sort is done, the
+    * new order is installed, orderChanged() is emitted and then
+    * sortFinished().  A sort that is still running is cancelled first.
+    *
+    * Delegates without sort keys read the data model while comparing,
+    * so they are sorted synchronously, as if sort() was called.
+    * The background sort is always stable.
+    */
+    void sortAsync(const QVector<int> &otherAxisesIndex,
+        QicsSortOrder order = Qics::Ascending,
+        int from = 0, int to = -1,
+        DataItemComparator func = 0);
+
+    /*!
+    * Sorts the model indices in \a indices like sort() sorts the current
+    * order, but each range from \a bounds[i] up to \a bounds[i+1] on its
+    * own.  The sort keys are taken from the model once for all ranges.
+    * The current order is left unchanged; the result may be installed
+    * with reorder().
+    * \since 3.1
+    */
+    void sortRanges(const QVector<int> &otherAxisesIndex,
+        QicsSortOrder order, QVector<int> &indices,
+        const QVector<int> &bounds, DataItemComparator func = 0);
+
+    /*!
+    * Cancels the background sort started by sortAsync(), if any.
+    * The order is left unchanged and sortFinished() is emitted
+    * with \a applied set to false.
+    */
+    void cancelSort();
+
+    /*!
+    * Returns true while a background sort is running.
+    */
+    inline bool isSorting() const { return (m_sortJob != 0); }
+
+    /*!
+    * Enables or disables live sorting.  While it is enabled, the sorter
+    * keeps the sort keys of the last sort() or sortAsync().  When the
+    * data model changes a value the range is sorted by, only the changed
+    * elements are moved to their new places.  itemMoved() is emitted
+    * for a single element instead of orderChanged(); several elements
+    * emit orderChanged() followed by elementsRepositioned().
+    *
+    * Inserting, deleting, moving or reordering elements stops live
+    * sorting until the next sort.
+    * \since 3.1
+    */
+    void setLiveSort(bool on);
+
+    /*!
+    * Returns true if live sorting is enabled.
+    * \since 3.1
+    */
+    inline bool liveSort() const { return m_liveSort; }
+
+    /*!
+    * Returns the new place of \a index after the element at \a from
+    * was moved to \a to, as reported by itemMoved().
+    * \since 3.1
+    */
+    static inline int movedIndex(int index, int from, int to)
+    {
+        if (index == from)
+            return to;
+        if (from < to && index > from && index <= to)
+            return index - 1;
+        if (to < from && index >= to && index < from)
+            return index + 1;
+        return index;
+    }
+
     /*!
     * map a visual coordinate to a model one
+    *
+    * Both directions are looked up in dense arrays which are rebuilt
+    * lazily after the order or the set of hidden elements changed.
     */
     int visualToModel(int x);
 
@@ -119,6 +206,14 @@ public:
     */
     inline QVector<int>& visualToModelVector() { return m_order; }
 
+    /*!
+    * \internal
+    * Returns a counter which changes whenever the visual order or the
+    * set of hidden elements changes.
+    * \since 3.1
+    */
+    inline uint orderRevision() const { return m_orderRevision; }
+
     /*!
     * map a model coordinate back to visual one
     */
@@ -189,6 +284,24 @@ protected slots:
 
     void configureFromDomXml(const QDomElement&);
 
+private slots:
+    /*! \internal
+    * Handles the progress of the background sort number \a serial.
+    */
+    void handleSortProgress(int serial, int percent);
+
+    /*! \internal
+    * Installs the result of the background sort number \a serial.
+    * If the order changed meanwhile, the result is dropped.
+    */
+    void handleSortDone(int serial);
+
+    /*! \internal
+    * Moves the elements whose values changed in \a reg
+    * to their places, if live sorting is on.
+    */
+    void handleModelChanged(const QicsRegion &reg);
+
 protected:
     /*! \internal method to check an instance for sanity.  Makes
     * a lot of assertions.
@@ -212,10 +325,35 @@ private:
     /*! \internal toss the modelToVisual map */
     void flushModelToVisualMap();
 
+    /*! \internal rebuilds the visual maps and replaces the model
+    * indices in \a visChange by their visual indices
+    */
+    void mapToVisual(int *visChange, int size);
+
     /*! \internal do all the things needed when changing the order vector
     */
     void installNewOrder(int *neworder, int newlen);
 
+    /*! \internal creates the state of a single sort of the model
+    * indices \a indices.  The caller owns the returned context.
+    */
+    QicsSortContext *createSortContext(const QVector<int> &rows_or_columns,
+        QicsSortOrder sort_order, const QVector<int> &indices,
+        DataItemComparator func);
+
+    /*! \internal keeps \a context for live sorting of [\a from, \a to] */
+    void setLiveContext(QicsSortContext *context, int from, int to);
+
+    /*! \internal stops live sorting until the next sort */
+    void dropLiveSort();
+
+    /*! \internal returns the position of model index \a x in the order */
+    int orderIndex(int x);
+
+    /*! \internal live sort moves of one or of several model indices */
+    void repositionElement(int x);
+    void repositionElements(int start, int end);
+
 signals:
     /*! let people know the order has changed
     * \param type the style of axis which changed
@@ -224,6 +362,27 @@ signals:
     */
     void orderChanged(Qics::QicsIndexType type, int *map, int size);
 
+    /*! reports the progress of a background sort in \a percent
+    */
+    void sortProgress(Qics::QicsIndexType type, int percent);
+
+    /*! emitted when a background sort has ended.  \a applied
+    * is false if it was cancelled or its result was dropped.
+    */
+    void sortFinished(Qics::QicsIndexType type, bool applied);
+
+    /*! let people know a single item moved from visual position
+    * \a from to \a to, and all items in between moved by one.
+    * \sa movedIndex()
+    */
+    void itemMoved(Qics::QicsIndexType type, int from, int to);
+
+    /*! emitted after the orderChanged() of a live sort which moved
+    * several elements, as the order is not changed by a call then.
+    * \since 3.1
+    */
+    void elementsRepositioned(Qics::QicsIndexType type);
+
 private:
     /*! row or column indicator */
     Qics::QicsIndexType	myType;
@@ -234,13 +393,40 @@ private:
     /*! mapping from visual order to physical order */
     QVector<int> m_order;
 
-    QSet<int> m_hidden;
+    /*! hidden flags by model index, and the number of hidden elements */
+    QVector<bool> m_hidden;
+    int m_hiddenCount;
 
-    /*! reverse mapping from physical order to visual order */
-    QMap<int, int> m_modelToVisualMap;
+    /*! position of every model index in the order vector */
+    QVector<int> m_orderIndex;
+
+    /*! visual index of every model index, or -1 if it is hidden,
+    * and model index of every visual index.  Only used if some
+    * elements are hidden, otherwise they equal m_orderIndex and m_order.
+    */
+    QVector<int> m_modelToVisual;
+    QVector<int> m_visualToModel;
+
+    /*! false if the maps above have to be rebuilt */
+    bool m_visualMapsValid;
+
+    /*! bumped whenever the order or the hidden elements change */
+    uint m_orderRevision;
 
     QMap<int, QicsAbstractSorterDelegate *> m_sorterDelegates;
     QicsAbstractSorterDelegate *m_defaultSorterDelegate;
+
+    /*! the running background sort, if any */
+    QicsSortJob *m_sortJob;
+    int m_sortSerial;
+
+    /*! live sorting state, see setLiveSort() */
+    bool m_liveSort;
+    QicsSortContext *m_liveContext;
+    int m_liveFrom;
+    int m_liveTo;
+    /*! changes seen while a background sort was running */
+    QVector<QicsRegion> m_liveChanges;
 };
 
 #endif //QICSSORTER_H
@@ -0,0 +1,98 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#ifndef QICSSPANINDEX_H
+#define QICSSPANINDEX_H
+
+#include <QVector>
+#include <QHash>
+#include "QicsRegion.h"
+
+/*! \file */
+
+/*!
+* \class QicsSpanIndex QicsSpanIndex.h
+* \brief A spatial index over a list of rectangular regions.
+*
+* QicsSpanIndex buckets every region into the tiles of a uniform grid
+* of cells that it overlaps.  Finding the region that covers a cell only
+* looks at the regions in the cell's tile, and finding the regions that
+* intersect a rectangle only looks at the tiles under the rectangle.
+* Regions that would cover a great many tiles are kept in a separate
+* list which every query scans.
+*
+* Regions are identified by the order in which they were added, starting
+* at 0.  Queries report the lowest identifiers first, so that they agree
+* with a linear scan of the list the index was built from.
+*
+* The span manager keeps one index of its spans in model coordinates and
+* one in visual coordinates.
+* \since 3.1
+*/
+class QICS_EXPORT QicsSpanIndex
+{
+public:
+    QicsSpanIndex();
+
+    /*!
+    * Returns the number of regions in the index.
+    */
+    inline int size() const { return myRegions.size(); }
+
+    /*!
+    * Returns \b true if the index has no regions.
+    */
+    inline bool isEmpty() const { return myRegions.isEmpty(); }
+
+    /*!
+    * Removes all regions.
+    */
+    void clear();
+
+    /*!
+    * Adds \a reg to the index and returns its identifier.  An empty
+    * region takes an identifier but is never found.
+    */
+    int add(const QicsRegion &reg);
+
+    /*!
+    * Returns the region with identifier \a id.
+    */
+    inline const QicsRegion &region(int id) const { return myRegions.at(id); }
+
+    /*!
+    * Returns the identifier of the first region which contains the cell
+    * (\a row, \a col), or -1 if there is none.
+    */
+    int find(int row, int col) const;
+
+    /*!
+    * Fills \a ids_return with the identifiers of all regions which
+    * intersect \a reg, in ascending order.
+    */
+    void intersecting(const QicsRegion &reg, QVector<int> &ids_return) const;
+
+private:
+    static inline int tileOf(int index) { return (index >> TileShift); }
+    static inline quint64 tileKey(int tile_row, int tile_col)
+    { return ((quint64(quint32(tile_row)) << 32) | quint32(tile_col)); }
+
+    enum { TileShift = 4, MaxTiles = 256 };
+
+    QVector<QicsRegion> myRegions;
+    // identifiers of the regions overlapping each tile, in ascending order
+    QHash<quint64, QVector<int> > myTiles;
+    // identifiers of the regions which overlap more than MaxTiles tiles
+    QVector<int> myLarge;
+};
+
+#endif //QICSSPANINDEX_H
@@ -18,9 +18,12 @@
 #include "QicsNamespace.h"
 #include "QicsSpan.h"
 #include "QicsRegion.h"
+#include "QicsSpanIndex.h"
 
 
 class QicsGridInfo;
+class QicsSorter;
+class QicsDimensionManager;
 
 /*! \internal
 * \class QicsSpanManager QicsSpanManager.h
@@ -101,6 +104,17 @@ public:
     */
     bool insideSpan(const QicsGridInfo &, int row, int col, QicsRegion &reg_return, bool *spanner = 0) const;
 
+    /*!
+    * Fills \a spans_return with every cell span region which intersects
+    * \a reg, in the order the spans were added.  Both \a reg and the
+    * returned regions are in \a visual coordinates of \a gi.
+    * Unlike cellSpanList(), this method does not copy the span list and
+    * only looks at the spans near \a reg.
+    * \since 3.1
+    */
+    void visualSpansIntersecting(const QicsGridInfo &gi, const QicsRegion &reg,
+        QVector<QicsRegion> &spans_return) const;
+
     /*!
     * Iterates through all cell span regions, looking for regions
     * that begin in cells in row \a row.  Returns a span whose
@@ -171,6 +185,36 @@ protected:
     bool myReportChanges;
 
     QicsGridInfo *myInfo;
+
+private:
+    // A span index in the visual coordinates of one row and column
+    // ordering, with the revisions it was built from.
+    struct QicsVisualSpanIndex
+    {
+        QicsSpanIndex index;
+        const QicsSorter *rowSorter;
+        const QicsSorter *columnSorter;
+        const QicsDimensionManager *dm;
+        uint spanRevision;
+        uint rowOrderRevision;
+        uint columnOrderRevision;
+        uint rowRevision;
+        uint columnRevision;
+    };
+
+    // Called whenever myCellSpanList is modified other than by appending
+    void spansChanged();
+    // returns the span index in model coordinates, rebuilding it if stale
+    const QicsSpanIndex &modelIndex() const;
+    // returns the span index in visual coordinates of gi, rebuilding it if stale
+    const QicsSpanIndex &visualIndex(const QicsGridInfo &gi) const;
+
+    uint mySpanRevision;
+    mutable QicsSpanIndex myModelIndex;
+    mutable bool myModelIndexValid;
+    // a few visual indexes, as grids with different orderings may share spans
+    mutable QVector<QicsVisualSpanIndex> myVisualIndexes;
+    mutable int myNextVisualIndex;
 };
 
 #endif //QICSSPANMANAGER_H
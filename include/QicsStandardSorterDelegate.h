@@ -22,6 +22,13 @@
 /*! \class QicsStandardSorterDelegate QicsStandardSorterDelegate.h
 * \nosubgrouping
 * \brief This class represents interface for text data sorting.
+*
+* Numbers are sorted before strings, empty strings are always sorted last,
+* and missing items are sorted last in ascending and first in descending
+* order.  The sorter compares keys built by #buildSortKeys() instead of
+* calling #compare(), unless this is a subclass, which may define another
+* order in its #compare().  Subclasses which keep the standard order can
+* turn the keys on again with #setSortKeysEnabled().
 * \since 2.4.2
 */
 
@@ -39,6 +46,29 @@ public:
     virtual ~QicsStandardSorterDelegate();
 
     virtual int compare(const int &index1, const int &index2, const int &sortIndex);
+
+    virtual bool buildSortKeys(const QVector<int> &indices, int sortIndex,
+        QicsSortKeyColumn &keys);
+
+    /*!
+    * Sets whether #buildSortKeys() builds keys, so that the sorter does
+    * not call #compare().  Only turn this on in a subclass if its
+    * #compare() keeps the standard order.
+    * \since 3.1
+    */
+    void setSortKeysEnabled(bool on);
+
+    /*!
+    * Returns whether #buildSortKeys() builds keys.  Unless set with
+    * #setSortKeysEnabled(), this is \b true for QicsStandardSorterDelegate
+    * itself and \b false for its subclasses.
+    * \since 3.1
+    */
+    bool sortKeysEnabled() const;
+
+private:
+    bool m_sortKeysEnabled;
+    bool m_sortKeysSet;
 };
 
 #endif //QICSSTANDARDSORTERDELEGATE_H
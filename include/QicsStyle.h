@@ -32,6 +32,12 @@ class QPalette;
 * (QicsStyle::setValue), get a property (QicsStyle::getValue), or clear
 * a property (QicsStyle::clear).  A property is defined by its name,
 * an enumerated value that allows for fast retrieval.
+*
+* Only the properties that are set take space.  Integers, floats and
+* booleans are stored inline; strings, colors, fonts, pens and pixmaps
+* are shared between all styles that hold an equal value.  Pointers
+* returned by getValue() must be treated as read-only, and are valid
+* until the style is next changed.
 */
 ////////////////////////////////////////////////////
 
@@ -79,7 +85,18 @@ public:
     /*! \internal
     * Returns the value of the property specified by \a prop.
     */
-    inline void *getValue(int prop) const { return myProperties.at(prop); }
+    inline void *getValue(int prop) const
+    {
+        if (prop >= myNumProperties)
+            return 0;
+
+        const quint64 bit = Q_UINT64_C(1) << prop;
+        if (!(myPresent & bit))
+            return 0;
+
+        QicsStyleSlot *slot = mySlots + countBits(myPresent & (bit - 1));
+        return ((myInlineProperties & bit) ? static_cast<void *>(slot) : slot->p);
+    }
     /*! \internal
     * Sets the new value of the property specified by \a prop.
     */
@@ -129,7 +146,32 @@ public:
 protected:
     void init();
 
-    QVector<void *> myProperties;
+    /*! \internal
+    * Storage for the value of one property that is set.
+    */
+    union QicsStyleSlot
+    {
+        int i;
+        float f;
+        bool b;
+        void *p;
+    };
+
+    static inline int countBits(quint64 w)
+    {
+        w = w - ((w >> 1) & Q_UINT64_C(0x5555555555555555));
+        w = (w & Q_UINT64_C(0x3333333333333333)) + ((w >> 2) & Q_UINT64_C(0x3333333333333333));
+        w = (w + (w >> 4)) & Q_UINT64_C(0x0f0f0f0f0f0f0f0f);
+        return int((w * Q_UINT64_C(0x0101010101010101)) >> 56);
+    }
+
+    /// bit mask of the properties that are set
+    quint64 myPresent;
+    /// bit mask of the properties whose values are kept in their slot
+    quint64 myInlineProperties;
+    /// one slot for every property that is set, in property order
+    QicsStyleSlot *mySlots;
+
     QVector<QicsStylePropertyType> *myStyleTypeList;
     int myNumProperties;
 
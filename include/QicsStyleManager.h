@@ -14,6 +14,8 @@
 #define QICSSTYLEMANAGER_H
 
 #include <QObject>
+#include <QHash>
+#include <QVector>
 #include <QDomElement>
 #include "QicsNamespace.h"
 #include "QicsCellStyle.h"
@@ -125,11 +127,31 @@ public:
     * - repeating row
     * - model row
     * - default
+    *
+    * Resolved values are cached per cell, so asking for the properties
+    * of a cell that was painted before takes a single lookup.
     */
     void *getCellProperty(int row, int col,
         QicsCellStyle::QicsCellStyleProperty name,
         int visual_row = -1, int visual_col = -1) const;
 
+    /*! \internal
+    * Returns a counter which changes whenever a property of this style
+    * manager, or of the style manager it shadows, is changed.
+    * \since 3.1
+    */
+    inline uint styleRevision() const
+    { return myStyleRevision + (myBaseSM ? myBaseSM->styleRevision() : 0); }
+
+    /*! \internal
+    * Returns a counter which changes whenever a property that may apply
+    * to model column \a col is changed, in this style manager or in the
+    * style manager it shadows.  Changes to the cells or the properties
+    * of other columns leave it alone.
+    * \since 3.1
+    */
+    uint columnStyleRevision(int col) const;
+
     /*! \internal
     * Returns the value of style property \a name for
     * row \a row.  This may involve "flattening" the property
@@ -478,6 +500,34 @@ protected:
     void *repeatingColumnProp(int col, QicsCellStyle::QicsCellStyleProperty prop,
         const QicsRepeatingCellStylePV &styles) const;
 
+    /*! \internal
+    * Walks the style cascade to find the value of property \a name
+    * for a cell, as documented for #getCellProperty.
+    */
+    void *resolveCellProperty(int row, int col,
+        QicsCellStyle::QicsCellStyleProperty name,
+        int visual_row, int visual_col) const;
+
+    /*! \internal
+    * Drops the cached properties of cell (\a row, \a col).
+    */
+    void invalidateResolvedCell(int row, int col, bool visual_coords);
+
+    /*! \internal
+    * Drops the cached properties of all cells in row \a row.
+    */
+    void invalidateResolvedRow(int row, bool visual_coords);
+
+    /*! \internal
+    * Drops the cached properties of all cells in column \a col.
+    */
+    void invalidateResolvedColumn(int col, bool visual_coords);
+
+    /*! \internal
+    * Drops all cached cell properties.
+    */
+    void invalidateResolvedStyles();
+
     /*! \internal
     * Returns the default value of a property, or 0 if
     * the property is not set in the default style.
@@ -562,6 +612,39 @@ protected:
     // \internal attribute controller for model-indexed attributes
     QicsAbstractAttributeController *myModelAttributeController;
 
+    // \internal property values of one cell, as found by resolveCellProperty()
+    struct QicsResolvedCellStyle
+    {
+        QicsResolvedCellStyle() : visualRow(-1), visualColumn(-1), resolved(0) {}
+
+        int visualRow;
+        int visualColumn;
+        // \internal one bit for each entry of values that is filled in
+        quint64 resolved;
+        void *values[QicsCellStyle::LastProperty];
+    };
+
+    typedef QHash<quint64, QicsResolvedCellStyle> QicsResolvedCellStyleHash;
+
+    // \internal cache of resolved properties, keyed by model cell
+    mutable QicsResolvedCellStyleHash myResolvedStyles;
+
+    // \internal the entry of the cell asked for last, or 0
+    mutable QicsResolvedCellStyle *myLastResolved;
+    mutable quint64 myLastResolvedKey;
+
+    // \internal revision of the base style manager the cache is valid for
+    mutable uint myBaseRevision;
+
+    // \internal changes whenever a property is changed
+    uint myStyleRevision;
+
+    // \internal changes whenever a property of more than one column is changed
+    uint myWideRevision;
+
+    // \internal changes of the properties of each model column
+    QVector<uint> myColumnRevisions;
+
 private:
     /* \internal
     * Deletes the contents of a vector of allocated cell style vectors.
@@ -577,6 +660,13 @@ private:
     * Deletes the contents of a vector of allocated repeating cell styles.
     */
     void deleteRepeatingCellStyles(QicsRepeatingCellStylePV &csv);
+
+    /* \internal
+    * Returns the cache entry for cell (\a row, \a col) seen at visual
+    * cell (\a visual_row, \a visual_col), or 0 if it can't be cached.
+    */
+    QicsResolvedCellStyle *resolvedCellStyle(int row, int col,
+        int visual_row, int visual_col) const;
 };
 
 #endif //QICSSTYLEMANAGER_H
@@ -49,6 +49,7 @@ class QicsScrollManager;
 class QicsScroller;
 class QicsStyleManager;
 class QicsSelectionManager;
+class QicsAutoFitCache;
 class QicsCellDisplay;
 class QicsGridLayout;
 class QicsNavigator;
@@ -1127,6 +1128,50 @@ public:
     */
     Q_PROPERTY( QicsRepaintBehavior repaintBehavior READ repaintBehavior WRITE setRepaintBehavior )
 
+    /*!
+    * Specifies the shortest time, in milliseconds, between two repaints
+    * caused by changes in the data model.  Changes made in the meantime
+    * are collected and repainted together, which bounds the cost of
+    * repainting a table fed by a high frequency data source.  Call
+    * flushModelChanges() to repaint the waiting changes at once.
+    *
+    * The default value of this property is \b 0, which repaints every
+    * change as soon as it is made.
+    * \since 3.1
+    */
+    Q_PROPERTY( int refreshInterval READ refreshInterval WRITE setRefreshInterval )
+
+    /*!
+    * Specifies whether selecting entire rows and columns also sets the
+    * QicsCellStyle::Selected property of those rows and columns, as
+    * earlier versions always did.  Cell displays do not need the
+    * property; they ask the selection list.  Setting it costs a style
+    * and a property write per selected row or column, so only turn this
+    * on for code which reads the property back.  It applies to the
+    * selections made after it is set.
+    *
+    * The default value of this property is \b false.
+    * \since 3.1
+    */
+    Q_PROPERTY( bool markSelectionInStyles READ markSelectionInStyles WRITE setMarkSelectionInStyles )
+
+    /*!
+    * Specifies how many rows are measured when a column is fitted to its
+    * contents with toggleColumnWidthExpansion().  If the column has more
+    * rows than this, only the rows currently on screen and this many rows
+    * spread evenly over the column are measured; the widths measured by
+    * earlier fits of the column are still taken into account.  A value
+    * of 0 measures every row.
+    *
+    * Measured widths are remembered until the cell, the styles of the
+    * table or the width of the column change, so fitting a column again
+    * is cheap in either case.
+    *
+    * The default value of this property is \b 0.
+    * \since 3.1
+    */
+    Q_PROPERTY( int autoFitSampleSize READ autoFitSampleSize WRITE setAutoFitSampleSize )
+
     /*!
     * Specifies the mode for the table's horizontal scrollbar.
     *
@@ -2716,6 +2761,32 @@ public:
     */
     QicsRepaintBehavior repaintBehavior() const;
 
+    /*!
+    * Returns the shortest time between two repaints caused by changes
+    * in the data model.
+    * See the \link #refreshInterval "refreshInterval" \endlink
+    * property for details
+    * \since 3.1
+    */
+    int refreshInterval() const;
+
+    /*!
+    * Returns \b true if selections of entire rows and columns are also
+    * recorded in the QicsCellStyle::Selected property.
+    * See the \link #markSelectionInStyles "markSelectionInStyles" \endlink
+    * property for details
+    * \since 3.1
+    */
+    bool markSelectionInStyles() const;
+
+    /*!
+    * Returns the number of rows measured when fitting a column.
+    * See the \link #autoFitSampleSize "autoFitSampleSize" \endlink
+    * property for details
+    * \since 3.1
+    */
+    int autoFitSampleSize() const;
+
     /*!
     * Returns the mode of the horizontal scrollbar.
     * See the \link #hScrollBarMode "hScrollBarMode" \endlink
@@ -2856,6 +2927,44 @@ public:
         int from = 0, int to = -1,
         DataItemComparator func = 0);
 
+    /*!
+    * Multicolumn sort the rows on a worker thread.  The parameters are
+    * the same as for sortRows().  The sort keys are read from the data
+    * model before this call returns; the table stays responsive and keeps
+    * showing the current order until the sort has finished.  Progress is
+    * reported by sortProgress(), the end of the sort by sortFinished().
+    * Starting another background sort cancels the running one.
+    * Sorter delegates which do not provide sort keys are sorted
+    * synchronously.
+    * \sa cancelSort(), isSorting()
+    */
+    void sortRowsAsync(const QVector<int> &columns,
+        QicsSortOrder order = Qics::Ascending,
+        int from = 0, int to = -1,
+        DataItemComparator func = 0);
+
+    /*!
+    * Multirow sort the columns on a worker thread.  The parameters are
+    * the same as for sortColumns().
+    * \sa sortRowsAsync(), cancelSort(), isSorting()
+    */
+    void sortColumnsAsync(const QVector<int> &rows,
+        QicsSortOrder order = Qics::Ascending,
+        int from = 0, int to = -1,
+        DataItemComparator func = 0);
+
+    /*!
+    * Cancels the running background sorts, leaving the order as it is.
+    * \sa sortRowsAsync(), sortColumnsAsync()
+    */
+    void cancelSort();
+
+    /*!
+    * Returns true while rows or columns are sorted in background.
+    * \sa sortRowsAsync(), sortColumnsAsync()
+    */
+    bool isSorting() const;
+
     /*!
     * Sets case sensitivity while sorting to \a cs.
     * \sa sortColumns(), sortRows()
@@ -3296,6 +3405,39 @@ public:
     inline Qics::QicsSortMode rowsSortingMode()
     { return gridInfo().rowOrdering()->sortMode(); }
 
+    /**
+    * Enables or disables live sorting of rows.  While it is enabled,
+    * a row whose sort key changes in the data model is moved to its
+    * place in the last sort, without sorting the whole table again.
+    * Inserting, deleting or moving rows stops live sorting until
+    * the next sort.
+    * \since 3.1
+    */
+    inline void setRowsLiveSort(bool on)
+    { gridInfo().rowOrdering()->setLiveSort(on); }
+
+    /**
+    * Returns true if live sorting of rows is enabled.
+    * \since 3.1
+    */
+    inline bool rowsLiveSort() const
+    { return gridInfo().rowOrdering()->liveSort(); }
+
+    /**
+    * Enables or disables live sorting of columns.
+    * \sa setRowsLiveSort()
+    * \since 3.1
+    */
+    inline void setColumnsLiveSort(bool on)
+    { gridInfo().columnOrdering()->setLiveSort(on); }
+
+    /**
+    * Returns true if live sorting of columns is enabled.
+    * \since 3.1
+    */
+    inline bool columnsLiveSort() const
+    { return gridInfo().columnOrdering()->liveSort(); }
+
     inline void setSorterDelegate(QicsAbstractSorterDelegate *sorter)
     {gridInfo().setSorterDelegate(sorter);}
 
@@ -4226,6 +4368,43 @@ public slots:
     */
     void setRepaintBehavior(QicsRepaintBehavior r);
 
+    /*!
+    * Sets the shortest time between two repaints caused by changes
+    * in the data model to \a msecs milliseconds.
+    * See the \link #refreshInterval "refreshInterval" \endlink
+    * property for details.
+    * \sa refreshInterval(), flushModelChanges()
+    * \since 3.1
+    */
+    void setRefreshInterval(int msecs);
+
+    /*!
+    * Repaints the changes in the data model which are waiting for the
+    * end of the refresh interval.
+    * \sa setRefreshInterval()
+    * \since 3.1
+    */
+    void flushModelChanges();
+
+    /*!
+    * Sets whether selections of entire rows and columns are also
+    * recorded in the QicsCellStyle::Selected property.
+    * See the \link #markSelectionInStyles "markSelectionInStyles" \endlink
+    * property for details.
+    * \sa markSelectionInStyles()
+    * \since 3.1
+    */
+    void setMarkSelectionInStyles(bool yes);
+
+    /*!
+    * Sets the number of rows measured when fitting a column.
+    * See the \link #autoFitSampleSize "autoFitSampleSize" \endlink
+    * property for details.
+    * \sa autoFitSampleSize()
+    * \since 3.1
+    */
+    void setAutoFitSampleSize(int num);
+
     /*!
     * Sets the number of visible rows in the main grid area of the table.
     * This value does not include any frozen rows that may be visible.
@@ -4567,6 +4746,16 @@ signals:
     */
     void valueChanged(int row, int col);
 
+    /*!
+    * This signal is emitted at the end of a batch of changes to the data
+    * model, once for every region \a reg whose values changed.  The region
+    * is expressed in \b model coordinates, as it may not be contiguous
+    * in the main grid.
+    * \sa QicsDataModel::beginBatch()
+    * \since 3.1
+    */
+    void valuesChanged(const QicsRegion &reg);
+
     /*!
     * Signal emitted when the row selection changes. The \b row parameter is
     * row index, \b selected is \b true when row was selected and \b false
@@ -4694,6 +4883,21 @@ signals:
 
     void filterChanged(int index, bool set);
 
+    /*!
+    * This signal is emitted while rows or columns of the table are sorted
+    * in background.  \a percent is the part of the sort done so far.
+    * \sa sortRowsAsync(), sortColumnsAsync()
+    */
+    void sortProgress(Qics::QicsIndexType type, int percent);
+
+    /*!
+    * This signal is emitted when a background sort of rows or columns
+    * has ended.  \a applied is true if the new order is shown, and false
+    * if the sort was cancelled or the order was changed meanwhile.
+    * \sa sortRowsAsync(), sortColumnsAsync()
+    */
+    void sortFinished(Qics::QicsIndexType type, bool applied);
+
 protected slots:
     /*!
     * \internal
@@ -4736,6 +4940,14 @@ protected slots:
     */
     void modelToVisualValueChanged(int row, int col);
 
+    /*!
+    * \internal
+    * Restarts editing of the current cell if its value changed in a
+    * batch of changes, and emits signal valuesChanged()
+    * \since 3.1
+    */
+    void modelToVisualValuesChanged(const QicsRegion &reg);
+
     /*!
     * \internal
     * Tracks change of current cell coordinates improving performance of
@@ -4889,6 +5101,23 @@ protected:
 
     virtual bool eventFilter (QObject*,QEvent *);
 
+#if QT_VERSION < 0x050000
+    virtual void connectNotify(const char *signal);
+    virtual void disconnectNotify(const char *signal);
+#else
+    virtual void connectNotify(const QMetaMethod &signal);
+    virtual void disconnectNotify(const QMetaMethod &signal);
+#endif
+
+    /*!
+    * \internal
+    * Forwards the selection manager's rowSelected() and columnSelected()
+    * signals only while something is connected to the table's, so that
+    * the selection manager need not visit every row of a large selection
+    * otherwise.
+    */
+    void updateSelectionSignalForwarding();
+
     void connectGrid(QicsTableGrid* grid,QicsHeaderGrid* header);
 
     /*!
@@ -4944,6 +5173,26 @@ protected:
     */
     QPointer<QicsSelectionManager> m_selectionManager;
 
+    /*!
+    * \internal
+    * whether rowSelected() and columnSelected() of the selection manager
+    * are forwarded
+    */
+    bool m_rowSelectedForwarded;
+    bool m_columnSelectedForwarded;
+
+    /*!
+    * \internal
+    * content widths measured when fitting columns
+    */
+    QicsAutoFitCache *m_autoFitCache;
+
+    /*!
+    * \internal
+    * number of rows measured when fitting a column, 0 for all
+    */
+    int m_autoFitSampleSize;
+
     /*!
     * \internal
     * Qt grid object for layout
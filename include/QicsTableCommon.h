@@ -534,6 +534,24 @@ public:
         int from = 0, int to = -1,
         DataItemComparator func = 0);
 
+    /*!
+    * sort the rows on a worker thread
+    * \sa sortRows()
+    */
+    void sortRowsAsync(const QVector<int> &columns,
+        QicsSortOrder order = Qics::Ascending,
+        int from = 0, int to = -1,
+        DataItemComparator func = 0);
+
+    /*!
+    * sort the columns on a worker thread
+    * \sa sortColumns()
+    */
+    void sortColumnsAsync(const QVector<int> &rows,
+        QicsSortOrder order = Qics::Ascending,
+        int from = 0, int to = -1,
+        DataItemComparator func = 0);
+
     /*!
     * Sets case sensitivity while sorting to \a cs.
     * \sa sortColumns(), sortRows()
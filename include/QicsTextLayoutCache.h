@@ -0,0 +1,120 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#ifndef QICSTEXTLAYOUTCACHE_H
+#define QICSTEXTLAYOUTCACHE_H
+
+#include <QCache>
+#include <QString>
+#include <QSize>
+#include <QFont>
+#include <QLineEdit>
+#include "QicsNamespace.h"
+
+/*! \file */
+
+/*!
+* \internal
+* \class QicsTextLayoutKey QicsTextLayoutCache.h
+* \brief Key of an entry in QicsTextLayoutCache.
+*/
+struct QicsTextLayoutKey
+{
+    QicsTextLayoutKey(const QString &t, const QString &a, int w, int h, int f)
+        : text(t), aux(a), width(w), height(h), flags(f) {}
+
+    inline bool operator==(const QicsTextLayoutKey &other) const
+    {
+        return (width == other.width && height == other.height &&
+            flags == other.flags && text == other.text && aux == other.aux);
+    }
+
+    QString text;
+    // font key or input mask
+    QString aux;
+    int width;
+    int height;
+    int flags;
+};
+
+inline uint qHash(const QicsTextLayoutKey &key)
+{
+    return (qHash(key.text) ^ (qHash(key.aux) * 31) ^
+        uint(key.width * 131 + key.height * 17 + key.flags));
+}
+
+/*!
+* \internal
+* \class QicsTextLayoutCache QicsTextLayoutCache.h
+* \brief A bounded cache of displayed strings and their measurements.
+*
+* Text cell displays derive the string they draw by passing the cell's
+* text through a QLineEdit to apply the echo mode and input mask, and
+* then measure it with QFontMetrics to decide whether it fits the cell.
+* Both steps give the same answer as long as the text, font, area and
+* flags do not change, which is the case for most cells between two
+* repaints.  QicsTextLayoutCache remembers the answers, so that
+* repainting an unchanged cell does not lay out its text again.
+*
+* Entries are keyed by value, so a changed string, font or cell size
+* simply misses the cache.  The least recently used entries are dropped
+* when the cache holds more than maxEntries() of them.
+* \since 3.1
+*/
+class QICS_EXPORT QicsTextLayoutCache
+{
+public:
+    /*!
+    * Constructs an empty cache which holds at most \a max_entries
+    * entries of each kind.
+    */
+    explicit QicsTextLayoutCache(int max_entries = 4096);
+
+    /*!
+    * Returns the largest number of entries of each kind the cache holds.
+    */
+    inline int maxEntries() const { return myDisplayTexts.maxCost(); }
+
+    /*!
+    * Removes all entries.
+    */
+    void clear();
+
+    /*!
+    * Returns the text \a edit would display for \a text with echo mode
+    * \a mode and input mask \a mask.  \a edit is only used if the
+    * answer is not cached yet.
+    */
+    QString displayText(QLineEdit *edit, const QString &text,
+        QLineEdit::EchoMode mode, const QString &mask);
+
+    /*!
+    * Returns the size of the bounding rectangle of \a text drawn with
+    * \a font and \a flags in an area of size \a area, as given by
+    * QFontMetrics::boundingRect().
+    */
+    QSize boundingSize(const QFont &font, const QSize &area, int flags,
+        const QString &text);
+
+    /*!
+    * Returns the advance width of \a text drawn with \a font, as given
+    * by QFontMetrics::width().
+    */
+    int textWidth(const QFont &font, const QString &text);
+
+private:
+    QCache<QicsTextLayoutKey, QString> myDisplayTexts;
+    QCache<QicsTextLayoutKey, QSize> myMeasures;
+    QCache<QicsTextLayoutKey, int> myWidths;
+};
+
+#endif //QICSTEXTLAYOUTCACHE_H
@@ -30,4 +30,7 @@ int QicsAbstractSorterDelegate::stringCompare(const QString &str1, const QString
     return QString::compare(str1, str2, m_sortingSensitivity);
 }
 
-
+bool QicsAbstractSorterDelegate::buildSortKeys(const QVector<int> &, int, QicsSortKeyColumn &)
+{
+    return false;
+}
@@ -0,0 +1,161 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#include "QicsAutoFitCache.h"
+
+#include <algorithm>
+#include "QicsDataModel.h"
+
+
+QicsAutoFitCache::QicsAutoFitCache(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void QicsAutoFitCache::setDataModel(QicsDataModel *dm)
+{
+    if (myDataModel)
+        disconnect(myDataModel, 0, this, 0);
+
+    myDataModel = dm;
+    clear();
+
+    if (!dm)
+        return;
+
+    // cellValueChanged() is always preceded by modelChanged() for the
+    // same cell, so modelChanged() covers both
+    connect(dm, SIGNAL(modelChanged(const QicsRegion &)),
+        this, SLOT(handleModelChanged(const QicsRegion &)));
+    connect(dm, SIGNAL(rowsInserted(int, int)),
+        this, SLOT(handleRowsInserted(int, int)));
+    connect(dm, SIGNAL(rowsDeleted(int, int)),
+        this, SLOT(handleRowsDeleted(int, int)));
+    connect(dm, SIGNAL(columnsInserted(int, int)),
+        this, SLOT(handleColumnsInserted(int, int)));
+    connect(dm, SIGNAL(columnsDeleted(int, int)),
+        this, SLOT(handleColumnsDeleted(int, int)));
+    // reported after a batch or after the model was refilled with its
+    // signals off, with no word of which cells changed
+    connect(dm, SIGNAL(modelSizeChanged(int, int)),
+        this, SLOT(handleModelSizeChanged(int, int)));
+}
+
+void QicsAutoFitCache::clear()
+{
+    myColumns.clear();
+}
+
+void QicsAutoFitCache::validateColumn(int col, int column_width, uint style_revision)
+{
+    if (col < 0)
+        return;
+
+    if (col >= myColumns.size())
+        myColumns.resize(col + 1);
+
+    Column &column = myColumns[col];
+
+    if (column.columnWidth != column_width || column.styleRevision != style_revision) {
+        column.widths.clear();
+        column.columnWidth = column_width;
+        column.styleRevision = style_revision;
+    }
+}
+
+void QicsAutoFitCache::setWidth(int row, int col, int width)
+{
+    if (row < 0 || col < 0 || width < 0)
+        return;
+
+    if (col >= myColumns.size())
+        myColumns.resize(col + 1);
+
+    QVector<int> &widths = myColumns[col].widths;
+
+    if (row >= widths.size())
+        widths.resize(row + 1);
+
+    widths[row] = width + 1;
+}
+
+void QicsAutoFitCache::handleModelChanged(const QicsRegion &reg)
+{
+    if (!reg.isValid()) {
+        clear();
+        return;
+    }
+
+    const int end_col = qMin(reg.endColumn(), myColumns.size() - 1);
+
+    for (int col = qMax(reg.startColumn(), 0); col <= end_col; ++col) {
+        QVector<int> &widths = myColumns[col].widths;
+
+        const int start_row = qMax(reg.startRow(), 0);
+        const int end_row = qMin(reg.endRow(), widths.size() - 1);
+
+        if (start_row == 0 && end_row == widths.size() - 1)
+            widths.clear();
+        else if (start_row <= end_row)
+            std::fill(widths.begin() + start_row, widths.begin() + end_row + 1, 0);
+    }
+}
+
+void QicsAutoFitCache::handleRowsInserted(int num, int pos)
+{
+    if (num <= 0 || pos < 0)
+        return;
+
+    for (int col = 0; col < myColumns.size(); ++col) {
+        QVector<int> &widths = myColumns[col].widths;
+
+        if (pos < widths.size())
+            widths.insert(pos, num, 0);
+    }
+}
+
+void QicsAutoFitCache::handleRowsDeleted(int num, int pos)
+{
+    if (num <= 0 || pos < 0)
+        return;
+
+    for (int col = 0; col < myColumns.size(); ++col) {
+        QVector<int> &widths = myColumns[col].widths;
+
+        if (pos < widths.size())
+            widths.remove(pos, qMin(num, widths.size() - pos));
+    }
+}
+
+void QicsAutoFitCache::handleColumnsInserted(int num, int pos)
+{
+    if (num <= 0 || pos < 0 || pos >= myColumns.size())
+        return;
+
+    myColumns.insert(pos, num, Column());
+}
+
+void QicsAutoFitCache::handleColumnsDeleted(int num, int pos)
+{
+    if (num <= 0 || pos < 0 || pos >= myColumns.size())
+        return;
+
+    myColumns.remove(pos, qMin(num, myColumns.size() - pos));
+}
+
+void QicsAutoFitCache::handleModelSizeChanged(int rows, int cols)
+{
+    Q_UNUSED(rows);
+    Q_UNUSED(cols);
+
+    clear();
+}
@@ -72,13 +72,19 @@ void QicsCell::init()
     }
     else {
         // connect to the row and column ordering objects
-        if (m_info->rowOrdering())
+        if (m_info->rowOrdering()) {
             connect(m_info->rowOrdering(), SIGNAL(orderChanged(Qics::QicsIndexType, int*, int)),
                 this, SLOT(handleOrderChanged(Qics::QicsIndexType, int*, int)));
+            connect(m_info->rowOrdering(), SIGNAL(itemMoved(Qics::QicsIndexType, int, int)),
+                this, SLOT(handleItemMoved(Qics::QicsIndexType, int, int)));
+        }
 
-        if (m_info->columnOrdering())
+        if (m_info->columnOrdering()) {
             connect(m_info->columnOrdering(), SIGNAL(orderChanged(Qics::QicsIndexType, int*, int)),
                 this, SLOT(handleOrderChanged(Qics::QicsIndexType, int*, int)));
+            connect(m_info->columnOrdering(), SIGNAL(itemMoved(Qics::QicsIndexType, int, int)),
+                this, SLOT(handleItemMoved(Qics::QicsIndexType, int, int)));
+        }
     }
 }
 
@@ -445,9 +451,6 @@ bool QicsCell::selected() const
     const QicsSelectionManager *sm = m_info->selectionManager();
     if (!sm) return false;
 
-    const QicsSelectionList* list = sm->selectionList(true);
-    if (!list) return false;
-
     QicsGridType gt = m_info->gridType();
     const int row = rowIndex();
     const int col = columnIndex();
@@ -456,13 +459,13 @@ bool QicsCell::selected() const
 
     switch (gt) {
         case Qics::RowHeaderGrid:
-            b = list->isRowSelected(row);
+            b = sm->isRowSelected(row);
             break;
         case Qics::ColumnHeaderGrid:
-            b = list->isColumnSelected(col);
+            b = sm->isColumnSelected(col);
             break;
         default:
-            b = list->isCellSelected(row, col);
+            b = sm->isCellSelected(row, col);
     }
 
     if (!b) {
@@ -539,6 +542,18 @@ void QicsCell::handleOrderChanged(Qics::QicsIndexType type, int* visChange, int
     }
 }
 
+void QicsCell::handleItemMoved(Qics::QicsIndexType type, int from, int to)
+{
+    if (type == Qics::RowIndex) {
+        if (myRow >= 0)
+            myRow = QicsSorter::movedIndex(myRow, from, to);
+    }
+    else {
+        if (myColumn >= 0)
+            myColumn = QicsSorter::movedIndex(myColumn, from, to);
+    }
+}
+
 void QicsCell::changeDataModel(QicsDataModel *old_dt, QicsDataModel *)
 {
     // get rid of connections to old data model
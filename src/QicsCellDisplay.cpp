@@ -353,23 +353,21 @@ void QicsCellDisplay::commonInit(QicsGrid *grid, int row, int col,
 
     // special header highlight
     if (sm && d->ginfo->gridType() != Qics::TableGrid && !d->is_selected && myGrid->highlightSelection() && !d->for_printer) {
-        QicsSelectionList* list = sm->selectionList();
-        if (list) {
-            // add current selection to the list
-            if (sm->currentSelection())
-                list->append(*sm->currentSelection());
-
-            bool sel = false;
-            if (d->ginfo->gridType() == Qics::RowHeaderGrid)
-                sel = list->isRowSelected(row, false);
-            else
-                sel = list->isColumnSelected(col, false);
-            if (sel) {
-                d->is_selected = true;
-                d->bg = myCell->highlightBackgroundColor();
-                d->fg = myCell->highlightForegroundColor();
-            }
-            delete list;
+        // the selection list and the current selection, without copying
+        // the list for every header cell
+        const QicsSelection *cur = sm->currentSelection();
+
+        bool sel = false;
+        if (d->ginfo->gridType() == Qics::RowHeaderGrid)
+            sel = sm->isRowSelected(row, false) ||
+                (cur && row >= cur->topRow() && row <= cur->bottomRow());
+        else
+            sel = sm->isColumnSelected(col, false) ||
+                (cur && col >= cur->leftColumn() && col <= cur->rightColumn());
+        if (sel) {
+            d->is_selected = true;
+            d->bg = myCell->highlightBackgroundColor();
+            d->fg = myCell->highlightForegroundColor();
         }
     }
 
@@ -61,9 +61,12 @@ void QicsColumn::init()
     }
     else {
         // connect to the column ordering object
-        if (m_info->columnOrdering())
+        if (m_info->columnOrdering()) {
             connect(m_info->columnOrdering(), SIGNAL(orderChanged(Qics::QicsIndexType, int*, int)),
                 this, SLOT(handleOrderChanged(Qics::QicsIndexType, int*, int)));
+            connect(m_info->columnOrdering(), SIGNAL(itemMoved(Qics::QicsIndexType, int, int)),
+                this, SLOT(handleItemMoved(Qics::QicsIndexType, int, int)));
+        }
     }
 }
 
@@ -276,11 +279,7 @@ bool QicsColumn::selected() const
     const QicsSelectionManager *sm = m_info->selectionManager();
     if (!sm) return false;
 
-    const QicsSelectionList* list = sm->selectionList(true);
-    if (!list) return false;
-
-    const int col = columnIndex();
-    return list->isColumnSelected(col);
+    return sm->isColumnSelected(columnIndex());
 }
 
 void QicsColumn::hide()
@@ -336,6 +335,12 @@ void QicsColumn::handleOrderChanged(Qics::QicsIndexType type, int* visChange, in
     }
 }
 
+void QicsColumn::handleItemMoved(Qics::QicsIndexType type, int from, int to)
+{
+    if (type == Qics::ColumnIndex && myColumn >= 0)
+        myColumn = QicsSorter::movedIndex(myColumn, from, to);
+}
+
 void QicsColumn::changeDataModel(QicsDataModel *old_dt, QicsDataModel *)
 {
     // get rid of connections to old data model
@@ -0,0 +1,933 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#include "QicsColumnarDataModel.h"
+
+#include <QHash>
+#include <QVector>
+
+
+////////////////////////////////////////////////////////////////////////
+
+// Bitmap which opens up and closes gaps a whole word at a time, so that
+// inserting or removing rows costs O(n/32) instead of O(n).  Bits past
+// the size are always clear.
+
+class QicsColumnarBits
+{
+public:
+    QicsColumnarBits() : mySize(0) {}
+
+    inline int size() const { return mySize; }
+
+    inline bool testBit(int i) const
+    { return (myWords.at(i >> 5) & (1u << (i & 31))) != 0; }
+
+    inline void setBit(int i)
+    { myWords[i >> 5] |= (1u << (i & 31)); }
+
+    inline void clearBit(int i)
+    { myWords[i >> 5] &= ~(1u << (i & 31)); }
+
+    inline void setBit(int i, bool on)
+    { if (on) setBit(i); else clearBit(i); }
+
+    void resize(int size);
+    void insert(int pos, int count);
+    void remove(int pos, int count);
+
+private:
+    quint32 word(int bit) const;
+    void setWord(int bit, quint32 value, int count);
+    void copyTail(int from, int to);
+
+    QVector<quint32> myWords;
+    int mySize;
+};
+
+void QicsColumnarBits::resize(int size)
+{
+    myWords.resize((size + 31) >> 5);
+    mySize = size;
+
+    // keep the bits past the end clear for the next growth
+    if (size & 31)
+        myWords.last() &= (1u << (size & 31)) - 1;
+}
+
+// Returns the 32 bits starting at \a bit, which need not be aligned.
+quint32 QicsColumnarBits::word(int bit) const
+{
+    const int i = bit >> 5;
+    const int o = bit & 31;
+
+    quint32 value = myWords.at(i) >> o;
+    if (o && i + 1 < myWords.size())
+        value |= myWords.at(i + 1) << (32 - o);
+
+    return value;
+}
+
+// Stores the low \a count (at most 32) bits of \a value at \a bit.
+void QicsColumnarBits::setWord(int bit, quint32 value, int count)
+{
+    const int i = bit >> 5;
+    const int o = bit & 31;
+    const quint32 mask = (count < 32) ? ((1u << count) - 1) : ~0u;
+
+    value &= mask;
+    myWords[i] = (myWords.at(i) & ~(mask << o)) | (value << o);
+    if (o && o + count > 32)
+        myWords[i + 1] = (myWords.at(i + 1) & ~(mask >> (32 - o))) | (value >> (32 - o));
+}
+
+// Moves the bits from \a from up to the end to \a to, a word at a time;
+// the bits which are left behind keep their values.
+void QicsColumnarBits::copyTail(int from, int to)
+{
+    const int len = mySize - qMax(from, to);
+    if (len <= 0 || from == to)
+        return;
+
+    if (to < from) {
+        for (int k = 0; k < len; k += 32)
+            setWord(to + k, word(from + k), qMin(32, len - k));
+    }
+    else {
+        // backwards, so that nothing is overwritten before it is read
+        for (int k = ((len - 1) & ~31); k >= 0; k -= 32)
+            setWord(to + k, word(from + k), qMin(32, len - k));
+    }
+}
+
+void QicsColumnarBits::insert(int pos, int count)
+{
+    if (count <= 0 || pos < 0)
+        return;
+
+    const int old_size = mySize;
+    resize(old_size + count);
+
+    if (pos >= old_size)
+        return;
+
+    copyTail(pos, pos + count);
+
+    // the gap starts out clear
+    for (int k = 0; k < count; k += 32)
+        setWord(pos + k, 0, qMin(32, count - k));
+}
+
+void QicsColumnarBits::remove(int pos, int count)
+{
+    if (count <= 0 || pos < 0 || pos >= mySize)
+        return;
+
+    count = qMin(count, mySize - pos);
+
+    copyTail(pos + count, pos);
+    resize(mySize - count);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Returns the column type which keeps values of \a type without loss.
+static QicsColumnarDataModel::ColumnType columnTypeFor(QicsDataItemType type)
+{
+    switch (type)
+    {
+    case QicsDataItem_Int:
+    case QicsDataItem_Long:
+    case QicsDataItem_LongLong:
+        return QicsColumnarDataModel::Int64Column;
+    case QicsDataItem_Float:
+    case QicsDataItem_Double:
+        return QicsColumnarDataModel::DoubleColumn;
+    case QicsDataItem_Bool:
+        return QicsColumnarDataModel::BoolColumn;
+    case QicsDataItem_Date:
+        return QicsColumnarDataModel::DateColumn;
+    default:
+        break;
+    }
+    return QicsColumnarDataModel::StringColumn;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Storage of a single column.  Only the vector that matches the type
+// of the column is used, the others stay empty.  Rows at or beyond
+// mySize have never been written and are treated as empty.
+
+class QicsColumnarColumn
+{
+public:
+    QicsColumnarColumn(QicsColumnarDataModel::ColumnType type = QicsColumnarDataModel::AutoColumn)
+        : myType(type), mySize(0)
+    {
+    }
+
+    inline QicsColumnarDataModel::ColumnType type() const { return myType; }
+    inline int size() const { return mySize; }
+
+    inline bool hasValue(int row) const
+    { return (row >= 0 && row < mySize && myValid.testBit(row)); }
+
+    inline double doubleAt(int row) const { return myDoubles.at(row); }
+    inline qint64 int64At(int row) const { return myInts.at(row); }
+    inline bool boolAt(int row) const { return myBools.testBit(row); }
+    inline QDate dateAt(int row) const { return QDate::fromJulianDay(myInts.at(row)); }
+    inline const QString &stringAt(int row) const { return myDictionary.at(myIds.at(row)); }
+
+    inline int dictionarySize() const { return myDictionary.size(); }
+
+    bool isEmpty() const;
+
+    void resize(int rows);
+    void insert(int pos, int count);
+    void remove(int pos, int count);
+    void clearValue(int row);
+    void store(int row, int num_rows, const QicsDataItem &it);
+    void compactDictionary();
+
+private:
+    int intern(const QString &str);
+
+    QicsColumnarDataModel::ColumnType myType;
+    int mySize;
+
+    // null bitmap, a set bit means that the cell has a value
+    QicsColumnarBits myValid;
+
+    QVector<double> myDoubles;
+    // used by Int64Column and DateColumn (julian days)
+    QVector<qint64> myInts;
+    QicsColumnarBits myBools;
+    // ids into myDictionary
+    QVector<int> myIds;
+
+    QVector<QString> myDictionary;
+    QHash<QString, int> myDictionaryIndex;
+};
+
+bool QicsColumnarColumn::isEmpty() const
+{
+    for (int r = 0; r < mySize; ++r) {
+        if (!myValid.testBit(r))
+            continue;
+
+        // only an empty string does not count as data
+        if (myType != QicsColumnarDataModel::StringColumn || !stringAt(r).isEmpty())
+            return false;
+    }
+
+    return true;
+}
+
+void QicsColumnarColumn::resize(int rows)
+{
+    myValid.resize(rows);
+
+    switch (myType)
+    {
+    case QicsColumnarDataModel::DoubleColumn:
+        myDoubles.resize(rows);
+        break;
+    case QicsColumnarDataModel::Int64Column:
+    case QicsColumnarDataModel::DateColumn:
+        myInts.resize(rows);
+        break;
+    case QicsColumnarDataModel::BoolColumn:
+        myBools.resize(rows);
+        break;
+    case QicsColumnarDataModel::StringColumn:
+        myIds.resize(rows);
+        break;
+    default:
+        break;
+    }
+
+    mySize = rows;
+}
+
+void QicsColumnarColumn::insert(int pos, int count)
+{
+    // nothing was stored past the end, so nothing has to be shifted
+    if (pos >= mySize)
+        return;
+
+    myValid.insert(pos, count);
+
+    switch (myType)
+    {
+    case QicsColumnarDataModel::DoubleColumn:
+        myDoubles.insert(pos, count, 0.0);
+        break;
+    case QicsColumnarDataModel::Int64Column:
+    case QicsColumnarDataModel::DateColumn:
+        myInts.insert(pos, count, 0);
+        break;
+    case QicsColumnarDataModel::BoolColumn:
+        myBools.insert(pos, count);
+        break;
+    case QicsColumnarDataModel::StringColumn:
+        myIds.insert(pos, count, 0);
+        break;
+    default:
+        break;
+    }
+
+    mySize += count;
+}
+
+void QicsColumnarColumn::remove(int pos, int count)
+{
+    if (pos >= mySize)
+        return;
+
+    count = qMin(count, mySize - pos);
+
+    myValid.remove(pos, count);
+
+    switch (myType)
+    {
+    case QicsColumnarDataModel::DoubleColumn:
+        myDoubles.remove(pos, count);
+        break;
+    case QicsColumnarDataModel::Int64Column:
+    case QicsColumnarDataModel::DateColumn:
+        myInts.remove(pos, count);
+        break;
+    case QicsColumnarDataModel::BoolColumn:
+        myBools.remove(pos, count);
+        break;
+    case QicsColumnarDataModel::StringColumn:
+        myIds.remove(pos, count);
+        break;
+    default:
+        break;
+    }
+
+    mySize -= count;
+}
+
+void QicsColumnarColumn::clearValue(int row)
+{
+    if (row < mySize)
+        myValid.clearBit(row);
+}
+
+int QicsColumnarColumn::intern(const QString &str)
+{
+    QHash<QString, int>::const_iterator it = myDictionaryIndex.constFind(str);
+    if (it != myDictionaryIndex.constEnd())
+        return it.value();
+
+    const int id = myDictionary.size();
+    myDictionary.append(str);
+    myDictionaryIndex.insert(str, id);
+    return id;
+}
+
+void QicsColumnarColumn::store(int row, int num_rows, const QicsDataItem &it)
+{
+    const QicsDataItemType item_type = it.type();
+
+    if (myType == QicsColumnarDataModel::AutoColumn)
+        myType = columnTypeFor(item_type);
+
+    // like the default model, grow to the full model size at once
+    if (mySize <= row)
+        resize(num_rows);
+
+    bool ok = true;
+
+    switch (myType)
+    {
+    case QicsColumnarDataModel::DoubleColumn:
+        myDoubles[row] = it.number(&ok);
+        break;
+    case QicsColumnarDataModel::Int64Column:
+        if (item_type == QicsDataItem_Int)
+            myInts[row] = static_cast<const QicsDataInt &>(it).data();
+        else if (item_type == QicsDataItem_Long)
+            myInts[row] = static_cast<const QicsDataLong &>(it).data();
+        else if (item_type == QicsDataItem_LongLong)
+            myInts[row] = static_cast<const QicsDataLongLong &>(it).data();
+        else
+            myInts[row] = qRound64(it.number(&ok));
+        break;
+    case QicsColumnarDataModel::BoolColumn:
+        if (item_type == QicsDataItem_Bool)
+            myBools.setBit(row, static_cast<const QicsDataBool &>(it).data());
+        else if (item_type == QicsDataItem_String) {
+            const QString str = it.string();
+            if (str == QICS_DEFAULT_TRUE_STRING)
+                myBools.setBit(row, true);
+            else if (str == QICS_DEFAULT_FALSE_STRING)
+                myBools.setBit(row, false);
+            else
+                myBools.setBit(row, it.number(&ok) != 0);
+        }
+        else
+            myBools.setBit(row, it.number(&ok) != 0);
+        break;
+    case QicsColumnarDataModel::DateColumn:
+        {
+            QDate date;
+            if (item_type == QicsDataItem_Date)
+                date = static_cast<const QicsDataDate &>(it).data();
+            else if (item_type == QicsDataItem_DateTime)
+                date = static_cast<const QicsDataDateTime &>(it).data().date();
+            else {
+                const QString str = it.string();
+                date = QDate::fromString(str);
+                if (!date.isValid())
+                    date = QDate::fromString(str, Qt::ISODate);
+            }
+
+            ok = date.isValid();
+            if (ok)
+                myInts[row] = date.toJulianDay();
+        }
+        break;
+    case QicsColumnarDataModel::StringColumn:
+        myIds[row] = intern(it.string());
+        break;
+    default:
+        ok = false;
+        break;
+    }
+
+    myValid.setBit(row, ok);
+}
+
+void QicsColumnarColumn::compactDictionary()
+{
+    if (myType != QicsColumnarDataModel::StringColumn)
+        return;
+
+    QVector<int> remap(myDictionary.size(), -1);
+    QVector<QString> dictionary;
+    myDictionaryIndex.clear();
+
+    for (int r = 0; r < mySize; ++r) {
+        if (!myValid.testBit(r))
+            continue;
+
+        const int id = myIds.at(r);
+        if (remap.at(id) < 0) {
+            remap[id] = dictionary.size();
+            dictionary.append(myDictionary.at(id));
+            myDictionaryIndex.insert(myDictionary.at(id), remap.at(id));
+        }
+        myIds[r] = remap.at(id);
+    }
+
+    myDictionary = dictionary;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+QicsColumnarDataModel::QicsColumnarDataModel(int num_rows, int num_cols, QObject *parent)
+    : QicsDataModel(num_rows, num_cols, parent),
+        myItemSlot(0)
+{
+    // columns are cheap until data is stored in them
+    myColumns.reserve(numColumns());
+    for (int c = 0; c < numColumns(); ++c)
+        myColumns.append(new QicsColumnarColumn);
+}
+
+QicsColumnarDataModel::~QicsColumnarDataModel()
+{
+    releaseScratchItems();
+    qDeleteAll(myColumns);
+}
+
+QicsDataModel *QicsColumnarDataModel::create(int num_rows , int num_cols, QObject *parent)
+{
+    return (new QicsColumnarDataModel(num_rows, num_cols, parent));
+}
+
+QicsColumnarDataModel::ColumnType QicsColumnarDataModel::columnType(int col) const
+{
+    if (col < 0 || col >= myColumns.size())
+        return AutoColumn;
+
+    return myColumns.at(col)->type();
+}
+
+void QicsColumnarDataModel::setColumnType(int col, ColumnType type)
+{
+    if (col < 0 || col >= myColumns.size())
+        return;
+
+    QicsColumnarColumn *old_column = myColumns.at(col);
+    if (old_column->type() == type)
+        return;
+
+    QicsColumnarColumn *new_column = new QicsColumnarColumn(type);
+
+    // convert the values through data items, this is not a hot path
+    if (type != AutoColumn) {
+        const int size = qMin(old_column->size(), numRows());
+        for (int r = 0; r < size; ++r) {
+            QicsDataItem *it = createItem(r, col);
+            if (it) {
+                new_column->store(r, numRows(), *it);
+                delete it;
+            }
+        }
+    }
+
+    const bool had_data = (old_column->size() > 0);
+
+    myColumns[col] = new_column;
+    delete old_column;
+
+    if (had_data)
+        reportRegionChanged(QicsRegion(0, col, lastRow(), col));
+}
+
+int QicsColumnarDataModel::dictionarySize(int col) const
+{
+    if (col < 0 || col >= myColumns.size())
+        return 0;
+
+    return myColumns.at(col)->dictionarySize();
+}
+
+void QicsColumnarDataModel::compactDictionary(int col)
+{
+    if (col < 0 || col >= myColumns.size())
+        return;
+
+    myColumns.at(col)->compactDictionary();
+}
+
+bool QicsColumnarDataModel::isNull(int row, int col) const
+{
+    if (!contains(row, col))
+        return true;
+
+    return !myColumns.at(col)->hasValue(row);
+}
+
+double QicsColumnarDataModel::number(int row, int col, bool *ok) const
+{
+    if (ok) *ok = false;
+
+    if (!contains(row, col))
+        return 0;
+
+    const QicsColumnarColumn *c = myColumns.at(col);
+    if (!c->hasValue(row))
+        return 0;
+
+    switch (c->type())
+    {
+    case DoubleColumn:
+        if (ok) *ok = true;
+        return c->doubleAt(row);
+    case Int64Column:
+        if (ok) *ok = true;
+        return double(c->int64At(row));
+    case BoolColumn:
+        if (ok) *ok = true;
+        return c->boolAt(row) ? 1 : 0;
+    case StringColumn:
+        if (c->stringAt(row).isEmpty())
+            return 0;
+        return c->stringAt(row).toDouble(ok);
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+const QicsDataItem *QicsColumnarDataModel::item(int row, int col) const
+{
+    if (!contains(row, col))
+        return 0;
+
+    const QicsColumnarColumn *c = myColumns.at(col);
+    if (!c->hasValue(row))
+        return 0;
+
+    myItemSlot = (myItemSlot + 1) % ItemSlots;
+
+    switch (c->type())
+    {
+    case DoubleColumn:
+        myDoubleItems[myItemSlot].setData(c->doubleAt(row));
+        return &myDoubleItems[myItemSlot];
+    case Int64Column:
+        myInt64Items[myItemSlot].setData(c->int64At(row));
+        return &myInt64Items[myItemSlot];
+    case BoolColumn:
+        myBoolItems[myItemSlot].setData(c->boolAt(row));
+        return &myBoolItems[myItemSlot];
+    case DateColumn:
+        myDateItems[myItemSlot].setData(c->dateAt(row));
+        return &myDateItems[myItemSlot];
+    case StringColumn:
+        myStringItems[myItemSlot].setData(c->stringAt(row));
+        return &myStringItems[myItemSlot];
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+QicsDataItem *QicsColumnarDataModel::createItem(int row, int col) const
+{
+    const QicsDataItem *it = item(row, col);
+    return (it ? it->clone() : 0);
+}
+
+QString QicsColumnarDataModel::itemString(int row, int col) const
+{
+    if (!contains(row, col))
+        return QString();
+
+    const QicsColumnarColumn *c = myColumns.at(col);
+    if (!c->hasValue(row))
+        return QString();
+
+    // no need to go through a data item for strings
+    if (c->type() == StringColumn)
+        return c->stringAt(row);
+
+    return item(row, col)->string();
+}
+
+void QicsColumnarDataModel::releaseScratchItems() const
+{
+    qDeleteAll(myScratchItems);
+    myScratchItems.clear();
+}
+
+QicsDataModelRow QicsColumnarDataModel::rowItems(int row, int first_col, int last_col) const
+{
+    QicsDataModelRow qt;
+
+    releaseScratchItems();
+
+    if ((last_col == -1) || (last_col > lastColumn()))
+        last_col = lastColumn();
+
+    if (first_col < 0)
+        first_col = 0;
+
+    if (last_col < first_col)
+        return qt;
+
+    // create the vector, even if we don't have it, we will return a full
+    // vector containing NULLS.
+    qt.resize(last_col - first_col + 1);
+
+    if (row < 0 || row > lastRow())
+        return qt;
+
+    for (int col = first_col; col <= last_col; ++col) {
+        QicsDataItem *it = createItem(row, col);
+        if (it) {
+            myScratchItems.append(it);
+            qt[col - first_col] = it;
+        }
+    }
+
+    return qt;
+}
+
+QicsDataModelColumn QicsColumnarDataModel::columnItems(int col, int first_row, int last_row) const
+{
+    QicsDataModelColumn qc;
+
+    releaseScratchItems();
+
+    if ((last_row == -1) || (last_row > lastRow()))
+        last_row = lastRow();
+
+    if (first_row < 0)
+        first_row = 0;
+
+    if (last_row < first_row)
+        return qc;
+
+    // set it up and make them all null
+    qc.resize(last_row - first_row + 1);
+
+    if (col < 0 || col > lastColumn())
+        return qc;
+
+    // only rows which were written can have values
+    last_row = qMin(last_row, myColumns.at(col)->size() - 1);
+
+    for (int r = first_row; r <= last_row; ++r) {
+        QicsDataItem *it = createItem(r, col);
+        if (it) {
+            myScratchItems.append(it);
+            qc[r - first_row] = it;
+        }
+    }
+
+    return qc;
+}
+
+void QicsColumnarDataModel::storeItem(int row, int col, const QicsDataItem &it)
+{
+    myColumns.at(col)->store(row, numRows(), it);
+}
+
+void QicsColumnarDataModel::setItem(int row, int col, const QicsDataItem &it)
+{
+    // sanity check...
+    if (!contains(row, col)) return;
+
+    storeItem(row, col, it);
+
+    reportCellChanged(row, col);
+}
+
+void QicsColumnarDataModel::clearItem(int row, int col)
+{
+    if (!contains(row, col))
+        return;
+
+    QicsColumnarColumn *c = myColumns.at(col);
+    if (!c->hasValue(row))
+        return;
+
+    c->clearValue(row);
+
+    reportRegionChanged(QicsRegion(row,col));
+}
+
+void QicsColumnarDataModel::setColumnItems(int col, const QicsDataModelColumn &in_vector)
+{
+    if (!contains(0, col)) return; // No-op for col out of model.
+
+    QicsColumnarColumn *c = myColumns.at(col);
+    const int size = qMin(in_vector.size(), numRows());
+
+    for (int r = 0; r < size; ++r) {
+        if (in_vector.at(r))
+            c->store(r, numRows(), *(in_vector.at(r)));
+        else
+            c->clearValue(r);
+    }
+
+    reportRegionChanged(QicsRegion(0, col, lastRow(), col));
+}
+
+void QicsColumnarDataModel::setRowItems(int row, const QicsDataModelRow &in_vector)
+{
+    if (!contains(row, 0)) return; // No-op for row out of model.
+
+    const int size = qMin(in_vector.size(), numColumns());
+
+    for (int c = 0; c < size; ++c) {
+        if (in_vector.at(c))
+            storeItem(row, c, *(in_vector.at(c)));
+        else
+            myColumns.at(c)->clearValue(row);
+    }
+
+    reportRegionChanged(QicsRegion(row,0,row,lastColumn()));
+}
+
+void QicsColumnarDataModel::clearModel()
+{
+    int num_rows = numRows();
+    int num_cols = numColumns();
+
+    flushBatchedChanges();
+
+    releaseScratchItems();
+    qDeleteAll(myColumns);
+    myColumns.clear();
+
+    setNumRows(0);
+    setNumColumns(0);
+
+    if (m_emitSignals) {
+        reportSizeChanged();
+        emit rowsDeleted(num_rows, 0);
+        emit columnsDeleted(num_cols, 0);
+    }
+}
+
+void QicsColumnarDataModel::insertColumns(int number_of_cols, int starting_position)
+{
+    if ((number_of_cols <= 0) || (starting_position < 0)) return;
+
+    flushBatchedChanges();
+
+    emit prepareForColumnChanges(number_of_cols, starting_position);
+
+    if (starting_position > lastColumn())
+        starting_position = numColumns();
+
+    // only the column pointers are moved, no data is touched
+    myColumns.insert(starting_position, number_of_cols, 0);
+    for (int c = starting_position; c < starting_position + number_of_cols; ++c)
+        myColumns[c] = new QicsColumnarColumn;
+
+    setNumColumns(numColumns() + number_of_cols);
+
+    emit columnsInserted(number_of_cols, starting_position);
+
+    reportSizeChanged(starting_position, number_of_cols, Qics::ColumnIndex);
+}
+
+void QicsColumnarDataModel::insertRows(int number_of_rows, int starting_position)
+{
+    if (starting_position < 0 || number_of_rows <= 0) return;
+
+    flushBatchedChanges();
+
+    emit prepareForRowChanges(number_of_rows, starting_position);
+
+    // for insertions out of model, just expand the model.
+    if (starting_position > lastRow())
+        starting_position = numRows();
+    else {
+        const int num_cols = myColumns.size();
+        for (int c = 0; c < num_cols; ++c)
+            myColumns.at(c)->insert(starting_position, number_of_rows);
+    }
+
+    setNumRows(numRows() + number_of_rows);
+
+    emit rowsInserted(number_of_rows, starting_position);
+
+    reportSizeChanged(starting_position, number_of_rows, Qics::RowIndex);
+}
+
+void QicsColumnarDataModel::addColumns(int cols)
+{
+    if (cols <= 0) return;
+
+    for (int c = 0; c < cols; ++c)
+        myColumns.append(new QicsColumnarColumn);
+
+    setNumColumns(numColumns() + cols);
+
+    emit columnsAdded(cols);
+
+    reportSizeChanged();
+}
+
+void QicsColumnarDataModel::addRows(int rows)
+{
+    if (rows <= 0) return;
+
+    // columns grow when data is stored in the new rows
+    setNumRows(numRows() + rows);
+
+    emit rowsAdded(rows);
+
+    reportSizeChanged();
+}
+
+void QicsColumnarDataModel::deleteRows(int num_rows, int start_row)
+{
+    if ((start_row < 0) || (num_rows <= 0))
+        return;
+
+    flushBatchedChanges();
+
+    emit prepareForRowChanges(0-num_rows, start_row);
+
+    const int rows_deleted = qMax(0, qMin(num_rows, numRows() - start_row));
+
+    if (rows_deleted > 0) {
+        const int num_cols = myColumns.size();
+        for (int c = 0; c < num_cols; ++c)
+            myColumns.at(c)->remove(start_row, rows_deleted);
+
+        setNumRows(numRows() - rows_deleted);
+
+        emit rowsDeleted(rows_deleted, start_row);
+
+        reportSizeChanged(start_row, 0 - num_rows, Qics::RowIndex);
+    }
+}
+
+void QicsColumnarDataModel::deleteColumns(int num_cols, int start_col)
+{
+    if ((start_col < 0) || (num_cols <= 0))
+        return;
+
+    flushBatchedChanges();
+
+    emit prepareForColumnChanges(0-num_cols, start_col);
+
+    const int cols_deleted = qMax(0, qMin(num_cols, numColumns() - start_col));
+
+    if (cols_deleted > 0) {
+        for (int c = start_col; c < start_col + cols_deleted; ++c)
+            delete myColumns.at(c);
+        myColumns.remove(start_col, cols_deleted);
+
+        setNumColumns(numColumns() - cols_deleted);
+
+        emit columnsDeleted(cols_deleted, start_col);
+
+        reportSizeChanged(start_col, 0-num_cols, Qics::ColumnIndex);
+    }
+}
+
+void QicsColumnarDataModel::deleteRow(int row)
+{
+    deleteRows(1, row);
+}
+
+void QicsColumnarDataModel::deleteColumn(int col)
+{
+    deleteColumns(1, col);
+}
+
+bool QicsColumnarDataModel::isCellEmpty(int row, int col) const
+{
+    if (!contains(row, col))
+        return true;
+
+    const QicsColumnarColumn *c = myColumns.at(col);
+    if (!c->hasValue(row))
+        return true;
+
+    return (c->type() == StringColumn && c->stringAt(row).isEmpty());
+}
+
+bool QicsColumnarDataModel::isRowEmpty(int row) const
+{
+    const int num_cols = myColumns.size();
+    for (int c = 0; c < num_cols; ++c) {
+        if (!isCellEmpty(row, c))
+            return false;
+    }
+
+    return true;
+}
+
+bool QicsColumnarDataModel::isColumnEmpty(int column) const
+{
+    if (column < 0 || column >= myColumns.size())
+        return true;
+
+    return myColumns.at(column)->isEmpty();
+}
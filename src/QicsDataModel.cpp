@@ -21,7 +21,10 @@
 
 QicsDataModel::QicsDataModel(int num_rows, int num_cols, QObject *parent)
     : QObject(parent), myNumRows(num_rows), myNumColumns(num_cols),
-        m_emitSignals(true)
+        m_emitSignals(true),
+        myBatchDepth(0),
+        myBatchRegions(32),
+        myBatchSizeChanged(false)
 {
     if (myNumColumns < 0)
         myNumColumns = 0;
@@ -40,6 +43,89 @@ QString QicsDataModel::itemString(int row, int col) const
     return (itm ? itm->string() : QString());
 }
 
+void QicsDataModel::beginBatch()
+{
+    ++myBatchDepth;
+}
+
+void QicsDataModel::endBatch()
+{
+    if (myBatchDepth <= 0 || --myBatchDepth > 0)
+        return;
+
+    // the size first, so that the views lay out before they repaint
+    if (myBatchSizeChanged) {
+        myBatchSizeChanged = false;
+        if (m_emitSignals)
+            emit modelSizeChanged(numRows(), numColumns());
+    }
+
+    flushBatchedChanges();
+}
+
+void QicsDataModel::flushBatchedChanges()
+{
+    if (myBatchRegions.isEmpty())
+        return;
+
+    // take the changes first, as slots may change the model again
+    const QVector<QicsRegion> regions = myBatchRegions.regions();
+    myBatchRegions.clear();
+
+    for (int i = 0; i < regions.size(); ++i) {
+        emit modelChanged(regions.at(i));
+        emit cellValuesChanged(regions.at(i));
+    }
+}
+
+void QicsDataModel::reportCellChanged(int row, int col)
+{
+    if (!m_emitSignals)
+        return;
+
+    if (myBatchDepth > 0) {
+        myBatchRegions.add(QicsRegion(row, col, row, col));
+        return;
+    }
+
+    emit modelChanged(QicsRegion(row, col, row, col));
+    emit cellValueChanged(row, col);
+}
+
+void QicsDataModel::reportRegionChanged(const QicsRegion &reg)
+{
+    if (!m_emitSignals)
+        return;
+
+    // an invalid region asks for a full repaint, which is never merged
+    if (myBatchDepth > 0 && reg.isValid())
+        myBatchRegions.add(reg);
+    else
+        emit modelChanged(reg);
+}
+
+void QicsDataModel::reportSizeChanged(int position, int num, Qics::QicsIndexType type)
+{
+    if (!m_emitSignals)
+        return;
+
+    if (myBatchDepth > 0)
+        myBatchSizeChanged = true;
+    else
+        emit modelSizeChanged(position, num, type);
+}
+
+void QicsDataModel::reportSizeChanged()
+{
+    if (!m_emitSignals)
+        return;
+
+    if (myBatchDepth > 0)
+        myBatchSizeChanged = true;
+    else
+        emit modelSizeChanged(numRows(), numColumns());
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
@@ -227,8 +313,7 @@ void QicsDataModel::readASCII(QTextStream &stream, const char separator,
 
     m_emitSignals = old_emit;
 
-    if (m_emitSignals)
-        emit modelSizeChanged(numRows(), numColumns());
+    reportSizeChanged();
 }
 
 void QicsDataModel::writeASCII(QTextStream &stream, const char separator,
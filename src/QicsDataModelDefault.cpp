@@ -45,6 +45,8 @@ void QicsDataModelDefault::clearModel()
     // Go through each Row and delete all items,
     // then delete the Rows themselves.
 
+    flushBatchedChanges();
+
     // only send the signal once
     bool old_emit = m_emitSignals;
     m_emitSignals = false;
@@ -72,7 +74,7 @@ void QicsDataModelDefault::clearModel()
     m_emitSignals = old_emit;
 
     if (m_emitSignals) {
-        emit modelSizeChanged(numRows(), numColumns());
+        reportSizeChanged();
         emit rowsDeleted(num_rows, 0);
         emit columnsDeleted(num_cols, 0);
     }
@@ -87,6 +89,8 @@ void QicsDataModelDefault::insertColumns(int number_of_cols, int starting_positi
     // nothing needs to shift.
     if ((number_of_cols <= 0) || (starting_position <0 )) return;
 
+    flushBatchedChanges();
+
     emit prepareForColumnChanges(number_of_cols, starting_position);
 
     if (starting_position > lastColumn()) {
@@ -122,8 +126,7 @@ void QicsDataModelDefault::insertColumns(int number_of_cols, int starting_positi
 
     emit columnsInserted(number_of_cols, starting_position);
 
-    if (m_emitSignals)
-        emit modelSizeChanged(starting_position, number_of_cols, Qics::ColumnIndex);
+    reportSizeChanged(starting_position, number_of_cols, Qics::ColumnIndex);
 }
 
 void QicsDataModelDefault::insertRows(int number_of_rows, int starting_position)
@@ -138,6 +141,8 @@ void QicsDataModelDefault::insertRows(int number_of_rows, int starting_position)
     // and no one is trying to clobber us with a bad number of rows.
     if (starting_position < 0 || number_of_rows <= 0 ) return;
 
+    flushBatchedChanges();
+
     emit prepareForRowChanges(number_of_rows, starting_position);
 
     // for insertions out of model, just expand the model.
@@ -162,8 +167,7 @@ void QicsDataModelDefault::insertRows(int number_of_rows, int starting_position)
 
     emit rowsInserted(number_of_rows, starting_position);
 
-    if (m_emitSignals)
-        emit modelSizeChanged(starting_position, number_of_rows, Qics::RowIndex);
+    reportSizeChanged(starting_position, number_of_rows, Qics::RowIndex);
 }
 
 void QicsDataModelDefault::addColumns(int cols)
@@ -172,8 +176,7 @@ void QicsDataModelDefault::addColumns(int cols)
 
     emit columnsAdded(cols);
 
-    if (m_emitSignals)
-        emit modelSizeChanged(numRows(), numColumns());
+    reportSizeChanged();
 }
 
 void QicsDataModelDefault::addRows(int rows)
@@ -182,8 +185,7 @@ void QicsDataModelDefault::addRows(int rows)
 
     emit rowsAdded(rows);
 
-    if (m_emitSignals)
-        emit modelSizeChanged(numRows(), numColumns());
+    reportSizeChanged();
 }
 
 const QicsDataItem *QicsDataModelDefault::item(int row, int col) const
@@ -282,10 +284,7 @@ void QicsDataModelDefault::setItem(int row, int col, const QicsDataItem &it)
 
     the_row_vec->replace(col, it.clone());
 
-    if (m_emitSignals) {
-        emit modelChanged(QicsRegion(row,col,row,col));
-        emit cellValueChanged( row, col );
-    }
+    reportCellChanged(row, col);
 }
 
 void QicsDataModelDefault::clearItem (int row, int col)
@@ -301,8 +300,7 @@ void QicsDataModelDefault::clearItem (int row, int col)
     delete item;
     the_row_vec->replace(col, 0);
 
-    if (m_emitSignals)
-        emit modelChanged(QicsRegion(row,col));
+    reportRegionChanged(QicsRegion(row,col));
 }
 
 void QicsDataModelDefault::deleteRows(int num_rows, int start_row)
@@ -310,6 +308,8 @@ void QicsDataModelDefault::deleteRows(int num_rows, int start_row)
     if ((start_row < 0) || (num_rows <= 0))
         return;
 
+    flushBatchedChanges();
+
     emit prepareForRowChanges(0-num_rows, start_row);
 
     bool oldSignalFlag = m_emitSignals;
@@ -341,8 +341,7 @@ void QicsDataModelDefault::deleteRows(int num_rows, int start_row)
     if (rows_deleted > 0) {
         emit rowsDeleted(rows_deleted, start_row);
 
-        if (m_emitSignals)
-            emit modelSizeChanged(start_row, 0 - num_rows, Qics::RowIndex);
+        reportSizeChanged(start_row, 0 - num_rows, Qics::RowIndex);
     }
 }
 
@@ -351,6 +350,8 @@ void QicsDataModelDefault::deleteColumns(int num_cols, int start_col)
     if ((start_col < 0) || (num_cols <= 0))
         return;
 
+    flushBatchedChanges();
+
     emit prepareForColumnChanges(0-num_cols, start_col);
 
     int cols_deleted = 0;
@@ -380,8 +381,7 @@ void QicsDataModelDefault::deleteColumns(int num_cols, int start_col)
     if (cols_deleted > 0) {
         emit columnsDeleted(cols_deleted, start_col);
 
-        if (m_emitSignals)
-            emit modelSizeChanged(start_col, 0-num_cols, Qics::ColumnIndex);
+        reportSizeChanged(start_col, 0-num_cols, Qics::ColumnIndex);
     }
 }
 
@@ -420,8 +420,7 @@ void QicsDataModelDefault::setColumnItems(int col, const QicsDataModelColumn &in
 
     m_emitSignals = old_emit;
 
-    if (m_emitSignals)
-        emit modelChanged(QicsRegion(0, col, lastRow(), col));
+    reportRegionChanged(QicsRegion(0, col, lastRow(), col));
 }
 
 // this function has
@@ -467,8 +466,7 @@ void QicsDataModelDefault::setRowItems(int row, const QicsDataModelRow &in_vecto
 
     }
 
-    if (m_emitSignals)
-        emit modelChanged(QicsRegion(row,0,row,lastColumn()));
+    reportRegionChanged(QicsRegion(row,0,row,lastColumn()));
 }
 
 void QicsDataModelDefault::clearRow(int row)
@@ -480,8 +478,7 @@ void QicsDataModelDefault::clearRow(int row)
     qDeleteAll(*the_row_vec);
     the_row_vec->clear();
 
-    if (m_emitSignals)
-        emit modelChanged(QicsRegion(row,0,row,lastColumn()));
+    reportRegionChanged(QicsRegion(row,0,row,lastColumn()));
 }
 
 bool QicsDataModelDefault::isCellEmpty(int row, int col) const
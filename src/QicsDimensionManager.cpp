@@ -562,7 +562,8 @@ void QicsDimensionManager::QicsDefaultDimensionSetting::configureFromDomXml(cons
 QicsDimensionManager::QicsDimensionManager(QicsGridInfo *grid_info, QObject *parent)
     : QObject(parent), myRowDM(0), myColumnDM(0), myGridInfo(grid_info),
         myLastStretchedRow(-1), myLastStretchedColumn(-1),
-        myCellWidthMode(NoChange), myEmitSignalsFlag(true)
+        myCellWidthMode(NoChange), myEmitSignalsFlag(true),
+        myRowRevision(0), myColumnRevision(0)
 {
     myOrigDefaultDimensions.cell_margin =  * static_cast<int *>
         (styleManager()->getDefaultProperty(QicsCellStyle::CellMargin));
@@ -592,7 +593,8 @@ QicsDimensionManager::QicsDimensionManager(QicsGridInfo *grid_info, QObject *par
 QicsDimensionManager::QicsDimensionManager(const QicsDimensionManager &dm, QicsGridInfo *grid_info, QObject *parent)
     : QObject(parent), myRowDM(0), myColumnDM(0), myGridInfo(grid_info),
         myLastStretchedRow(-1), myLastStretchedColumn(-1),
-        myCellWidthMode(NoChange), myEmitSignalsFlag(true)
+        myCellWidthMode(NoChange), myEmitSignalsFlag(true),
+        myRowRevision(0), myColumnRevision(0)
 {
     myOrigDefaultDimensions = dm.myOrigDefaultDimensions;
     myCurrentDefaultDimensions = dm.myCurrentDefaultDimensions;
@@ -3688,15 +3690,15 @@ void QicsDimensionManager::hideRow(int row)
     }
 
     // first make sure it's not already there
-    if (myHiddenRows.contains(row))
+    if (!myHiddenRows.insert(row))
         return;
 
-    myHiddenRows.insert(row);
-
     if (myEmitSignalsFlag) {
         emit rowVisibilityChanged(row, false);
         emit dimensionChanged(Qics::RowIndex, row, row);
     }
+    else
+        ++myRowRevision;
 }
 
 bool QicsDimensionManager::hasHiddenRows() const
@@ -3712,15 +3714,15 @@ void QicsDimensionManager::hideColumn(int col)
     }
 
     // first make sure it's not already there
-    if (myHiddenColumns.contains(col))
+    if (!myHiddenColumns.insert(col))
         return;
 
-    myHiddenColumns.insert(col);
-
     if (myEmitSignalsFlag) {
         emit columnVisibilityChanged(col, false);
         emit dimensionChanged(Qics::ColumnIndex, col, col);
     }
+    else
+        ++myColumnRevision;
 }
 
 bool QicsDimensionManager::hasHiddenColumns() const
@@ -3735,10 +3737,15 @@ void QicsDimensionManager::showRow(int row)
         return;
     }
 
-    if (myHiddenRows.remove(row) && myEmitSignalsFlag) {
+    if (!myHiddenRows.remove(row))
+        return;
+
+    if (myEmitSignalsFlag) {
         emit rowVisibilityChanged(row, true);
         emit dimensionChanged(Qics::RowIndex, row, row);
     }
+    else
+        ++myRowRevision;
 }
 
 void QicsDimensionManager::showColumn(int col)
@@ -3748,10 +3755,15 @@ void QicsDimensionManager::showColumn(int col)
         return;
     }
 
-    if (myHiddenColumns.remove(col) && myEmitSignalsFlag) {
+    if (!myHiddenColumns.remove(col))
+        return;
+
+    if (myEmitSignalsFlag) {
         emit columnVisibilityChanged(col, true);
         emit dimensionChanged(Qics::ColumnIndex, col, col);
     }
+    else
+        ++myColumnRevision;
 }
 
 bool QicsDimensionManager::isRowHidden(int row) const
@@ -3765,6 +3777,48 @@ bool QicsDimensionManager::isRowHidden(int row) const
     return myHiddenRows.contains(row);
 }
 
+int QicsDimensionManager::nextVisibleRow(int row) const
+{
+    if (myRowDM)
+        return (myRowDM->nextVisibleRow(row));
+
+    return myHiddenRows.nextAbsent(row);
+}
+
+int QicsDimensionManager::previousVisibleRow(int row) const
+{
+    if (myRowDM)
+        return (myRowDM->previousVisibleRow(row));
+
+    return myHiddenRows.previousAbsent(row);
+}
+
+int QicsDimensionManager::nextVisibleColumn(int col) const
+{
+    if (myColumnDM)
+        return (myColumnDM->nextVisibleColumn(col));
+
+    return myHiddenColumns.nextAbsent(col);
+}
+
+int QicsDimensionManager::previousVisibleColumn(int col) const
+{
+    if (myColumnDM)
+        return (myColumnDM->previousVisibleColumn(col));
+
+    return myHiddenColumns.previousAbsent(col);
+}
+
+uint QicsDimensionManager::rowRevision() const
+{
+    return myRowRevision + (myRowDM ? myRowDM->rowRevision() : 0);
+}
+
+uint QicsDimensionManager::columnRevision() const
+{
+    return myColumnRevision + (myColumnDM ? myColumnDM->columnRevision() : 0);
+}
+
 bool QicsDimensionManager::isRowFiltered(int row) const
 {
     if (myRowDM)
@@ -3803,6 +3857,8 @@ void QicsDimensionManager::insertRows(int num, int start_position)
     if ((start_position < 0) || (num <= 0))
         return;
 
+    ++myRowRevision;
+
     // First, we do the row heights
 
     if (start_position < myRowHeights.size()) {
@@ -3824,15 +3880,7 @@ void QicsDimensionManager::insertRows(int num, int start_position)
     }
 
     // Then Hide setings
-    QList<int> list = myHiddenRows.toList();
-    qSort(list.begin(), list.end());    // we MUST sort the list - as QSet is unsorted internally
-    QList<int>::iterator iter, iter_end(list.end());
-
-    for (iter = list.begin(); iter != iter_end; ++iter) {
-        if ( *iter >= start_position )
-            *iter += num;
-    }
-    myHiddenRows = list.toSet();
+    myHiddenRows.insertSpace(start_position, num);
 
     // Next, any row settings
     QicsRowSettingV::iterator iter_rs, iter_rs_end(mySetRows.end());
@@ -3889,6 +3937,8 @@ void QicsDimensionManager::insertColumns(int num, int start_position)
     if ((start_position < 0) || (num <= 0))
         return;
 
+    ++myColumnRevision;
+
     // First, we do the column widths
 
     if (start_position < myColumnWidths.size()) {
@@ -3917,16 +3967,7 @@ void QicsDimensionManager::insertColumns(int num, int start_position)
     }
 
     // Then Hide setings
-    QList<int> list = myHiddenColumns.toList();
-    qSort(list.begin(), list.end());    // we MUST sort the list - as QSet is unsorted internally
-    QList<int>::iterator iter, iter_end(list.end());
-
-    for (iter = list.begin(); iter != iter_end; ++iter) {
-        if ( *iter >= start_position )
-            *iter += num;
-    }
-
-    myHiddenColumns = list.toSet();
+    myHiddenColumns.insertSpace(start_position, num);
 
     // Finally, any cell settings
     QicsCellSettingV::iterator iter_cell, iter_cell_end(mySetCells.end());
@@ -3969,6 +4010,8 @@ void QicsDimensionManager::deleteRows(int num, int start_position)
     if ((start_position < 0) || (num <= 0))
         return;
 
+    ++myRowRevision;
+
     // First, we do the row heights
 
     if (start_position < myRowHeights.size()) {
@@ -4022,20 +4065,7 @@ void QicsDimensionManager::deleteRows(int num, int start_position)
     }
 
     // Then Hide setings
-    QSet<int> tempSet(myHiddenRows);
-    myHiddenRows.clear();
-
-    for (QSet<int>::const_iterator iter = tempSet.constBegin(); iter != tempSet.constEnd(); ++iter) {
-        if (*iter < start_position) {
-            myHiddenRows.insert(*iter);
-            continue;
-        }
-
-        if (*iter >= start_position+num) {
-            myHiddenRows.insert(*iter - num);
-            continue;
-        }
-    }
+    myHiddenRows.removeSpace(start_position, num);
 
     // Next, any row settings
     {
@@ -4122,6 +4152,8 @@ void QicsDimensionManager::deleteColumns(int num, int start_position)
     if ((start_position < 0) || (num <= 0))
         return;
 
+    ++myColumnRevision;
+
     // First, we do the column widths
 
     if (start_position < myColumnWidths.size()) {
@@ -4187,21 +4219,7 @@ void QicsDimensionManager::deleteColumns(int num, int start_position)
     }
 
     // Then Hide setings
-    QSet<int> tempSet(myHiddenColumns);
-    myHiddenColumns.clear();
-    QSet<int>::const_iterator iter, iter_end(tempSet.constEnd());
-
-    for (iter = tempSet.constBegin(); iter != iter_end; ++iter) {
-        if (*iter < start_position) {
-            myHiddenColumns.insert(*iter);
-            continue;
-        }
-
-        if (*iter >= start_position+num) {
-            myHiddenColumns.insert(*iter - num);
-            continue;
-        }
-    }
+    myHiddenColumns.removeSpace(start_position, num);
 
     // Finally, any cell settings
     {
@@ -4258,7 +4276,7 @@ QDomElement QicsDimensionManager::toDomXml(QDomDocument* doc)
     QStringList hiddenRowList;
 
     int row;
-    foreach(row, myHiddenRows)
+    foreach(row, myHiddenRows.toList())
         hiddenRowList << QString::number(row);
 
     attrValue = hiddenRowList.join(",");
@@ -4268,7 +4286,7 @@ QDomElement QicsDimensionManager::toDomXml(QDomDocument* doc)
     QStringList hiddenColumnList;
     int col;
 
-    foreach(col, myHiddenColumns)
+    foreach(col, myHiddenColumns.toList())
         hiddenColumnList << QString::number(col);
 
     attrValue = hiddenColumnList.join(",");
@@ -4685,6 +4703,8 @@ void QicsDimensionManager::configureFromDomXml(const QDomElement& e)
 
     loadMyHiddenRowsFromDomXml(e);
     loadMyHiddenColumnsFromDomXml(e);
+    ++myRowRevision;
+    ++myColumnRevision;
 
     myLastStretchedRow = e.attribute("lastStretchedRow").toInt();
     myLastStretchedColumn = e.attribute("lastStretchedColumn").toInt();
@@ -4937,7 +4957,7 @@ void QicsDimensionManager::loadMyHiddenRowsFromDomXml(const QDomElement& e)
         return;
 
     foreach(row, hrList)
-        myHiddenRows << row.toInt();
+        myHiddenRows.insert(row.toInt());
 }
 
 void QicsDimensionManager::loadMyHiddenColumnsFromDomXml(const QDomElement& e)
@@ -4950,7 +4970,7 @@ void QicsDimensionManager::loadMyHiddenColumnsFromDomXml(const QDomElement& e)
         return;
 
     foreach(col, hcList)
-        myHiddenColumns << col.toInt();
+        myHiddenColumns.insert(col.toInt());
 }
 
 void QicsDimensionManager::loadMySetVisualCellsFromDomXml(const QDomElement& e)
@@ -0,0 +1,115 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#include "QicsDirtyRegionSet.h"
+
+
+// number of cells in a region, without overflowing for entire rows
+// or columns
+static inline qint64 cellCount(const QicsRegion &reg)
+{
+    return (qint64(reg.endRow()) - reg.startRow() + 1) *
+        (qint64(reg.endColumn()) - reg.startColumn() + 1);
+}
+
+static inline QicsRegion bounding(const QicsRegion &a, const QicsRegion &b)
+{
+    return QicsRegion(qMin(a.startRow(), b.startRow()), qMin(a.startColumn(), b.startColumn()),
+        qMax(a.endRow(), b.endRow()), qMax(a.endColumn(), b.endColumn()));
+}
+
+static inline bool overlaps(const QicsRegion &a, const QicsRegion &b)
+{
+    return (a.startRow() <= b.endRow() && b.startRow() <= a.endRow() &&
+        a.startColumn() <= b.endColumn() && b.startColumn() <= a.endColumn());
+}
+
+// number of cells the bounding region of two disjoint regions adds
+static inline qint64 mergeCost(const QicsRegion &a, const QicsRegion &b)
+{
+    return cellCount(bounding(a, b)) - cellCount(a) - cellCount(b);
+}
+
+
+QicsDirtyRegionSet::QicsDirtyRegionSet(int max_regions)
+    : myMaxRegions(qMax(max_regions, 1))
+{
+}
+
+void QicsDirtyRegionSet::clear()
+{
+    myRegions.clear();
+}
+
+void QicsDirtyRegionSet::add(const QicsRegion &reg)
+{
+    if (!reg.isValid())
+        return;
+
+    merge(reg);
+
+    while (myRegions.size() > myMaxRegions) {
+        // merge the pair which wastes the fewest cells
+        int best_i = 0, best_j = 1;
+        qint64 best_cost = mergeCost(myRegions.at(0), myRegions.at(1));
+
+        for (int i = 0; i < myRegions.size(); ++i)
+            for (int j = i + 1; j < myRegions.size(); ++j) {
+                const qint64 cost = mergeCost(myRegions.at(i), myRegions.at(j));
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_i = i;
+                    best_j = j;
+                }
+            }
+
+        const QicsRegion merged = bounding(myRegions.at(best_i), myRegions.at(best_j));
+        myRegions.remove(best_j);
+        myRegions.remove(best_i);
+        merge(merged);
+    }
+}
+
+QicsRegion QicsDirtyRegionSet::boundingRegion() const
+{
+    if (myRegions.isEmpty())
+        return QicsRegion();
+
+    QicsRegion reg = myRegions.at(0);
+    for (int i = 1; i < myRegions.size(); ++i)
+        reg = bounding(reg, myRegions.at(i));
+
+    return reg;
+}
+
+void QicsDirtyRegionSet::merge(QicsRegion reg)
+{
+    // A merged region may overlap regions it did not overlap before,
+    // so keep merging until nothing changes.
+    bool merged = true;
+    while (merged) {
+        merged = false;
+
+        for (int i = 0; i < myRegions.size(); ++i) {
+            const QicsRegion &r = myRegions.at(i);
+
+            if (overlaps(r, reg) || mergeCost(r, reg) <= 0) {
+                reg = bounding(r, reg);
+                myRegions.remove(i);
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    myRegions.append(reg);
+}
@@ -13,6 +13,7 @@
 #include "QicsGrid.h"
 
 #include <qdrawutil.h>
+#include <QSet>
 
 #include "QicsCell.h"
 #include "QicsRow.h"
@@ -26,6 +27,13 @@
 #include "QicsUtil.h"
 
 
+// key of a cell in the sets of cells used by drawRegion()
+static inline quint64 cellKey(int row, int col)
+{
+    return ((quint64(quint32(row)) << 32) | quint32(col));
+}
+
+
 QicsGrid::QicsGrid(QicsGridInfo &info, int top_row, int left_column)
     : m_info(info),
         m_topRow(top_row),
@@ -170,12 +178,15 @@ QicsICell QicsGrid::computeCellPositions(const QRect &bounds,
             if (!m_row->isHidden()) {
                 myRowPositions.push_back(current_y);
                 current_y += (mappedDimension->rowHeight(this_row) + hlw);
+                ++this_row;
             }
             else {
-                // not shown, therefore a bogus row position to hold the spot
-                myRowPositions.push_back(-1);
+                // not shown, therefore skip the whole run of hidden rows
+                // and hold their spots
+                const int next_row = hiddenRunEnd(Qics::RowIndex, this_row, real_vp.endRow());
+                myRowPositions.skip(next_row - this_row);
+                this_row = next_row;
             }
-            ++this_row;
         }
         // set bottom visible and bottom fully visible row
         bottom_row = this_row - 1;
@@ -207,12 +218,15 @@ QicsICell QicsGrid::computeCellPositions(const QRect &bounds,
                     myColumnPositions.push_back(current_x);
                     lastColX = current_x;
                     current_x -= (mappedDimension->columnWidth(this_col+1) + vlw);
+                    ++this_col;
                 }
                 else {
-                    // not shown, therefore a bogus column position to hold the spot
-                    myColumnPositions.push_back(-1);
+                    // not shown, therefore skip the whole run of hidden columns
+                    // and hold their spots
+                    const int next_col = hiddenRunEnd(Qics::ColumnIndex, this_col, real_vp.endColumn());
+                    myColumnPositions.skip(next_col - this_col);
+                    this_col = next_col;
                 }
-                ++this_col;
             }
             // set right visible and right fully visible column
             right_column = this_col-1;
@@ -234,13 +248,15 @@ QicsICell QicsGrid::computeCellPositions(const QRect &bounds,
                 if (!m_column->isHidden()) {
                     myColumnPositions.push_back(current_x);
                     current_x += (mappedDimension->columnWidth(this_col) + vlw);
+                    ++this_col;
                 }
                 else {
-                    // not shown, therefore a bogus column position to hold the spot
-                    myColumnPositions.push_back(-1);
+                    // not shown, therefore skip the whole run of hidden columns
+                    // and hold their spots
+                    const int next_col = hiddenRunEnd(Qics::ColumnIndex, this_col, real_vp.endColumn());
+                    myColumnPositions.skip(next_col - this_col);
+                    this_col = next_col;
                 }
-
-                ++this_col;
             }
             // set right visible and right fully visible column
             right_column = this_col - 1;
@@ -253,6 +269,22 @@ QicsICell QicsGrid::computeCellPositions(const QRect &bounds,
     return (QicsICell(bottom_row, right_column));
 }
 
+int QicsGrid::hiddenRunEnd(Qics::QicsIndexType type, int index, int last) const
+{
+    const int next = (type == Qics::RowIndex) ?
+        mappedDM().nextVisibleRow(index) : mappedDM().nextVisibleColumn(index);
+
+    if (next >= 0 && next <= index)
+        return index + 1;
+
+    // the run is cut at the end of the viewport, beyond which
+    // we step one at a time as before
+    if (next < 0 || next > last + 1)
+        return qMax(last + 1, index + 1);
+
+    return next;
+}
+
 QRect QicsGrid::cellDimensions(int row, int col, bool with_spans) const
 {
     QRect retval;
@@ -365,13 +397,14 @@ QRect QicsGrid::drawRegion(const QicsRegion &region, QPainter *painter, QicsGrid
     int vlw = m_mainGrid->verticalGridLineWidth() + m_mainGrid->verticalShadeLineWidth();
     int hlw = m_mainGrid->horizontalGridLineWidth() + m_mainGrid->horizontalShadeLineWidth();
 
-    // first, put all the drawable cells to the map
-    QList<QicsICell> myCells, myOffSpans;
+    // first, put all the drawable cells to the map.  myCells keeps the
+    // drawing order, myPending the cells that still have to be drawn.
+    QVector<QicsICell> myCells;
+    QSet<quint64> myPending, myOffSpans;
 
-    for (i = region.startRow(); i <= region.endRow(); ++i) {
+    for (i = m_info.firstNonHiddenRow(region.startRow(), region.endRow()); i >= 0;
+        i = m_info.firstNonHiddenRow(i + 1, region.endRow())) {
         m_row->setRowIndex(i);
-        if (m_row->isHidden())
-            continue;
 
         // handle special row displayers
         QicsCellDisplay *rcd = m_row->displayer();
@@ -394,26 +427,26 @@ QRect QicsGrid::drawRegion(const QicsRegion &region, QPainter *painter, QicsGrid
             continue;
         }
 
-        for (j = region.startColumn(); j <= region.endColumn(); ++j) {
+        for (j = m_info.firstNonHiddenColumn(region.startColumn(), region.endColumn()); j >= 0;
+            j = m_info.firstNonHiddenColumn(j + 1, region.endColumn())) {
             m_column->setColumnIndex(j);
-            if (m_column->isHidden())
-                continue;
 
             myCells.append(QicsICell(i,j));
+            myPending.insert(cellKey(i, j));
         }
     }
 
-    // ok, then we should handle all the spans
-    //QicsSpanList *spans = styleManager().spanManager()->visualCellSpanList(myInfo);
-    QicsSpanList *spans = styleManager().spanManager()->cellSpanList();
-    if (!spans->isEmpty()) {
-        for (i = 0; i < spans->count(); ++i) {
-            const QicsSpan &span = spans->at(i);
-            QicsRegion span_region;
-            span_region.setStartRow(m_info.visualRowIndex(m_info.firstNonHiddenModelRow(span.row(), span.row() + span.height() - 1)));
-            span_region.setStartColumn(m_info.visualColumnIndex(m_info.firstNonHiddenModelColumn(span.column(), span.column() + span.width() - 1)));
-            span_region.setEndRow(span_region.startRow() + span.height() -1);
-            span_region.setEndColumn(span_region.startColumn() + span.width() -1);
+    // ok, then we should handle all the spans on the screen, and the
+    // ones left of it that overflowing cells may run into
+    QicsRegion span_vp(screen_vp);
+    if (over == Qics::Overflow)
+        span_vp.setStartColumn(screen_vp.startColumn() - max_over);
+
+    QVector<QicsRegion> spans;
+    styleManager().spanManager()->visualSpansIntersecting(m_info, span_vp, spans);
+    if (!spans.isEmpty()) {
+        for (i = 0; i < spans.count(); ++i) {
+            const QicsRegion &span_region = spans.at(i);
 
             QicsRegion reg(screen_vp);
             reg &= span_region;
@@ -426,12 +459,13 @@ QRect QicsGrid::drawRegion(const QicsRegion &region, QPainter *painter, QicsGrid
                 if (screen_vp.startColumn() - span_region.endColumn() > max_over) continue; // it is too left
                 // add cells to off-span list
                 for (int r = span_region.startRow(); r <= span_region.endRow(); ++r)
-                    myOffSpans.append(QicsICell(r,span_region.endColumn()));
+                    myOffSpans.insert(cellKey(r, span_region.endColumn()));
+                continue;
             }
 
             for (int rr = reg.startRow(); rr <= reg.endRow(); ++rr)
                 for (int c = reg.startColumn(); c <= reg.endColumn(); ++c)
-                    myCells.removeAll(QicsICell(rr,c));
+                    myPending.remove(cellKey(rr, c));
 
             row = m_info.firstNonHiddenRow( reg.startRow(), reg.endRow() );
             if (m_mainGrid->layoutDirection() == Qt::LeftToRight)
@@ -441,10 +475,8 @@ QRect QicsGrid::drawRegion(const QicsRegion &region, QPainter *painter, QicsGrid
 
             y = myRowPositions[row];
             x = myColumnPositions[col];
-            //int spanner_row = span.row();
-            //int spanner_col = span.column();
-            int spanner_row = m_info.visualRowIndex(m_info.firstNonHiddenModelRow(span.row(), span.row() + span.height() - 1));
-            int spanner_col = m_info.visualColumnIndex(m_info.firstNonHiddenModelColumn(span.column(), span.column() + span.width() - 1));
+            int spanner_row = span_region.startRow();
+            int spanner_col = span_region.startColumn();
 
             // We need to (partially) draw the spanned cell.  We begin
             // by constructing a region that we can use to determine how
@@ -479,18 +511,16 @@ QRect QicsGrid::drawRegion(const QicsRegion &region, QPainter *painter, QicsGrid
                 painted_rect |= drawCell(row, col, rect, painter, mode);
         }
     }
-    delete spans;
 
     // and, if overflow is on, we must check all the leftmost cells
     col = region.startColumn();
     if (over == Qics::Overflow && col) {
-        for (i = region.startRow(); i <= region.endRow(); ++i) {
+        for (i = m_info.firstNonHiddenRow(region.startRow(), region.endRow()); i >= 0;
+            i = m_info.firstNonHiddenRow(i + 1, region.endRow())) {
             m_row->setRowIndex(i);
-            if (m_row->isHidden())
-                continue;
 
             // check if col is empty or drawn as a span already
-            if (!myCells.contains(QicsICell(i, col)) )
+            if (!myPending.contains(cellKey(i, col)))
                 continue;
 
             QicsCellDisplay *cd = cellDisplay(i, col);
@@ -502,8 +532,7 @@ QRect QicsGrid::drawRegion(const QicsRegion &region, QPainter *painter, QicsGrid
             while (prev_col >= 0 && (col-prev_col) < max_over) {
                 m_column->setColumnIndex(prev_col);
                 if (!m_column->isHidden()) {
-                    QicsICell cell(i, prev_col);
-                    if (myOffSpans.contains(cell))
+                    if (myOffSpans.contains(cellKey(i, prev_col)))
                         break;
 
                     QicsCellDisplay *cd = cellDisplay(i, prev_col);
@@ -527,18 +556,18 @@ QRect QicsGrid::drawRegion(const QicsRegion &region, QPainter *painter, QicsGrid
                                 && next_col <= screen_vp.endColumn()
                                 && (next_col-prev_col) < max_over ) {
 
-                                    QicsICell next_cell(i, next_col);
+                                    const quint64 next_cell = cellKey(i, next_col);
                                     m_column->setColumnIndex(next_col);
 
                                     if (!m_column->isHidden()) {
-                                        if (!myCells.contains(next_cell)) break;
+                                        if (!myPending.contains(next_cell)) break;
                                         //if (next_cell == cur_cell) break;
 
                                         cd = cellDisplay(i, next_col);
                                         if (cd && !(cd->isEmpty(&m_info, i, next_col, cellValue(i, next_col)))) break;
 
                                         rect.setWidth(rect.width() + mappedDimension->columnWidth(next_col) + vlw);
-                                        myCells.removeAll(next_cell);
+                                        myPending.remove(next_cell);
                                     }
 
                                     ++next_col;
@@ -557,8 +586,10 @@ QRect QicsGrid::drawRegion(const QicsRegion &region, QPainter *painter, QicsGrid
     }
 
     // now, draw all the unspanned cells
-    while (!myCells.isEmpty()) {
-        const QicsICell &cell = myCells.first();
+    for (i = 0; i < myCells.size(); ++i) {
+        const QicsICell &cell = myCells.at(i);
+        if (!myPending.contains(cellKey(cell.row(), cell.column())))
+            continue;
 
         y = myRowPositions.at(row = cell.row());
         x = myColumnPositions.at(col = cell.column());
@@ -580,18 +611,18 @@ QRect QicsGrid::drawRegion(const QicsRegion &region, QPainter *painter, QicsGrid
                     && next_col <= screen_vp.endColumn()
                     && (next_col-col) < max_over ) {
 
-                        QicsICell next_cell(row, next_col);
+                        const quint64 next_cell = cellKey(row, next_col);
                         m_column->setColumnIndex(next_col);
 
                         if (!m_column->isHidden()) {
-                            if (!myCells.contains(next_cell)) break;
+                            if (!myPending.contains(next_cell)) break;
                             //if (next_cell == cur_cell) break;
 
                             cd = cellDisplay(row, next_col);
                             if (cd && !(cd->isEmpty(&m_info, row, next_col, cellValue(row, next_col)))) break;
 
                             rect.setWidth(rect.width() + mappedDimension->columnWidth(next_col) + vlw);
-                            myCells.removeAll(next_cell);
+                            myPending.remove(next_cell);
                         }
 
                         ++next_col;
@@ -601,8 +632,6 @@ QRect QicsGrid::drawRegion(const QicsRegion &region, QPainter *painter, QicsGrid
 
         // draw
         painted_rect |= drawCell(row, col, rect, painter, mode);
-
-        myCells.takeFirst();
     }
 
     return painted_rect;
@@ -661,10 +690,9 @@ void QicsGrid::drawGridLines(const QicsRegion &region, QPainter *painter)
         if (do_horiz && ((hls == Qics::Sunken) || (hls == Qics::Raised))) {
             int last_vis_row = -1;
             const QPalette &pal = m_mainGrid->palette();
-            for (i = start_row; i <= end_row; ++i) {
+            for (i = m_info.firstNonHiddenRow(start_row, end_row); i >= 0;
+                i = m_info.firstNonHiddenRow(i + 1, end_row)) {
                 m_row->setRowIndex(i);
-                if (m_row->isHidden())
-                    continue;
 
                 p1.setY(myRowPositions.at(i) - hlbo);
                 p2.setY(myRowPositions.at(i) - hlbo);
@@ -724,10 +752,9 @@ void QicsGrid::drawGridLines(const QicsRegion &region, QPainter *painter)
 
             if (!skip_lines) {
                 int last_vis_row = -1;
-                for (i = start_row; i <= end_row; ++i) {
+                for (i = m_info.firstNonHiddenRow(start_row, end_row); i >= 0;
+                    i = m_info.firstNonHiddenRow(i + 1, end_row)) {
                     m_row->setRowIndex(i);
-                    if (m_row->isHidden())
-                        continue;
 
                     p1.setY(myRowPositions.at(i) - hlbo);
                     p2.setY(myRowPositions.at(i) - hlbo);
@@ -775,10 +802,9 @@ void QicsGrid::drawGridLines(const QicsRegion &region, QPainter *painter)
         if (do_vert && ((vls == Qics::Sunken) || (vls == Qics::Raised))) {
             int last_vis_col = -1;
             const QPalette &pal = m_mainGrid->palette();
-            for (j = start_col; j <= end_col; ++j) {
+            for (j = m_info.firstNonHiddenColumn(start_col, end_col); j >= 0;
+                j = m_info.firstNonHiddenColumn(j + 1, end_col)) {
                 m_column->setColumnIndex(j);
-                if (m_column->isHidden())
-                    continue;
 
                 p1.setX(myColumnPositions.at(j) - vlro);
                 p1.setY(myRowPositions.at(start_row) - hlbo);
@@ -841,10 +867,9 @@ void QicsGrid::drawGridLines(const QicsRegion &region, QPainter *painter)
             if (!skip_lines) {
                 int last_vis_col = -1;
 
-                for (j = start_col; j <= end_col; ++j) {
+                for (j = m_info.firstNonHiddenColumn(start_col, end_col); j >= 0;
+                    j = m_info.firstNonHiddenColumn(j + 1, end_col)) {
                     m_column->setColumnIndex(j);
-                    if (m_column->isHidden())
-                        continue;
 
                     p1.setX(myColumnPositions.at(j) - vlro);
                     p1.setY(myRowPositions.at(start_row) - hlbo);
@@ -89,6 +89,8 @@ void QicsGridCommon::initSignals()
             this, SLOT(disconnectGrid(QicsScreenGrid *)));
         connect(m_info, SIGNAL(cellValueChanged(int, int)),
             this, SIGNAL(valueChanged(int, int)));
+        connect(m_info, SIGNAL(cellValuesChanged(const QicsRegion &)),
+            this, SIGNAL(valuesChanged(const QicsRegion &)));
     }
 }
 
@@ -13,6 +13,7 @@
 #include "QicsGridInfo.h"
 
 #include <QFileInfo>
+#include <QTimer>
 
 #include "QicsStyleManager.h"
 #include "QicsSelectionManager.h"
@@ -35,7 +36,11 @@ QicsGridInfo::QicsGridInfo(Qics::QicsGridType type, QObject *parent)
         myBlockSelectionSignals(false),
         m_copyPolicy(Qics::CopyAll),
         myClearPolicy(Qics::ClearAll),
-        myHeaderDragStyle(Qics::SimpleDrag)
+        myHeaderDragStyle(Qics::SimpleDrag),
+        myRefreshInterval(0),
+        myRefreshTimer(0),
+        myPendingChanges(32),
+        myPendingFullRedraw(false)
 {
     m_dataModel = 0;
     myStyleMananager = 0;
@@ -106,18 +111,34 @@ void QicsGridInfo::setDataModel(QicsDataModel *dt)
     m_rowOrdering = new QicsSorter(Qics::RowIndex, m_dataModel);
     m_rowOrdering->setDefaultSorterDelegate(m_defaultSorterDelegate);
     m_rowOrderOwner = this;
+    connect(m_rowOrdering, SIGNAL(sortProgress(Qics::QicsIndexType, int)),
+        this, SIGNAL(orderingProgress(Qics::QicsIndexType, int)));
+    connect(m_rowOrdering, SIGNAL(sortFinished(Qics::QicsIndexType, bool)),
+        this, SLOT(handleOrderingFinished(Qics::QicsIndexType, bool)));
+    connect(m_rowOrdering, SIGNAL(itemMoved(Qics::QicsIndexType, int, int)),
+        this, SIGNAL(modelReordered(Qics::QicsIndexType)));
+    connect(m_rowOrdering, SIGNAL(elementsRepositioned(Qics::QicsIndexType)),
+        this, SIGNAL(modelReordered(Qics::QicsIndexType)));
 
     delete m_columnOrdering;
     m_columnOrdering = new QicsSorter(Qics::ColumnIndex, m_dataModel);
     m_columnOrdering->setDefaultSorterDelegate(m_defaultSorterDelegate);
     m_columnOrderOwner = this;
+    connect(m_columnOrdering, SIGNAL(sortProgress(Qics::QicsIndexType, int)),
+        this, SIGNAL(orderingProgress(Qics::QicsIndexType, int)));
+    connect(m_columnOrdering, SIGNAL(sortFinished(Qics::QicsIndexType, bool)),
+        this, SLOT(handleOrderingFinished(Qics::QicsIndexType, bool)));
+    connect(m_columnOrdering, SIGNAL(itemMoved(Qics::QicsIndexType, int, int)),
+        this, SIGNAL(modelReordered(Qics::QicsIndexType)));
+    connect(m_columnOrdering, SIGNAL(elementsRepositioned(Qics::QicsIndexType)),
+        this, SIGNAL(modelReordered(Qics::QicsIndexType)));
 
     connectDTtoSM();
     connectDTtoDM();
 
     if (m_dataModel) {
         disconnect(m_dataModel, SIGNAL(modelChanged(const QicsRegion &)),
-            this, SLOT(redrawModel(const QicsRegion &)));
+            this, SLOT(handleModelChanged(const QicsRegion &)));
 
         disconnect(m_dataModel, SIGNAL(cellValueChanged(int, int)),
             this, SIGNAL(cellValueChanged(int, int)));
@@ -125,14 +146,20 @@ void QicsGridInfo::setDataModel(QicsDataModel *dt)
         disconnect(this, SIGNAL(cellValueChanged(int, int)),
             this, SLOT(propagateChangesFromCell(int,int)));
 
+        disconnect(m_dataModel, SIGNAL(cellValuesChanged(const QicsRegion &)),
+            this, SIGNAL(cellValuesChanged(const QicsRegion &)));
+
         connect(m_dataModel, SIGNAL(modelChanged(const QicsRegion &)),
-            this, SLOT(redrawModel(const QicsRegion &)));
+            this, SLOT(handleModelChanged(const QicsRegion &)));
 
         connect(m_dataModel, SIGNAL(cellValueChanged(int, int)),
             this, SIGNAL(cellValueChanged(int, int)));
 
         connect(this, SIGNAL(cellValueChanged(int, int)),
             this, SLOT(propagateChangesFromCell(int,int)));
+
+        connect(m_dataModel, SIGNAL(cellValuesChanged(const QicsRegion &)),
+            this, SIGNAL(cellValuesChanged(const QicsRegion &)));
     }
 
     QicsScreenGridPV::const_iterator iter, iter_end(myGrids.constEnd());
@@ -173,6 +200,7 @@ void QicsGridInfo::setDimensionManager(QicsDimensionManager *dm)
 
     QicsDimensionManager *oldDM = myDimensionManager;
     myDimensionManager = dm;
+    delete myMappedDM;
     myMappedDM = new QicsMappedDimensionManager(dm, this);
 
     if (oldDM) {
@@ -236,13 +264,19 @@ void QicsGridInfo::setSelectionManager(QicsSelectionManager *sel_m)
     for (iter = myGrids.constBegin(); iter != iter_end; ++iter)
         connectSelMtoGrid(*iter);
 
-    if ((m_rowOrderOwner == this) && m_rowOrdering)
+    if ((m_rowOrderOwner == this) && m_rowOrdering) {
         connect(m_rowOrdering, SIGNAL(orderChanged(Qics::QicsIndexType, int*, int)),
             mySelM, SLOT(orderChanged(Qics::QicsIndexType, int*, int)));
+        connect(m_rowOrdering, SIGNAL(itemMoved(Qics::QicsIndexType, int, int)),
+            mySelM, SLOT(itemMoved(Qics::QicsIndexType, int, int)));
+    }
 
-    if ((m_columnOrderOwner == this) && m_columnOrdering)
+    if ((m_columnOrderOwner == this) && m_columnOrdering) {
         connect(m_columnOrdering, SIGNAL(orderChanged(Qics::QicsIndexType, int*, int)),
             mySelM, SLOT(orderChanged(Qics::QicsIndexType, int*, int)));
+        connect(m_columnOrdering, SIGNAL(itemMoved(Qics::QicsIndexType, int, int)),
+            mySelM, SLOT(itemMoved(Qics::QicsIndexType, int, int)));
+    }
 
     emit selectionManagerChanged(oldSelM, mySelM);
 }
@@ -746,6 +780,58 @@ void QicsGridInfo::orderColumnsBy(const QVector<int> &rows, Qics::QicsSortOrder
     emit modelReordered(Qics::ColumnIndex);
 }
 
+void QicsGridInfo::orderRowsByAsync(const QVector<int> &columns, Qics::QicsSortOrder order, int from, int to,
+                                    DataItemComparator func, bool models)
+{
+    if (models)
+        m_rowOrdering->sortAsync(columns, order, from, to, func);
+    else {
+        QVector<int>::const_iterator iter, iter_end(columns.constEnd());
+        QVector<int> mySortedColumns;
+        for (iter = columns.constBegin(); iter<iter_end; ++iter)
+            mySortedColumns << modelColumnIndex(*iter);
+
+        m_rowOrdering->sortAsync(mySortedColumns, order, from, to, func);
+    }
+}
+
+void QicsGridInfo::orderColumnsByAsync(const QVector<int> &rows, Qics::QicsSortOrder order, int from, int to,
+                                       DataItemComparator func, bool models)
+{
+    if (models)
+        m_columnOrdering->sortAsync(rows, order, from, to, func);
+    else {
+        QVector<int>::const_iterator iter, iter_end(rows.constEnd());
+        QVector<int> mySortedRows;
+        for (iter = rows.constBegin(); iter<iter_end; ++iter)
+            mySortedRows << modelRowIndex(*iter);
+
+        m_columnOrdering->sortAsync(mySortedRows, order, from, to, func);
+    }
+}
+
+void QicsGridInfo::cancelOrdering()
+{
+    if (m_rowOrdering)
+        m_rowOrdering->cancelSort();
+    if (m_columnOrdering)
+        m_columnOrdering->cancelSort();
+}
+
+bool QicsGridInfo::isOrdering() const
+{
+    return ((m_rowOrdering && m_rowOrdering->isSorting()) ||
+        (m_columnOrdering && m_columnOrdering->isSorting()));
+}
+
+void QicsGridInfo::handleOrderingFinished(Qics::QicsIndexType type, bool applied)
+{
+    if (applied)
+        emit modelReordered(type);
+
+    emit orderingFinished(type, applied);
+}
+
 void QicsGridInfo::moveRows(int target, const QVector<int> &rows)
 {
     if(this->m_rowOrderOwner == this) {
@@ -875,6 +961,62 @@ void QicsGridInfo::redrawModel(const QicsRegion &r, bool model)
         (*iter)->redraw(rv);
 }
 
+void QicsGridInfo::setRefreshInterval(int msecs)
+{
+    myRefreshInterval = qMax(msecs, 0);
+
+    if (myRefreshInterval == 0) {
+        flushModelChanges();
+        return;
+    }
+
+    if (!myRefreshTimer) {
+        myRefreshTimer = new QTimer(this);
+        myRefreshTimer->setSingleShot(true);
+        connect(myRefreshTimer, SIGNAL(timeout()), this, SLOT(flushModelChanges()));
+    }
+
+    myRefreshTimer->setInterval(myRefreshInterval);
+}
+
+void QicsGridInfo::handleModelChanged(const QicsRegion &r)
+{
+    if (myRefreshInterval == 0) {
+        redrawModel(r);
+        return;
+    }
+
+    // Map the change now, so that it is not lost if it is merged with
+    // others whose rows or columns are sorted differently.
+    const QicsRegion rv = visualRegion(r);
+    if (rv.isValid())
+        myPendingChanges.add(rv);
+    else
+        myPendingFullRedraw = true;
+
+    // the first change of an interval starts it
+    if (!myRefreshTimer->isActive())
+        myRefreshTimer->start();
+}
+
+void QicsGridInfo::flushModelChanges()
+{
+    if (myRefreshTimer)
+        myRefreshTimer->stop();
+
+    if (myPendingFullRedraw) {
+        updateAllGrids(true);
+    }
+    else {
+        const QVector<QicsRegion> &regions = myPendingChanges.regions();
+        for (int i = 0; i < regions.size(); ++i)
+            redrawModel(regions.at(i), false);
+    }
+
+    myPendingChanges.clear();
+    myPendingFullRedraw = false;
+}
+
 void QicsGridInfo::setSortingSensitivity(Qt::CaseSensitivity cs)
 {
     m_rowOrdering->setSortingSensitivity(cs);
@@ -949,70 +1091,62 @@ void QicsGridInfo::setDefaultImagePath(const QString &path)
 
 int QicsGridInfo::firstNonHiddenRow(int startRow, int endRow) const
 {
-    while (startRow <= endRow) {
-        if (!mappedDM()->isRowHidden(startRow))
-            return startRow;
+    if (startRow > endRow)
+        return -1;
 
-        ++startRow;
-    }
+    const int row = mappedDM()->nextVisibleRow(startRow);
 
-    return -1;
+    return (row <= endRow ? row : -1);
 }
 
 int QicsGridInfo::firstNonHiddenModelRow(int startRow, int endRow) const
 {
-    while (startRow <= endRow) {
-        if (!mappedDM()->dimensionManager()->isRowHidden(startRow))
-            return startRow;
+    if (startRow > endRow)
+        return -1;
 
-        ++startRow;
-    }
+    const int row = mappedDM()->dimensionManager()->nextVisibleRow(startRow);
 
-    return -1;
+    return (row <= endRow ? row : -1);
 }
 
 int QicsGridInfo::lastNonHiddenRow(int startRow, int endRow) const
 {
-    while (endRow >= startRow) {
-        if (!mappedDM()->isRowHidden(endRow))
-            return endRow;
-        --endRow;
-    }
+    if (startRow > endRow)
+        return -1;
+
+    const int row = mappedDM()->previousVisibleRow(endRow);
 
-    return -1;
+    return (row >= startRow ? row : -1);
 }
 
 int QicsGridInfo::firstNonHiddenModelColumn(int startColumn, int endColumn) const
 {
-    while (startColumn <= endColumn) {
-        if (!mappedDM()->dimensionManager()->isColumnHidden(startColumn))
-            return startColumn;
-        ++startColumn;
-    }
+    if (startColumn > endColumn)
+        return -1;
+
+    const int col = mappedDM()->dimensionManager()->nextVisibleColumn(startColumn);
 
-    return -1;
+    return (col <= endColumn ? col : -1);
 }
 
 int QicsGridInfo::firstNonHiddenColumn(int startColumn, int endColumn) const
 {
-    while (startColumn <= endColumn) {
-        if (!mappedDM()->isColumnHidden(startColumn))
-            return startColumn;
-        ++startColumn;
-    }
+    if (startColumn > endColumn)
+        return -1;
+
+    const int col = mappedDM()->nextVisibleColumn(startColumn);
 
-    return -1;
+    return (col <= endColumn ? col : -1);
 }
 
 int QicsGridInfo::lastNonHiddenColumn(int startColumn, int endColumn) const
 {
-    while (endColumn >= startColumn) {
-        if (!mappedDM()->isColumnHidden(endColumn))
-            return endColumn;
-        --endColumn;
-    }
+    if (startColumn > endColumn)
+        return -1;
+
+    const int col = mappedDM()->previousVisibleColumn(endColumn);
 
-    return -1;
+    return (col >= startColumn ? col : -1);
 }
 
 void QicsGridInfo::reportSelection(Qics::QicsSelectionType stype,
@@ -0,0 +1,285 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#include "QicsIndexSet.h"
+
+
+static inline int bitCount(quint64 w)
+{
+    w = w - ((w >> 1) & Q_UINT64_C(0x5555555555555555));
+    w = (w & Q_UINT64_C(0x3333333333333333)) + ((w >> 2) & Q_UINT64_C(0x3333333333333333));
+    w = (w + (w >> 4)) & Q_UINT64_C(0x0f0f0f0f0f0f0f0f);
+    return int((w * Q_UINT64_C(0x0101010101010101)) >> 56);
+}
+
+// position of the lowest set bit of a non-zero word
+static inline int lowestBit(quint64 w)
+{
+    return bitCount((w & (~w + 1)) - 1);
+}
+
+// position of the highest set bit of a non-zero word
+static inline int highestBit(quint64 w)
+{
+    int n = 0;
+    if (w >> 32) { w >>= 32; n += 32; }
+    if (w >> 16) { w >>= 16; n += 16; }
+    if (w >> 8) { w >>= 8; n += 8; }
+    if (w >> 4) { w >>= 4; n += 4; }
+    if (w >> 2) { w >>= 2; n += 2; }
+    if (w >> 1) { n += 1; }
+    return n;
+}
+
+
+QicsIndexSet::QicsIndexSet()
+    : myCount(0)
+{
+}
+
+void QicsIndexSet::clear()
+{
+    myWords.clear();
+    myTree.clear();
+    myCount = 0;
+}
+
+bool QicsIndexSet::insert(int index)
+{
+    if (index < 0 || contains(index))
+        return false;
+
+    const int word = index >> 6;
+
+    if (word >= myWords.size()) {
+        // grow geometrically, so that appending runs stays cheap
+        myWords.resize(qMax(word + 1, 2 * myWords.size()));
+        rebuildTree();
+    }
+
+    myWords[word] |= (Q_UINT64_C(1) << (index & 63));
+    addToTree(word, 1);
+    ++myCount;
+
+    return true;
+}
+
+bool QicsIndexSet::remove(int index)
+{
+    if (!contains(index))
+        return false;
+
+    const int word = index >> 6;
+
+    myWords[word] &= ~(Q_UINT64_C(1) << (index & 63));
+    addToTree(word, -1);
+    --myCount;
+
+    if (!myCount)
+        clear();
+
+    return true;
+}
+
+int QicsIndexSet::count(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, myWords.size() * 64 - 1);
+
+    if (last < first)
+        return 0;
+
+    return rank(last + 1) - rank(first);
+}
+
+int QicsIndexSet::nextAbsent(int index) const
+{
+    index = qMax(index, 0);
+
+    const int words = myWords.size();
+    if (index >= words * 64)
+        return index;
+
+    int word = index >> 6;
+    quint64 absent = ~myWords.at(word) & (~Q_UINT64_C(0) << (index & 63));
+
+    if (!absent) {
+        // skip every full word up to the next absent bit
+        const int absentBefore = (word + 1) * 64 - countBefore(word + 1);
+        word = selectAbsentWord(absentBefore);
+        if (word >= words)
+            return words * 64;
+        absent = ~myWords.at(word);
+    }
+
+    return (word << 6) + lowestBit(absent);
+}
+
+int QicsIndexSet::previousAbsent(int index) const
+{
+    if (index < 0)
+        return -1;
+
+    const int words = myWords.size();
+    if (index >= words * 64)
+        return index;
+
+    int word = index >> 6;
+    const int bit = index & 63;
+    quint64 absent = ~myWords.at(word);
+    if (bit < 63)
+        absent &= ((Q_UINT64_C(1) << (bit + 1)) - 1);
+
+    if (!absent) {
+        const int absentBefore = word * 64 - countBefore(word);
+        if (absentBefore == 0)
+            return -1;
+        word = selectAbsentWord(absentBefore - 1);
+        absent = ~myWords.at(word);
+    }
+
+    return (word << 6) + highestBit(absent);
+}
+
+void QicsIndexSet::insertSpace(int start, int num)
+{
+    if (num <= 0 || myCount == 0)
+        return;
+
+    const QList<int> members = toList();
+    const int last = members.last();
+
+    clear();
+    if (last >= start)
+        myWords.resize(((last + num) >> 6) + 1);
+    else
+        myWords.resize((last >> 6) + 1);
+
+    for (int i = 0; i < members.size(); ++i) {
+        const int x = members.at(i);
+        const int y = (x >= start) ? x + num : x;
+        myWords[y >> 6] |= (Q_UINT64_C(1) << (y & 63));
+    }
+
+    myCount = members.size();
+    rebuildTree();
+}
+
+void QicsIndexSet::removeSpace(int start, int num)
+{
+    if (num <= 0 || myCount == 0)
+        return;
+
+    const QList<int> members = toList();
+
+    clear();
+    myWords.resize((members.last() >> 6) + 1);
+
+    for (int i = 0; i < members.size(); ++i) {
+        int x = members.at(i);
+        if (x >= start + num)
+            x -= num;
+        else if (x >= start)
+            continue;
+
+        myWords[x >> 6] |= (Q_UINT64_C(1) << (x & 63));
+        ++myCount;
+    }
+
+    if (myCount)
+        rebuildTree();
+    else
+        clear();
+}
+
+QList<int> QicsIndexSet::toList() const
+{
+    QList<int> list;
+    list.reserve(myCount);
+
+    const int words = myWords.size();
+    for (int i = 0; i < words; ++i) {
+        quint64 w = myWords.at(i);
+        while (w) {
+            list.append((i << 6) + lowestBit(w));
+            w &= w - 1;
+        }
+    }
+
+    return list;
+}
+
+int QicsIndexSet::rank(int index) const
+{
+    const int word = index >> 6;
+    int n = countBefore(word);
+
+    if (index & 63)
+        n += bitCount(myWords.at(word) & ((Q_UINT64_C(1) << (index & 63)) - 1));
+
+    return n;
+}
+
+int QicsIndexSet::countBefore(int word) const
+{
+    int n = 0;
+    for (int i = qMin(word, myWords.size()); i > 0; i -= (i & -i))
+        n += myTree.at(i);
+    return n;
+}
+
+int QicsIndexSet::selectAbsentWord(int rank) const
+{
+    const int words = myWords.size();
+
+    int step = 1;
+    while (step * 2 <= words)
+        step *= 2;
+
+    // find the longest prefix of words with no more than rank absent bits
+    int pos = 0;
+    for (; step > 0; step /= 2) {
+        const int next = pos + step;
+        if (next <= words) {
+            const int absent = step * 64 - myTree.at(next);
+            if (absent <= rank) {
+                pos = next;
+                rank -= absent;
+            }
+        }
+    }
+
+    return pos;
+}
+
+void QicsIndexSet::addToTree(int word, int delta)
+{
+    const int words = myWords.size();
+    for (int i = word + 1; i <= words; i += (i & -i))
+        myTree[i] += delta;
+}
+
+void QicsIndexSet::rebuildTree()
+{
+    const int words = myWords.size();
+
+    myTree.fill(0, words + 1);
+    int *tree = myTree.data();
+
+    for (int i = 1; i <= words; ++i) {
+        tree[i] += bitCount(myWords.at(i - 1));
+
+        const int parent = i + (i & -i);
+        if (parent <= words)
+            tree[parent] += tree[i];
+    }
+}
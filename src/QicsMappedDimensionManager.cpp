@@ -14,12 +14,27 @@
 
 #include "QicsDimensionManager.h"
 #include "QicsStyleManager.h"
+#include "QicsGridInfo.h"
+#include "QicsDataModel.h"
+#include "QicsSorter.h"
+
+// regions with fewer rows or columns are summed directly
+#define QICS_OFFSET_INDEX_THRESHOLD 64
 
 
 QicsMappedDimensionManager::QicsMappedDimensionManager(QicsDimensionManager *_dm,
                                                        QicsGridInfo *_gi)
     : myDM(_dm), myInfo(_gi)
 {
+    myRowOffsets.valid = false;
+    myRowOffsets.sorter = 0;
+    myColumnOffsets.valid = false;
+    myColumnOffsets.sorter = 0;
+
+    connect(myDM, SIGNAL(dimensionChanged()),
+        this, SLOT(invalidateOffsets()));
+    connect(myDM, SIGNAL(dimensionChanged(Qics::QicsIndexType, int, int)),
+        this, SLOT(updateOffsets(Qics::QicsIndexType, int, int)));
 }
 
 QicsMappedDimensionManager::~QicsMappedDimensionManager()
@@ -290,63 +305,226 @@ void QicsMappedDimensionManager::stretchColumns(int start_col, int end_col,
 
 int QicsMappedDimensionManager::regionHeight(const QicsRegion &region) const
 {
-    int height = 0;
-    int num_hidden_rows = 0;
-    int i;
+    const int first = region.startRow();
+    const int last = region.endRow();
+    qint64 height = 0;
+    int num_visible_rows = 0;
+
+    if (last - first < QICS_OFFSET_INDEX_THRESHOLD) {
+        for (int i = first; i <= last; ++i) {
+            if (!isRowHidden(i)) {
+                height += myDM->rowHeight(myInfo->modelRowIndex(i));
+                ++num_visible_rows;
+            }
+        }
+    }
+    else {
+        const QicsOffsetIndex &index = offsetIndex(Qics::RowIndex);
+        const int from = qMax(first, 0);
+        const int to = qMin(last, index.size() - 1);
 
-    for (i = region.startRow(); i <= region.endRow(); ++i) {
-        if (isRowHidden(i))
-            ++num_hidden_rows;
-        else
-            height += myDM->rowHeight(myInfo->modelRowIndex(i));
+        height = index.rangeExtent(from, to);
+        num_visible_rows = index.visibleCount(from, to);
     }
 
-    bool isVisible = (* static_cast<bool *>
-        (myInfo->styleManager()->getGridProperty(QicsGridStyle::HorizontalGridLinesVisible)));
+    height += qint64(lineWidth(Qics::RowIndex)) * (num_visible_rows - 1);
 
-    int hlw = isVisible ? (* static_cast<int *>
-        (myInfo->styleManager()->getGridProperty(QicsGridStyle::HorizontalGridLineWidth))) : 0;
+    return int(height);
+}
 
-    height += (hlw * (region.endRow() - region.startRow() -
-        num_hidden_rows));
+int QicsMappedDimensionManager::regionWidth(const QicsRegion &region) const
+{
+    const int first = region.startColumn();
+    const int last = region.endColumn();
+    qint64 width = 0;
+    int num_visible_cols = 0;
+
+    if (last - first < QICS_OFFSET_INDEX_THRESHOLD) {
+        for (int j = first; j <= last; ++j) {
+            if (!isColumnHidden(j)) {
+                width += myDM->columnWidth(myInfo->modelColumnIndex(j));
+                ++num_visible_cols;
+            }
+        }
+    }
+    else {
+        const QicsOffsetIndex &index = offsetIndex(Qics::ColumnIndex);
+        const int from = qMax(first, 0);
+        const int to = qMin(last, index.size() - 1);
 
-    Qics::QicsLineStyle hls = (* static_cast<Qics::QicsLineStyle *>
-        (myInfo->styleManager()->getGridProperty(QicsGridStyle::HorizontalGridLineStyle)));
+        width = index.rangeExtent(from, to);
+        num_visible_cols = index.visibleCount(from, to);
+    }
 
-    if (hls == Qics::Raised || hls == Qics::Sunken)
-        height += (2*hlw * (region.endRow() - region.startRow() - num_hidden_rows));
+    width += qint64(lineWidth(Qics::ColumnIndex)) * (num_visible_cols - 1);
 
-    return height;
+    return int(width);
 }
 
-int QicsMappedDimensionManager::regionWidth(const QicsRegion &region) const
+int QicsMappedDimensionManager::rowOffset(int row) const
 {
-    int width = 0;
-    int num_hidden_cols = 0;
-    int j;
+    const QicsOffsetIndex &index = offsetIndex(Qics::RowIndex);
 
-    for (j = region.startColumn(); j <= region.endColumn(); ++j) {
-        if (isColumnHidden(j))
-            ++num_hidden_cols;
-        else
-            width += myDM->columnWidth(myInfo->modelColumnIndex(j));
-    }
+    return int(index.offset(qBound(0, row, index.size()),
+        lineWidth(Qics::RowIndex)));
+}
+
+int QicsMappedDimensionManager::rowAtOffset(int y) const
+{
+    return offsetIndex(Qics::RowIndex).indexAt(y, lineWidth(Qics::RowIndex));
+}
+
+int QicsMappedDimensionManager::columnOffset(int col) const
+{
+    const QicsOffsetIndex &index = offsetIndex(Qics::ColumnIndex);
+
+    return int(index.offset(qBound(0, col, index.size()),
+        lineWidth(Qics::ColumnIndex)));
+}
+
+int QicsMappedDimensionManager::columnAtOffset(int x) const
+{
+    return offsetIndex(Qics::ColumnIndex).indexAt(x, lineWidth(Qics::ColumnIndex));
+}
+
+int QicsMappedDimensionManager::nextVisibleRow(int row) const
+{
+    return offsetIndex(Qics::RowIndex).nextVisible(row);
+}
+
+int QicsMappedDimensionManager::previousVisibleRow(int row) const
+{
+    return offsetIndex(Qics::RowIndex).previousVisible(row);
+}
+
+int QicsMappedDimensionManager::nextVisibleColumn(int col) const
+{
+    return offsetIndex(Qics::ColumnIndex).nextVisible(col);
+}
+
+int QicsMappedDimensionManager::previousVisibleColumn(int col) const
+{
+    return offsetIndex(Qics::ColumnIndex).previousVisible(col);
+}
+
+int QicsMappedDimensionManager::lineWidth(Qics::QicsIndexType type) const
+{
+    const bool rows = (type == Qics::RowIndex);
 
     bool isVisible = (* static_cast<bool *>
-        (myInfo->styleManager()->getGridProperty(QicsGridStyle::VerticalGridLinesVisible)));
+        (myInfo->styleManager()->getGridProperty(rows ?
+            QicsGridStyle::HorizontalGridLinesVisible :
+            QicsGridStyle::VerticalGridLinesVisible)));
+
+    if (!isVisible)
+        return 0;
+
+    int lw = (* static_cast<int *>
+        (myInfo->styleManager()->getGridProperty(rows ?
+            QicsGridStyle::HorizontalGridLineWidth :
+            QicsGridStyle::VerticalGridLineWidth)));
+
+    Qics::QicsLineStyle ls = (* static_cast<Qics::QicsLineStyle *>
+        (myInfo->styleManager()->getGridProperty(rows ?
+            QicsGridStyle::HorizontalGridLineStyle :
+            QicsGridStyle::VerticalGridLineStyle)));
+
+    // raised and sunken lines are drawn three times as wide
+    if (ls == Qics::Raised || ls == Qics::Sunken)
+        lw *= 3;
+
+    return lw;
+}
+
+int QicsMappedDimensionManager::visualExtent(Qics::QicsIndexType type, int index) const
+{
+    if (type == Qics::RowIndex) {
+        const int row = myInfo->modelRowIndex(index);
+        return (myDM->isRowHidden(row) ? -1 : myDM->rowHeight(row));
+    }
+
+    const int col = myInfo->modelColumnIndex(index);
+    return (myDM->isColumnHidden(col) ? -1 : myDM->columnWidth(col));
+}
+
+bool QicsMappedDimensionManager::isOffsetIndexCurrent(Qics::QicsIndexType type) const
+{
+    const QicsOffsetCache &cache = offsetCache(type);
+    if (!cache.valid)
+        return false;
+
+    const bool rows = (type == Qics::RowIndex);
+    const QicsSorter *sorter = rows ? myInfo->rowOrdering() : myInfo->columnOrdering();
+    const QicsDataModel *dm = myInfo->dataModel();
+    const int size = dm ? (rows ? dm->numRows() : dm->numColumns()) : 0;
+
+    return (cache.sorter == sorter &&
+        (!sorter || cache.orderRevision == sorter->orderRevision()) &&
+        cache.revision == (rows ? myDM->rowRevision() : myDM->columnRevision()) &&
+        cache.index.size() == size);
+}
+
+const QicsOffsetIndex &QicsMappedDimensionManager::offsetIndex(Qics::QicsIndexType type) const
+{
+    QicsOffsetCache &cache = offsetCache(type);
 
-    int vlw = isVisible ? (* static_cast<int *>
-        (myInfo->styleManager()->getGridProperty(QicsGridStyle::VerticalGridLineWidth))) : 0;
+    if (isOffsetIndexCurrent(type))
+        return cache.index;
 
-    width += (vlw * (region.endColumn() - region.startColumn() - num_hidden_cols));
+    const bool rows = (type == Qics::RowIndex);
+    const QicsSorter *sorter = rows ? myInfo->rowOrdering() : myInfo->columnOrdering();
+    const QicsDataModel *dm = myInfo->dataModel();
+    const int size = dm ? (rows ? dm->numRows() : dm->numColumns()) : 0;
 
-    Qics::QicsLineStyle vls = (* static_cast<Qics::QicsLineStyle *>
-        (myInfo->styleManager()->getGridProperty(QicsGridStyle::VerticalGridLineStyle)));
+    QVector<int> extents(size);
+    int *data = extents.data();
+    for (int i = 0; i < size; ++i)
+        data[i] = visualExtent(type, i);
 
-    if (vls == Qics::Raised || vls == Qics::Sunken)
-        width += (2*vlw * (region.endColumn() - region.startColumn() - num_hidden_cols));
+    cache.index.reset(extents);
+    cache.valid = true;
+    cache.revision = rows ? myDM->rowRevision() : myDM->columnRevision();
+    cache.sorter = sorter;
+    cache.orderRevision = sorter ? sorter->orderRevision() : 0;
+
+    return cache.index;
+}
 
-    return width;
+void QicsMappedDimensionManager::invalidateOffsets()
+{
+    myRowOffsets.valid = false;
+    myColumnOffsets.valid = false;
+}
+
+void QicsMappedDimensionManager::updateOffsets(Qics::QicsIndexType type,
+                                               int start, int end)
+{
+    if (type != Qics::RowIndex && type != Qics::ColumnIndex)
+        return;
+
+    QicsOffsetCache &cache = offsetCache(type);
+
+    if (!isOffsetIndexCurrent(type))
+        return;
+
+    if (end - start >= QICS_OFFSET_INDEX_THRESHOLD) {
+        cache.valid = false;
+        return;
+    }
+
+    // The dimension manager reports some changes in visual and some
+    // in model coordinates, so both readings of the range are updated.
+    const int size = cache.index.size();
+
+    for (int i = start; i <= end; ++i) {
+        const int v = (type == Qics::RowIndex) ?
+            myInfo->visualRowIndex(i) : myInfo->visualColumnIndex(i);
+
+        if (i >= 0 && i < size)
+            cache.index.setExtent(i, visualExtent(type, i));
+        if (v >= 0 && v < size && v != i)
+            cache.index.setExtent(v, visualExtent(type, v));
+    }
 }
 
 void QicsMappedDimensionManager::overrideRowHeight(int row, int height)
@@ -0,0 +1,204 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#include "QicsOffsetIndex.h"
+
+
+QicsOffsetIndex::QicsOffsetIndex()
+{
+}
+
+void QicsOffsetIndex::clear()
+{
+    myExtents.clear();
+    myExtentTree.clear();
+    myCountTree.clear();
+}
+
+void QicsOffsetIndex::reset(const QVector<int> &extents)
+{
+    const int n = extents.size();
+
+    myExtents = extents;
+    myExtentTree.fill(0, n + 1);
+    myCountTree.fill(0, n + 1);
+
+    qint64 *tree = myExtentTree.data();
+    int *counts = myCountTree.data();
+
+    for (int i = 1; i <= n; ++i) {
+        const int e = extents.at(i - 1);
+        if (e >= 0) {
+            tree[i] += e;
+            ++counts[i];
+        }
+
+        // push the partial sum up to the parent node
+        const int parent = i + (i & -i);
+        if (parent <= n) {
+            tree[parent] += tree[i];
+            counts[parent] += counts[i];
+        }
+    }
+}
+
+void QicsOffsetIndex::setExtent(int index, int extent)
+{
+    const int old = myExtents.at(index);
+    if (old == extent)
+        return;
+
+    myExtents[index] = extent;
+
+    const qint64 delta = qint64(qMax(extent, 0)) - qMax(old, 0);
+    const int countDelta = (extent >= 0 ? 1 : 0) - (old >= 0 ? 1 : 0);
+    const int n = myExtents.size();
+
+    for (int i = index + 1; i <= n; i += (i & -i)) {
+        myExtentTree[i] += delta;
+        myCountTree[i] += countDelta;
+    }
+}
+
+void QicsOffsetIndex::prefix(int index, qint64 &extent, int &count) const
+{
+    extent = 0;
+    count = 0;
+
+    for (int i = qMin(index, myExtents.size()); i > 0; i -= (i & -i)) {
+        extent += myExtentTree.at(i);
+        count += myCountTree.at(i);
+    }
+}
+
+qint64 QicsOffsetIndex::offset(int index, int lineWidth) const
+{
+    qint64 extent;
+    int count;
+    prefix(index, extent, count);
+
+    return extent + qint64(lineWidth) * count;
+}
+
+qint64 QicsOffsetIndex::rangeExtent(int first, int last) const
+{
+    if (last < first)
+        return 0;
+
+    qint64 e1, e2;
+    int c1, c2;
+    prefix(first, e1, c1);
+    prefix(last + 1, e2, c2);
+
+    return e2 - e1;
+}
+
+int QicsOffsetIndex::visibleCount(int first, int last) const
+{
+    if (last < first)
+        return 0;
+
+    qint64 e1, e2;
+    int c1, c2;
+    prefix(first, e1, c1);
+    prefix(last + 1, e2, c2);
+
+    return c2 - c1;
+}
+
+int QicsOffsetIndex::indexAt(qint64 pos, int lineWidth) const
+{
+    const int n = myExtents.size();
+
+    if (pos < 0 || n == 0)
+        return -1;
+
+    int step = 1;
+    while (step * 2 <= n)
+        step *= 2;
+
+    // Find the number of leading entries which end at or before pos.
+    // Hidden entries have no extent, so they are always skipped.
+    int k = 0;
+    qint64 acc = 0;
+
+    for (; step > 0; step /= 2) {
+        const int next = k + step;
+        if (next <= n) {
+            const qint64 sum = acc + myExtentTree.at(next) +
+                qint64(lineWidth) * myCountTree.at(next);
+            if (sum <= pos) {
+                k = next;
+                acc = sum;
+            }
+        }
+    }
+
+    return (k < n ? k : -1);
+}
+
+int QicsOffsetIndex::nextVisible(int index) const
+{
+    index = qMax(index, 0);
+
+    const int n = myExtents.size();
+    if (index >= n)
+        return -1;
+
+    if (myExtents.at(index) >= 0)
+        return index;
+
+    qint64 extent;
+    int count;
+    prefix(index, extent, count);
+
+    const int next = selectVisible(count);
+    return (next < n ? next : -1);
+}
+
+int QicsOffsetIndex::previousVisible(int index) const
+{
+    const int n = myExtents.size();
+    if (index < 0 || n == 0)
+        return -1;
+
+    index = qMin(index, n - 1);
+    if (myExtents.at(index) >= 0)
+        return index;
+
+    qint64 extent;
+    int count;
+    prefix(index, extent, count);
+
+    return (count > 0 ? selectVisible(count - 1) : -1);
+}
+
+int QicsOffsetIndex::selectVisible(int rank) const
+{
+    const int n = myExtents.size();
+
+    int step = 1;
+    while (step * 2 <= n)
+        step *= 2;
+
+    // find the longest prefix with no more than rank visible entries
+    int k = 0;
+    for (; step > 0; step /= 2) {
+        const int next = k + step;
+        if (next <= n && myCountTree.at(next) <= rank) {
+            k = next;
+            rank -= myCountTree.at(next);
+        }
+    }
+
+    return k;
+}
@@ -525,8 +525,15 @@ bool QicsRegionalAttributeController::setDefaultProperty(int name, const void *v
 
     // special case - font virtual attributes
     if (name >= QicsCellStyle::FontFamily && name <= QicsCellStyle::FontStretch) {
+        // the default font is shared with other styles, so change a copy
+        QFont font;
         QFont *f = (QFont*)defaultProperty(QicsCellStyle::Font);
+        if (f)
+            font = *f;
+        f = &font;
+
         QicsAttrCommon::applyFontAttr(&f, name, val);
+        myDefaultStyle->setValue(QicsCellStyle::Font, f);
         return true;
     }
 
@@ -62,9 +62,12 @@ void QicsRow::init()
     }
     else {
         // connect to the row ordering object
-        if (m_info->rowOrdering())
+        if (m_info->rowOrdering()) {
             connect(m_info->rowOrdering(), SIGNAL(orderChanged(Qics::QicsIndexType, int*, int)),
                 this, SLOT(handleOrderChanged(Qics::QicsIndexType, int*, int)));
+            connect(m_info->rowOrdering(), SIGNAL(itemMoved(Qics::QicsIndexType, int, int)),
+                this, SLOT(handleItemMoved(Qics::QicsIndexType, int, int)));
+        }
     }
 }
 
@@ -277,11 +280,8 @@ bool QicsRow::selected() const
 {
     const QicsSelectionManager *sm = m_info->selectionManager();
     if (!sm) return false;
-    const QicsSelectionList* list = sm->selectionList(true);
-    if (!list) return false;
 
-    const int row = rowIndex();
-    return list->isRowSelected(row);
+    return sm->isRowSelected(rowIndex());
 }
 
 void QicsRow::hide()
@@ -337,6 +337,12 @@ void QicsRow::handleOrderChanged(Qics::QicsIndexType type, int* visChange, int s
     }
 }
 
+void QicsRow::handleItemMoved(Qics::QicsIndexType type, int from, int to)
+{
+    if (type == Qics::RowIndex && myRow >= 0)
+        myRow = QicsSorter::movedIndex(myRow, from, to);
+}
+
 void QicsRow::changeDataModel(QicsDataModel *old_dt, QicsDataModel *)
 {
     // get rid of connections to old data model
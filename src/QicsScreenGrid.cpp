@@ -66,7 +66,7 @@ QicsScreenGrid::QicsScreenGrid(QWidget *w, QicsGridInfo &info,
        m_selectOnTraverse(true),
        timerScrolling(0),
        m_scrollDirec(Qics::ScrollNone),
-       m_paintRegion()
+       m_paintRegions()
 {
     setAttribute(Qt::WA_NoSystemBackground, true);
     setAttribute(Qt::WA_OpaquePaintEvent, true);
@@ -213,9 +213,19 @@ void QicsScreenGrid::setTopRow(int value)
     QicsRegion vp = realViewport();
 
     if ((value >= vp.startRow()) && (value <= vp.endRow())) {
+        // keep the old positions, so that the buffer can be scrolled
+        const bool can_scroll = canScrollImageBuffer(Qics::RowIndex);
+        const int old_top = m_topRow;
+        const int old_bottom = m_bottomRow;
+        QicsPositionList old_positions;
+        if (can_scroll)
+            old_positions = myRowPositions;
+
         m_topRow = gridInfo().firstNonHiddenRow(value, vp.endRow());
         recomputeCellPositions(Qics::RowIndex);
-        recomputeAndDraw(Qics::RowIndex);
+
+        if (!can_scroll || !scrollImageBuffer(Qics::RowIndex, old_positions, old_top, old_bottom))
+            recomputeAndDraw(Qics::RowIndex);
     }
 }
 
@@ -224,9 +234,18 @@ void QicsScreenGrid::setLeftColumn(int value)
     QicsRegion vp = realViewport();
 
     if ((value >= vp.startColumn()) && (value <= vp.endColumn())) {
+        const bool can_scroll = canScrollImageBuffer(Qics::ColumnIndex);
+        const int old_left = m_leftColumn;
+        const int old_right = m_rightColumn;
+        QicsPositionList old_positions;
+        if (can_scroll)
+            old_positions = myColumnPositions;
+
         m_leftColumn = gridInfo().firstNonHiddenColumn(value, vp.endColumn());
         recomputeCellPositions(Qics::ColumnIndex);
-        recomputeAndDraw(Qics::ColumnIndex);
+
+        if (!can_scroll || !scrollImageBuffer(Qics::ColumnIndex, old_positions, old_left, old_right))
+            recomputeAndDraw(Qics::ColumnIndex);
     }
 }
 
@@ -345,10 +364,8 @@ int QicsScreenGrid::visibleRows()
 
     int numVisibleRows = 0;
 
-    for (int i = m_topRow; i <= m_bottomRow; ++i) {
-        m_row->setRowIndex(i);
-        if (m_row->isHidden())
-            continue;
+    for (int i = m_info.firstNonHiddenRow(m_topRow, m_bottomRow); i >= 0;
+        i = m_info.firstNonHiddenRow(i + 1, m_bottomRow)) {
         ++numVisibleRows;
     }
 
@@ -371,10 +388,8 @@ int QicsScreenGrid::visibleColumns()
 
     int numVisibleColumns = 0;
 
-    for (int i = m_leftColumn; i <= m_rightColumn; ++i) {
-        m_column->setColumnIndex(i);
-        if (m_column->isHidden())
-            continue;
+    for (int i = m_info.firstNonHiddenColumn(m_leftColumn, m_rightColumn); i >= 0;
+        i = m_info.firstNonHiddenColumn(i + 1, m_rightColumn)) {
         ++numVisibleColumns;
     }
 
@@ -470,18 +485,14 @@ void QicsScreenGrid::computeCellPositions(Qics::QicsIndexType indexType)
 
     m_cellsToNotify.clear();
 
-    for (int i = m_topRow; i <= m_bottomRow; ++i) {
+    for (int i = m_info.firstNonHiddenRow(m_topRow, m_bottomRow); i >= 0;
+        i = m_info.firstNonHiddenRow(i + 1, m_bottomRow)) {
         m_row->setRowIndex(i);
 
-        if (m_row->isHidden())
-            continue;
-
-        for (int j = m_leftColumn; j <= m_rightColumn; ++j) {
+        for (int j = m_info.firstNonHiddenColumn(m_leftColumn, m_rightColumn); j >= 0;
+            j = m_info.firstNonHiddenColumn(j + 1, m_rightColumn)) {
             m_column->setColumnIndex(j);
 
-            if (m_column->isHidden())
-                continue;
-
             QicsCellDisplay *cd = cellDisplay(i, j);
 
             if (cd && cd->needsVisibilityNotification()) {
@@ -531,12 +542,17 @@ void QicsScreenGrid::computeLastPage(Qics::QicsIndexType indexType)
         int current_y = 0;
         while (this_row >= real_vp.startRow()) {
             m_row->setRowIndex(this_row);
-            if (!m_row->isHidden()) {
-                int proposed_y = (current_y + mappedDM().rowHeight(this_row) + hlw);
-                if ((proposed_y + hlw) > contents.height())
-                    break;
-                current_y = proposed_y;
+            if (m_row->isHidden()) {
+                // jump over the whole run of hidden rows
+                this_row = qMax(gridInfo().lastNonHiddenRow(real_vp.startRow(), this_row - 1),
+                    real_vp.startRow() - 1);
+                continue;
             }
+
+            int proposed_y = (current_y + mappedDM().rowHeight(this_row) + hlw);
+            if ((proposed_y + hlw) > contents.height())
+                break;
+            current_y = proposed_y;
             --this_row;
         }
         start_row = this_row;
@@ -560,12 +576,17 @@ void QicsScreenGrid::computeLastPage(Qics::QicsIndexType indexType)
             int current_x = contents.width();
             while (this_col >= real_vp.startColumn()) {
                 m_column->setColumnIndex(this_col);
-                if (!m_column->isHidden()) {
-                    int proposed_x = (current_x - mappedDM().columnWidth(this_col) - vlw);
-                    if ((proposed_x + vlw) < frameWidth())
-                        break;
-                    current_x = proposed_x;
+                if (m_column->isHidden()) {
+                    // jump over the whole run of hidden columns
+                    this_col = qMax(gridInfo().lastNonHiddenColumn(real_vp.startColumn(), this_col - 1),
+                        real_vp.startColumn() - 1);
+                    continue;
                 }
+
+                int proposed_x = (current_x - mappedDM().columnWidth(this_col) - vlw);
+                if ((proposed_x + vlw) < frameWidth())
+                    break;
+                current_x = proposed_x;
                 --this_col;
             }
             start_col = this_col;
@@ -575,12 +596,17 @@ void QicsScreenGrid::computeLastPage(Qics::QicsIndexType indexType)
             int current_x = 0;
             while (this_col >= real_vp.startColumn()) {
                 m_column->setColumnIndex(this_col);
-                if (!m_column->isHidden()) {
-                    int proposed_x = (current_x + mappedDM().columnWidth(this_col) + vlw);
-                    if ((proposed_x + vlw) > contents.width())
-                        break;
-                    current_x = proposed_x;
+                if (m_column->isHidden()) {
+                    // jump over the whole run of hidden columns
+                    this_col = qMax(gridInfo().lastNonHiddenColumn(real_vp.startColumn(), this_col - 1),
+                        real_vp.startColumn() - 1);
+                    continue;
                 }
+
+                int proposed_x = (current_x + mappedDM().columnWidth(this_col) + vlw);
+                if ((proposed_x + vlw) > contents.width())
+                    break;
+                current_x = proposed_x;
                 --this_col;
             }
             start_col = this_col;
@@ -647,13 +673,9 @@ int QicsScreenGrid::rowAt(int y, bool nearest) const
         return (nearest ? m_topRow : -1);
 
     // Now go through each row and check the position
-    for (i = m_topRow; i <= m_bottomRow; ++i) {
-        // Don't bother with this row if it is hidden
-        m_row->setRowIndex(i);
-
-        if (m_row->isHidden())
-            continue;
-
+    // Only visible rows have a position, so jump from one to the next
+    for (i = gridInfo().firstNonHiddenRow(m_topRow, m_bottomRow); i >= 0;
+         i = gridInfo().firstNonHiddenRow(i + 1, m_bottomRow)) {
         if (y >= myRowPositions.at(i)) {
             if (i == m_bottomRow) {
                 // This is the last row
@@ -721,13 +743,8 @@ int QicsScreenGrid::columnAt(int x, bool nearest) const
 
     // Now go through each column and check the position
     if (isRightToLeft()) { //   <<<<----
-        for (i = m_leftColumn; i <= m_rightColumn; ++i) {
-            // Don't bother with this column if it is hidden
-            m_column->setColumnIndex(i);
-
-            if (m_column->isHidden())
-                continue;
-
+        for (i = gridInfo().firstNonHiddenColumn(m_leftColumn, m_rightColumn); i >= 0;
+             i = gridInfo().firstNonHiddenColumn(i + 1, m_rightColumn)) {
             if (x <= myColumnPositions.at(i) || ((i==0) &&  (x <= frameRect().right())) ) {
                 if (i == m_rightColumn) {
                     // This is the last column
@@ -759,13 +776,8 @@ int QicsScreenGrid::columnAt(int x, bool nearest) const
         }
     }
     else {    //   --->>>>
-        for (i = m_leftColumn; i <= m_rightColumn; ++i) {
-            // Don't bother with this column if it is hidden
-            m_column->setColumnIndex(i);
-
-            if (m_column->isHidden())
-                continue;
-
+        for (i = gridInfo().firstNonHiddenColumn(m_leftColumn, m_rightColumn); i >= 0;
+             i = gridInfo().firstNonHiddenColumn(i + 1, m_rightColumn)) {
             if (x >= myColumnPositions.at(i)) {
                 if (i == m_rightColumn) {
                     // This is the last column
@@ -946,11 +958,7 @@ void QicsScreenGrid::redraw()
 void QicsScreenGrid::redraw(const QicsRegion &region)
 {
     if(region.isValid()) {
-        if (m_paintRegion.isValid())
-            m_paintRegion |= region;
-        else
-            m_paintRegion = region;
-
+        m_paintRegions.add(region);
 
         m_repaintAll = false;
     }
@@ -978,7 +986,8 @@ void QicsScreenGrid::paintEvent(QPaintEvent* ev)
 
         if (!m_repaintAll && !m_initialRepaint) {
         const QicsRegion &svp = viewport();
-        m_repaintAll = (m_paintRegion.endRow() > svp.endRow()) || (m_paintRegion.endColumn() > svp.endColumn());
+        const QicsRegion bounds = m_paintRegions.boundingRegion();
+        m_repaintAll = (bounds.endRow() > svp.endRow()) || (bounds.endColumn() > svp.endColumn());
     }
 
     if (m_repaintAll || m_initialRepaint) {
@@ -990,8 +999,12 @@ void QicsScreenGrid::paintEvent(QPaintEvent* ev)
         widgetPainter.drawRect(contentsRect());
         paintRegion(r, &widgetPainter);
     }
-        else
-        paintRegion(m_paintRegion, &widgetPainter, true);
+    else {
+        // repaint only the regions which changed, not their bounding region
+        const QVector<QicsRegion> &regions = m_paintRegions.regions();
+        for (int i = 0; i < regions.size(); ++i)
+            paintRegion(regions.at(i), &widgetPainter, true);
+    }
     widgetPainter.end();
 
     QPainter painter;
@@ -999,7 +1012,7 @@ void QicsScreenGrid::paintEvent(QPaintEvent* ev)
     painter.drawPixmap(r.topLeft(), m_imageBuffer, r);
     painter.end();
 
-    m_paintRegion = QicsRegion();
+    m_paintRegions.clear();
     m_repaintAll = false;
     m_initialRepaint = false;
     m_gridInPaintEvent = false;
@@ -1145,6 +1158,114 @@ QRect QicsScreenGrid::paintRegion(const QicsRegion &reg, QPainter *painter, bool
     return painted_rect;
 }
 
+bool QicsScreenGrid::canScrollImageBuffer(Qics::QicsIndexType type) const
+{
+    // the buffer must hold exactly what is on the screen
+    if (m_repaintAll || m_initialRepaint || !isVisible())
+        return false;
+
+    if (gridInfo().gridRepaintBehavior() != Qics::RepaintOn)
+        return false;
+
+    if (myNeedsRecomputeCellsFlag != Qics::NoIndex)
+        return false;
+
+    // overflowing cells are repainted across the whole row anyway, and
+    // right-to-left columns are laid out from the right edge
+    if (type == Qics::ColumnIndex &&
+            (isRightToLeft() || m_mainGrid->cellOverflowBehavior() == Qics::Overflow))
+        return false;
+
+    // cell widgets and the editor are only moved when their cells are drawn
+    const QObjectList &kids = children();
+    for (int i = 0; i < kids.size(); ++i) {
+        QWidget *w = qobject_cast<QWidget *>(kids.at(i));
+        if (w && w->isVisibleTo(this))
+            return false;
+    }
+
+    return true;
+}
+
+bool QicsScreenGrid::scrollImageBuffer(Qics::QicsIndexType type, const QicsPositionList &old_positions,
+                                       int old_first, int old_last)
+{
+    const bool rows = (type == Qics::RowIndex);
+    const QicsPositionList &positions = rows ? myRowPositions : myColumnPositions;
+    const int new_first = rows ? m_topRow : m_leftColumn;
+    const int new_last = rows ? m_bottomRow : m_rightColumn;
+
+    if (new_first < 0 || old_first < 0 || new_first == old_first)
+        return false;
+
+    // a cell which is visible both before and after the change
+    // tells how far the contents moved
+    const int anchor = qMax(new_first, old_first);
+    if (anchor > qMin(old_last, new_last))
+        return false;
+
+    const int delta = positions.at(anchor) - old_positions.at(anchor);
+
+    // only the cells move, the frame and the first grid line stay put
+    const QRect cr = contentsRect();
+    const int start = positions.at(new_first);
+    const QRect area = rows ?
+        QRect(cr.left(), start, cr.width(), cr.bottom() - start + 1) :
+        QRect(start, cr.top(), cr.right() - start + 1, cr.height());
+
+    const int extent = rows ? area.height() : area.width();
+    if (delta == 0 || qAbs(delta) >= extent)
+        return false;
+
+    if (rows)
+        m_imageBuffer.scroll(0, delta, area);
+    else
+        m_imageBuffer.scroll(delta, 0, area);
+
+    // Find the cells in the exposed strip, plus the one before it
+    // so that the grid line between them is redrawn.
+    QicsRegion exposed;
+    if (rows) {
+        int first = m_topRow, last = m_bottomRow;
+        if (delta < 0)
+            first = rowAt(area.bottom() + delta + 1, true);
+        else
+            last = rowAt(area.top() + delta - 1, true);
+
+        const int prev = gridInfo().lastNonHiddenRow(m_topRow, first - 1);
+        if (prev >= 0)
+            first = prev;
+        const int next = gridInfo().firstNonHiddenRow(last + 1, m_bottomRow);
+        if (next >= 0)
+            last = next;
+
+        exposed = QicsRegion(first, m_leftColumn, last, m_rightColumn);
+    }
+    else {
+        int first = m_leftColumn, last = m_rightColumn;
+        if (delta < 0)
+            first = columnAt(area.right() + delta + 1, true);
+        else
+            last = columnAt(area.left() + delta - 1, true);
+
+        const int prev = gridInfo().lastNonHiddenColumn(m_leftColumn, first - 1);
+        if (prev >= 0)
+            first = prev;
+        const int next = gridInfo().firstNonHiddenColumn(last + 1, m_rightColumn);
+        if (next >= 0)
+            last = next;
+
+        exposed = QicsRegion(m_topRow, first, m_bottomRow, last);
+    }
+
+    // computing the new positions asked for a full repaint
+    m_initialRepaint = false;
+    myLastResizeLinePosition = -1;
+    redraw(exposed);
+
+    return true;
+}
+
 void QicsScreenGrid::clearUnusedRect(QPainter *painter)
 {
     QRect buffer_rect(m_imageBuffer.rect());
@@ -2317,15 +2438,19 @@ void QicsScreenGrid::makeCellFullyVisible(int row, int col)
         while (cur_row <= real_vp.endRow()) {
             m_row->setRowIndex(cur_row);
 
-            if (!m_row->isHidden()) {
-                int rh = mappedDM().rowHeight(cur_row) + m_mainGrid->horizontalGridLineWidth()
-                    + m_mainGrid->horizontalShadeLineWidth();
+            if (m_row->isHidden()) {
+                // jump over the whole run of hidden rows
+                cur_row = hiddenRunEnd(Qics::RowIndex, cur_row, real_vp.endRow());
+                continue;
+            }
 
-                if ((h + rh) > contentsRect().height())
-                    break;
+            int rh = mappedDM().rowHeight(cur_row) + m_mainGrid->horizontalGridLineWidth()
+                + m_mainGrid->horizontalShadeLineWidth();
 
-                h += rh;
-            }
+            if ((h + rh) > contentsRect().height())
+                break;
+
+            h += rh;
 
             ++cur_row;
         }
@@ -2351,15 +2476,19 @@ void QicsScreenGrid::makeCellFullyVisible(int row, int col)
             while (cur_row <= real_vp.endRow()) {
                 m_row->setRowIndex(cur_row);
 
-                if (!m_row->isHidden()) {
-                    int rh = mappedDM().rowHeight(cur_row) + m_mainGrid->horizontalGridLineWidth()
-                        + m_mainGrid->horizontalShadeLineWidth();
+                if (m_row->isHidden()) {
+                    // jump over the whole run of hidden rows
+                    cur_row = hiddenRunEnd(Qics::RowIndex, cur_row, real_vp.endRow());
+                    continue;
+                }
 
-                    if ((h + rh) > contentsRect().height())
-                        break;
+                int rh = mappedDM().rowHeight(cur_row) + m_mainGrid->horizontalGridLineWidth()
+                    + m_mainGrid->horizontalShadeLineWidth();
 
-                    h += rh;
-                }
+                if ((h + rh) > contentsRect().height())
+                    break;
+
+                h += rh;
 
                 ++cur_row;
             }
@@ -2392,15 +2521,19 @@ void QicsScreenGrid::makeCellFullyVisible(int row, int col)
         while (cur_col <= real_vp.endColumn()) {
             m_column->setColumnIndex(cur_col);
 
-            if (!m_column->isHidden()) {
-                int cw = mappedDM().columnWidth(cur_col) + m_mainGrid->verticalGridLineWidth()
-                    + m_mainGrid->verticalShadeLineWidth();
+            if (m_column->isHidden()) {
+                // jump over the whole run of hidden columns
+                cur_col = hiddenRunEnd(Qics::ColumnIndex, cur_col, real_vp.endColumn());
+                continue;
+            }
 
-                if ((w + cw) > contentsRect().width() )
-                    break;
+            int cw = mappedDM().columnWidth(cur_col) + m_mainGrid->verticalGridLineWidth()
+                + m_mainGrid->verticalShadeLineWidth();
 
-                w += cw;
-            }
+            if ((w + cw) > contentsRect().width() )
+                break;
+
+            w += cw;
 
             ++cur_col;
         }
@@ -2421,15 +2554,19 @@ void QicsScreenGrid::makeCellFullyVisible(int row, int col)
             while (cur_col <= real_vp.endColumn()) {
                 m_column->setColumnIndex(cur_col);
 
-                if (!m_column->isHidden()) {
-                    int cw = mappedDM().columnWidth(cur_col) + m_mainGrid->verticalGridLineWidth()
-                        + m_mainGrid->verticalShadeLineWidth();
+                if (m_column->isHidden()) {
+                    // jump over the whole run of hidden columns
+                    cur_col = hiddenRunEnd(Qics::ColumnIndex, cur_col, real_vp.endColumn());
+                    continue;
+                }
 
-                    if ((w + cw) > contentsRect().width())
-                        break;
+                int cw = mappedDM().columnWidth(cur_col) + m_mainGrid->verticalGridLineWidth()
+                    + m_mainGrid->verticalShadeLineWidth();
 
-                    w += cw;
-                }
+                if ((w + cw) > contentsRect().width())
+                    break;
+
+                w += cw;
 
                 ++cur_col;
             }
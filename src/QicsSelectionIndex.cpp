@@ -0,0 +1,169 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#include "QicsSelectionIndex.h"
+
+#include <algorithm>
+#include <limits.h>
+
+
+QicsSelectionIndex::QicsSelectionIndex()
+{
+}
+
+void QicsSelectionIndex::clear()
+{
+    myRows.clear();
+    myColumns.clear();
+    myFullRows.clear();
+    myFullColumns.clear();
+    myBandStarts.clear();
+    myBandColumns.clear();
+}
+
+void QicsSelectionIndex::build(const QVector<QicsSelection> &list)
+{
+    clear();
+
+    QVector<int> partial;
+
+    for (int i = 0; i < list.size(); ++i) {
+        const QicsSelection &sel = list.at(i);
+
+        const int top = sel.topRow(), bottom = sel.bottomRow();
+        const int left = sel.leftColumn(), right = sel.rightColumn();
+
+        if (bottom < top || right < left)
+            continue;
+
+        const Interval rows = { top, bottom };
+        const Interval cols = { left, right };
+
+        myRows.append(rows);
+        myColumns.append(cols);
+
+        const bool full_row = (left == 0 && right == Qics::QicsLAST_COLUMN);
+        const bool full_col = (top == 0 && bottom == Qics::QicsLAST_ROW);
+
+        if (full_row)
+            myFullRows.append(rows);
+        if (full_col)
+            myFullColumns.append(cols);
+        if (!full_row && !full_col)
+            partial.append(i);
+    }
+
+    mergeIntervals(myRows);
+    mergeIntervals(myColumns);
+    mergeIntervals(myFullRows);
+    mergeIntervals(myFullColumns);
+
+    if (partial.isEmpty())
+        return;
+
+    // A new band starts wherever a selection starts or ends.
+    for (int i = 0; i < partial.size(); ++i) {
+        const QicsSelection &sel = list.at(partial.at(i));
+        myBandStarts.append(sel.topRow());
+        if (sel.bottomRow() < INT_MAX)
+            myBandStarts.append(sel.bottomRow() + 1);
+    }
+
+    std::sort(myBandStarts.begin(), myBandStarts.end());
+    myBandStarts.erase(std::unique(myBandStarts.begin(), myBandStarts.end()),
+        myBandStarts.end());
+
+    myBandColumns.resize(myBandStarts.size());
+
+    for (int i = 0; i < partial.size(); ++i) {
+        const QicsSelection &sel = list.at(partial.at(i));
+        const Interval cols = { sel.leftColumn(), sel.rightColumn() };
+
+        const int first = std::lower_bound(myBandStarts.constBegin(),
+            myBandStarts.constEnd(), sel.topRow()) - myBandStarts.constBegin();
+
+        for (int b = first; b < myBandStarts.size() && myBandStarts.at(b) <= sel.bottomRow(); ++b)
+            myBandColumns[b].append(cols);
+    }
+
+    for (int b = 0; b < myBandColumns.size(); ++b)
+        mergeIntervals(myBandColumns[b]);
+}
+
+bool QicsSelectionIndex::isCellSelected(int row, int col) const
+{
+    if (row < 0 || col < 0)
+        return false;
+
+    if (covers(myFullRows, row) || covers(myFullColumns, col))
+        return true;
+
+    // the band holding row is the last one starting at or before it
+    QVector<int>::const_iterator it = std::upper_bound(myBandStarts.constBegin(),
+        myBandStarts.constEnd(), row);
+    if (it == myBandStarts.constBegin())
+        return false;
+
+    return covers(myBandColumns.at(it - myBandStarts.constBegin() - 1), col);
+}
+
+bool QicsSelectionIndex::isRowSelected(int row, bool complete) const
+{
+    return covers(complete ? myFullRows : myRows, row);
+}
+
+bool QicsSelectionIndex::isColumnSelected(int col, bool complete) const
+{
+    return covers(complete ? myFullColumns : myColumns, col);
+}
+
+bool QicsSelectionIndex::intervalLessThan(const Interval &a, const Interval &b)
+{
+    return (a.first < b.first);
+}
+
+void QicsSelectionIndex::mergeIntervals(IntervalList &list)
+{
+    if (list.size() < 2)
+        return;
+
+    std::sort(list.begin(), list.end(), intervalLessThan);
+
+    // join intervals which overlap or touch
+    int out = 0;
+    for (int i = 1; i < list.size(); ++i) {
+        const Interval &next = list.at(i);
+        Interval &cur = list[out];
+
+        if (qint64(next.first) <= qint64(cur.last) + 1)
+            cur.last = qMax(cur.last, next.last);
+        else
+            list[++out] = next;
+    }
+
+    list.resize(out + 1);
+}
+
+bool QicsSelectionIndex::covers(const IntervalList &list, int index)
+{
+    // find the first interval which does not end before index
+    int lo = 0, hi = list.size();
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (list.at(mid).last < index)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return (lo < list.size() && list.at(lo).first <= index);
+}
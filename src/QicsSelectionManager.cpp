@@ -12,6 +12,8 @@
 
 #include "QicsSelectionManager.h"
 
+#include <QHash>
+#include <algorithm>
 #include "QicsTable.h"
 #include "QicsStyleManager.h"
 
@@ -308,8 +310,10 @@ QicsSelectionManager::QicsSelectionManager(QObject *parent)
         myStyleManager(0),
         myDataModel(0),
         mySelectionList(0),
+        mySelectionIndexValid(false),
         mySelectionActionList(0),
-        mySelectionPolicy(SelectMultiple)
+        mySelectionPolicy(SelectMultiple),
+        myMarkSelectionInStyles(false)
 {
 }
 
@@ -355,8 +359,11 @@ bool QicsSelectionManager::canSelectMultiple() const
 
 QicsSelectionList *QicsSelectionManager::selectionList(bool nocopy) const
 {
-    if (nocopy)
+    if (nocopy) {
+        // the caller may change the list through this pointer
+        invalidateSelectionIndex();
         return const_cast<QicsSelectionList*>( &mySelectionList );
+    }
 
     return new QicsSelectionList(mySelectionList);
 }
@@ -559,6 +566,40 @@ const QicsSelection* QicsSelectionManager::currentSelection() const
     return 0;
 }
 
+const QicsSelectionIndex &QicsSelectionManager::selectionIndex() const
+{
+    if (!mySelectionIndexValid) {
+        mySelectionIndex.build(mySelectionList);
+        mySelectionIndexValid = true;
+    }
+
+    return mySelectionIndex;
+}
+
+bool QicsSelectionManager::isCellSelected(int row, int col) const
+{
+    if (mySelectionList.isEmpty())
+        return false;
+
+    return selectionIndex().isCellSelected(row, col);
+}
+
+bool QicsSelectionManager::isRowSelected(int row, bool complete) const
+{
+    if (mySelectionList.isEmpty())
+        return false;
+
+    return selectionIndex().isRowSelected(row, complete);
+}
+
+bool QicsSelectionManager::isColumnSelected(int col, bool complete) const
+{
+    if (mySelectionList.isEmpty())
+        return false;
+
+    return selectionIndex().isColumnSelected(col, complete);
+}
+
 
 void QicsSelectionManager::beginSelection(int begin_row, int begin_col,
                                           int end_row, int end_col)
@@ -717,6 +758,7 @@ void QicsSelectionManager::extendSelection(int begin_row, int begin_col,
 
     // Update the selection with the new end cell
     sel.setEndCell(end_row, end_col);
+    invalidateSelectionIndex();
 }
 
 void QicsSelectionManager::addSelection(int begin_row, int begin_col,
@@ -729,24 +771,18 @@ void QicsSelectionManager::addSelection(int begin_row, int begin_col,
             return;
     }
 
+    // the styles only hold the selection if markSelectionInStyles is set
     bool set;
     if ((begin_col == 0) && (end_col == Qics::QicsLAST_COLUMN)) {
         // This means that we are selecting the entire row
-        set = (* static_cast<bool *>
-            (myStyleManager->getRowProperty(myGridInfo->modelRowIndex(begin_row),
-            QicsCellStyle::Selected)));
+        set = isRowSelected(begin_row);
     }
     else if ((begin_row == 0) && (end_row == Qics::QicsLAST_ROW)) {
         // This means that we are selecting the entire column
-        set = (* static_cast<bool *>
-            (myStyleManager->getColumnProperty(myGridInfo->modelColumnIndex(begin_col),
-            QicsCellStyle::Selected)));
+        set = isColumnSelected(begin_col);
     }
     else
-        set = (* static_cast<bool *>
-        (myStyleManager->getCellProperty(myGridInfo->modelRowIndex(begin_row),
-        myGridInfo->modelColumnIndex(begin_col),
-        QicsCellStyle::Selected)));
+        set = isCellSelected(begin_row, begin_col);
 
     myCurrentDragAction = (set ? QicsSelectFalseRevert : QicsSelectTrueRevert);
     myCurrentSelection.setSelected(!set);
@@ -798,6 +834,7 @@ void QicsSelectionManager::deleteSelection()
         }
 
         mySelectionList.clear();
+        invalidateSelectionIndex();
     }
 
     if (myCurrentSelection.isValid()) {
@@ -844,7 +881,9 @@ void QicsSelectionManager::replaceSelection(int begin_row, int begin_col, int en
 
     // set new selection
     QicsSelection sl(current->anchorRow(), current->anchorColumn(), begin_row, begin_col, end_row, end_col);
-    validateSelection(*current = sl);
+    *current = sl;
+    invalidateSelectionIndex();
+    validateSelection(*current);
 }
 
 void QicsSelectionManager::addToSelectionList(const QicsSelection &sel)
@@ -936,6 +975,8 @@ void QicsSelectionManager::addToSelectionList(const QicsSelection &sel)
         // replace the selected list
         mySelectionList = *newlist;
     }
+
+    invalidateSelectionIndex();
 }
 
 static QicsSelection invalidSelection;
@@ -1009,54 +1050,65 @@ void QicsSelectionManager::setSelectionProperty(int begin_row, int begin_col,
     if (lastRow == Qics::QicsLAST_ROW) lastRow = 0;
     if (lastCol == Qics::QicsLAST_COLUMN) lastCol = 0;
 
-    // Turn off the property change signal so the grids don't redraw each time
-    // through the loop.
-    myStyleManager->setReportChanges(false);
+    const bool entire_rows = ((begin_col == 0) && (end_col == QicsLAST_COLUMN));
+    const bool entire_columns = ((begin_row == 0) && (end_row == QicsLAST_ROW));
 
-    bool skip_rest_of_rows = false;
-    for (i = begin_row; (i <= end_row) && (i <= lastRow) && !skip_rest_of_rows; ++i) {
-        if ((begin_col == 0) && (end_col == QicsLAST_COLUMN)) {
-            // This means that we are selecting the entire row
+    // The selection itself is kept in the selection list.  Rows and
+    // columns are only visited to emit rowSelected()/columnSelected()
+    // or to mark them in the style managers, so that selecting all of
+    // a large table costs nothing if neither is wanted.
+    const bool visit_rows = entire_rows &&
+        (myMarkSelectionInStyles || receivers(SIGNAL(rowSelected(int,bool))) > 0);
+    const bool visit_columns = !entire_rows && entire_columns &&
+        (myMarkSelectionInStyles || receivers(SIGNAL(columnSelected(int,bool))) > 0);
 
-            setRowSelectionProperty(*myGridInfo, i, sel, myStyleManager);
+    if (visit_rows || visit_columns) {
+        // Turn off the property change signal so the grids don't redraw
+        // each time through the loop.
+        myStyleManager->setReportChanges(false);
 
-            QicsHeaderGridPV::const_iterator iter, iter_end(myHeaderList.constEnd());
+        if (visit_rows) {
+            for (i = begin_row; (i <= end_row) && (i <= lastRow); ++i) {
+                setRowSelectionProperty(*myGridInfo, i, sel, myStyleManager);
 
-            for (iter = myHeaderList.constBegin(); iter != iter_end; ++iter) {
-                const QicsHeaderGrid *hdr = *iter;
+                if (!myMarkSelectionInStyles)
+                    continue;
 
-                if (hdr->type() == RowHeader) {
-                    QicsGridInfo &gi = hdr->gridInfo();
-                    setRowSelectionProperty(gi, i, sel, gi.styleManager());
+                QicsHeaderGridPV::const_iterator iter, iter_end(myHeaderList.constEnd());
+
+                for (iter = myHeaderList.constBegin(); iter != iter_end; ++iter) {
+                    const QicsHeaderGrid *hdr = *iter;
+
+                    if (hdr->type() == RowHeader) {
+                        QicsGridInfo &gi = hdr->gridInfo();
+                        setRowSelectionProperty(gi, i, sel, gi.styleManager());
+                    }
                 }
             }
         }
         else {
             for (j = begin_col; (j <= end_col) && (j <= lastCol); ++j) {
-                if ((begin_row == 0) && (end_row == QicsLAST_ROW)) {
-                    // This means that we are selecting the entire column
-                    skip_rest_of_rows = true;
+                setColumnSelectionProperty(*myGridInfo, j, sel, myStyleManager);
 
-                    setColumnSelectionProperty(*myGridInfo, j, sel, myStyleManager);
+                if (!myMarkSelectionInStyles)
+                    continue;
 
-                    QicsHeaderGridPV::const_iterator iter, iter_end(myHeaderList.constEnd());
+                QicsHeaderGridPV::const_iterator iter, iter_end(myHeaderList.constEnd());
 
-                    for (iter = myHeaderList.constBegin(); iter != iter_end; ++iter){
-                        const QicsHeaderGrid *hdr = *iter;
+                for (iter = myHeaderList.constBegin(); iter != iter_end; ++iter){
+                    const QicsHeaderGrid *hdr = *iter;
 
-                        // int modelCol = hdr->gridInfo().modelColumnIndex(j);
-                        if (hdr->type() == ColumnHeader)
-                            setColumnSelectionProperty(hdr->gridInfo(),
-                            j, sel,
-                            hdr->gridInfo().styleManager());
-                    }
+                    if (hdr->type() == ColumnHeader)
+                        setColumnSelectionProperty(hdr->gridInfo(),
+                        j, sel,
+                        hdr->gridInfo().styleManager());
                 }
             }
         }
-    }
 
-    // Now we can turn style manager reporting back on
-    myStyleManager->setReportChanges(true);
+        // Now we can turn style manager reporting back on
+        myStyleManager->setReportChanges(true);
+    }
 
     // Update the affected region
     QicsRegion region(begin_row, begin_col, end_row, end_col);
@@ -1083,7 +1135,7 @@ void QicsSelectionManager::setRowSelectionProperty(QicsGridInfo &info, int row,
         set = false;
         break;
     default: {
-            bool cur = mySelectionList.isRowSelected(mrow);
+            bool cur = isRowSelected(mrow);
 
             if (sel == QicsSelectTrueRevert) {
                 if (!cur)
@@ -1100,22 +1152,24 @@ void QicsSelectionManager::setRowSelectionProperty(QicsGridInfo &info, int row,
         }
     }
 
-    if (set) {
-        bool val = true;
-        sm->setRowProperty(mrow, false, QicsCellStyle::Selected,
-            static_cast<void *> (&val), false);
-    }
-    else {
-        // This is an optimization.  Many times, the only property set on
-        // a row will be QicsSelected, just because it was selected at one
-        // time.  In order to possibly save space, we CLEAR the property
-        // if it is unselected.  The style manager may remove the row's
-        // style altogether if QicsSelected was the only thing set.
+    if (myMarkSelectionInStyles) {
+        if (set) {
+            bool val = true;
+            sm->setRowProperty(mrow, false, QicsCellStyle::Selected,
+                static_cast<void *> (&val), false);
+        }
+        else {
+            // This is an optimization.  Many times, the only property set on
+            // a row will be QicsSelected, just because it was selected at one
+            // time.  In order to possibly save space, we CLEAR the property
+            // if it is unselected.  The style manager may remove the row's
+            // style altogether if QicsSelected was the only thing set.
 
-        // NOTE: This will break if the default value of QicsSelected is
-        //       not false!!!!
+            // NOTE: This will break if the default value of QicsSelected is
+            //       not false!!!!
 
-        sm->clearRowProperty(mrow, false, QicsCellStyle::Selected);
+            sm->clearRowProperty(mrow, false, QicsCellStyle::Selected);
+        }
     }
 
     if (info.gridType() == Qics::TableGrid)
@@ -1138,7 +1192,7 @@ void QicsSelectionManager::setColumnSelectionProperty(QicsGridInfo &info, int co
         set = false;
         break;
     default: {
-            bool cur = mySelectionList.isColumnSelected(mcol);
+            bool cur = isColumnSelected(mcol);
 
             if (sel == QicsSelectTrueRevert) {
                 if (!cur)
@@ -1155,22 +1209,24 @@ void QicsSelectionManager::setColumnSelectionProperty(QicsGridInfo &info, int co
         }
     }
 
-    if (set) {
-        bool val = true;
-        sm->setColumnProperty(mcol, false, QicsCellStyle::Selected,
-            static_cast<void *> (&val), false);
-    }
-    else {
-        // This is an optimization.  Many times, the only property set on
-        // a column will be QicsSelected, just because it was selected at one
-        // time.  In order to possibly save space, we CLEAR the property
-        // if it is unselected.  The style manager may remove the column's
-        // style altogether if QicsSelected was the only thing set.
+    if (myMarkSelectionInStyles) {
+        if (set) {
+            bool val = true;
+            sm->setColumnProperty(mcol, false, QicsCellStyle::Selected,
+                static_cast<void *> (&val), false);
+        }
+        else {
+            // This is an optimization.  Many times, the only property set on
+            // a column will be QicsSelected, just because it was selected at one
+            // time.  In order to possibly save space, we CLEAR the property
+            // if it is unselected.  The style manager may remove the column's
+            // style altogether if QicsSelected was the only thing set.
 
-        // NOTE: This will break if the default value of QicsSelected is
-        //       not false!!!!
+            // NOTE: This will break if the default value of QicsSelected is
+            //       not false!!!!
 
-        sm->clearColumnProperty(mcol, false, QicsCellStyle::Selected);
+            sm->clearColumnProperty(mcol, false, QicsCellStyle::Selected);
+        }
     }
 
     if (info.gridType() == Qics::TableGrid)
@@ -1198,6 +1254,27 @@ void QicsSelectionManager::announceChanges(bool in_progress)
         emit selectionListChangedExternal(in_progress);
 }
 
+void QicsSelectionManager::itemMoved(Qics::QicsIndexType type, int from, int to)
+{
+    if (mySelectionList.isEmpty()) return;
+
+    QicsSorter *sorter = (type == RowIndex) ?
+        myGridInfo->rowOrdering() : myGridInfo->columnOrdering();
+    if (!sorter)
+        return;
+
+    // Selections are only remapped if there are any, so build
+    // the full map here rather than in the sorter.
+    const int size = sorter->currentOrder().size();
+    int *vismap = new int[size];
+    for (int i = 0; i < size; ++i)
+        vismap[i] = QicsSorter::movedIndex(i, from, to);
+
+    orderChanged(type, vismap, size);
+
+    delete[] vismap;
+}
+
 void QicsSelectionManager::orderChanged(Qics::QicsIndexType type, int* vismap, int size)
 {
 #if notdef
@@ -1220,125 +1297,92 @@ void QicsSelectionManager::orderChanged(Qics::QicsIndexType type, int* vismap, i
     if (!dm)
         return;
 
-    QicsSelectionList *toAdd = new QicsSelectionList(dataModel());
-
-    QicsSelectionList::iterator iter;
-    for (iter = mySelectionList.begin(); iter != mySelectionList.end();++iter) {
-        QicsSelection &sel = *iter;
+    // Selections which cover all of the reordered dimension, or lie
+    // outside of it, do not change.  The others are grouped by their
+    // extent in the other dimension.  The new positions of each group's
+    // rows (or columns) are then joined into maximal runs, so a block of
+    // selected rows stays a few selections however it is permuted, and
+    // selections which become adjacent are merged.
+    const int last_index = (type == RowIndex ? QicsLAST_ROW : QicsLAST_COLUMN);
+
+    QicsSelectionList newlist(dataModel());
+    QVector<QicsSelection> extents;
+    QVector<QVector<int> > positions;
+    QHash<quint64, int> group_of_extent;
+    bool dropped = false;
+
+    QicsSelectionList::const_iterator iter, iter_end(mySelectionList.constEnd());
+    for (iter = mySelectionList.constBegin(); iter != iter_end; ++iter) {
+        const QicsSelection &sel = *iter;
 
-        int top = sel.topRow();
-        int left = sel.leftColumn();
-        int bottom = sel.bottomRow();
-        int right = sel.rightColumn();
+        if (!sel.isValid()) {
+            dropped = true;
+            continue;
+        }
 
-        Q_ASSERT(top < size || left < size || bottom < size || right < size);
-        if (top >= size || left >= size || bottom >= size || right >= size)
-            return;
+        const bool rows = (type == RowIndex);
+        const int first = (rows ? sel.topRow() : sel.leftColumn());
+        const int end = (rows ? sel.bottomRow() : sel.rightColumn());
+        const int last = qMin(end, size - 1);
+        const int other_first = (rows ? sel.leftColumn() : sel.topRow());
+        const int other_last = (rows ? sel.rightColumn() : sel.bottomRow());
 
-        if ((left == 0) && (right == QicsLAST_COLUMN)) {
-            // row selection
-            if(type == RowIndex) {
-                sel.setStartRow(vismap[top]);
-                sel.setAnchorRow(vismap[top]);
-                sel.setEndRow(vismap[top]);
-                if(top != bottom){
-                    if (bottom >= dm->numRows())
-                        bottom = dm->numRows()-1;
-
-                    for(int r = top+1; r <= bottom; ++r) {
-                        toAdd->push_back(QicsSelection(vismap[r], left,
-                            vismap[r], right));
-                    }
-                }
-            }
-        }
-        else if ((top == 0) && (bottom == QicsLAST_ROW)) {
-            // column selection
-            if(type == ColumnIndex) {
-                sel.setStartColumn(vismap[left]);
-                sel.setAnchorColumn(vismap[left]);
-                sel.setEndColumn(vismap[left]);
-                if(left == right) {
-                    if (right >= dm->numColumns())
-                        right = dm->numColumns()-1;
-
-                    for(int c = left+1; c <= right; ++c) {
-                        toAdd->push_back(QicsSelection(top, vismap[c],
-                            bottom, vismap[c]));
-                    }
-                }
-            }
-        }
-        else if(top == bottom && left == right) {
-            // single cell - we can always adjust that
-            if(type == RowIndex) {
-                sel.setStartRow(vismap[top]);
-                sel.setAnchorRow(vismap[top]);
-                sel.setEndRow(vismap[top]);
-            } else {
-                sel.setStartColumn(vismap[left]);
-                sel.setAnchorColumn(vismap[left]);
-                sel.setEndColumn(vismap[left]);
-            }
-        }
-        else {
-            /* It is a region.  This gets tricky.
-            * One rule Chris and I thought of was.
-            * When sorting a set of rows (columns)
-            * Any cell or region that intersects the
-            * sorted set, but is not the entire set, gets
-            * tossed.  The others get mapped.
-            * But, how does that deal with moved rows.
-            */
-            if(type == RowIndex) {
-                sel.setStartRow(vismap[top]);
-                sel.setAnchorRow(vismap[top]);
-                sel.setEndRow(vismap[top]);
-                for(int r = top+1; r <= bottom; ++r) {
-                    toAdd->push_back(QicsSelection(vismap[r], left,
-                        vismap[r], right));
-                }
-            }
-            else {
-                sel.setStartColumn(vismap[left]);
-                sel.setAnchorColumn(vismap[left]);
-                sel.setEndColumn(vismap[left]);
-                for(int c = left+1; c <= right; ++c) {
-                    toAdd->push_back(QicsSelection(top, vismap[c],
-                        bottom, vismap[c]));
-                }
-            }
+        if ((first == 0 && end == last_index) || first < 0 || first > last) {
+            newlist.push_back(sel);
+            continue;
         }
-    }
 
-    iter = mySelectionList.begin();
-    bool ifSelListChanged = false;
-    while (iter != mySelectionList.end()) {
-        if (!iter->isValid()) {
-            iter = mySelectionList.erase(iter);
-            ifSelListChanged = true;
+        const quint64 key = (quint64(quint32(other_first)) << 32) | quint32(other_last);
+        QHash<quint64, int>::const_iterator git = group_of_extent.constFind(key);
+
+        int group;
+        if (git == group_of_extent.constEnd()) {
+            group = extents.size();
+            group_of_extent.insert(key, group);
+            extents.append(rows ?
+                QicsSelection(0, other_first, 0, other_last) :
+                QicsSelection(other_first, 0, other_last, 0));
+            positions.append(QVector<int>());
         }
         else
-            ++iter;
+            group = git.value();
+
+        QVector<int> &pos = positions[group];
+        for (int i = first; i <= last; ++i)
+            pos.append(vismap[i]);
     }
-    if (ifSelListChanged)
-        announceChanges(false);
 
-    // now we have the additions, splice them in
-#if notdef
-    qDebug("=== Additions list ==\n");
-    dumpList(toAdd);
-#endif
-    QicsSelectionList::const_iterator additer, additer_end(toAdd->constEnd());
-    for (additer = toAdd->constBegin(); additer != additer_end; ++additer) {
-        if (additer->isValid())
-            mySelectionList.push_back(*additer);
+    for (int g = 0; g < positions.size(); ++g) {
+        QVector<int> &pos = positions[g];
+        std::sort(pos.begin(), pos.end());
+
+        const QicsSelection &ext = extents.at(g);
+
+        int run_start = 0;
+        for (int i = 1; i <= pos.size(); ++i) {
+            // duplicates come from selections which overlapped
+            if (i < pos.size() && pos.at(i) <= pos.at(i - 1) + 1)
+                continue;
+
+            const int from = pos.at(run_start), to = pos.at(i - 1);
+            if (type == RowIndex)
+                newlist.push_back(QicsSelection(from, ext.leftColumn(), to, ext.rightColumn()));
+            else
+                newlist.push_back(QicsSelection(ext.topRow(), from, ext.bottomRow(), to));
+
+            run_start = i;
+        }
     }
-    delete toAdd;
+
+    mySelectionList = newlist;
+    invalidateSelectionIndex();
 
     delete mySelectionActionList;
     mySelectionActionList = 0;
 
+    if (dropped)
+        announceChanges(false);
+
 #if notdef
     qDebug("==== NEW LIST IS ==\n");
     dumpList(mySelectionList);
@@ -1351,6 +1395,8 @@ void QicsSelectionManager::deleteRows(int num, int start_position)
 
     if (mySelectionList.isEmpty()) return;
 
+    invalidateSelectionIndex();
+
     QicsSelectionList::iterator it;
     for ( it = mySelectionList.begin(); it != mySelectionList.end(); ++it ) {
         QicsSelection &sel = *it;
@@ -1379,6 +1425,8 @@ void QicsSelectionManager::deleteColumns(int num, int start_position)
 
     if (mySelectionList.isEmpty()) return;
 
+    invalidateSelectionIndex();
+
     QicsSelectionList::iterator it;
     for ( it = mySelectionList.begin(); it != mySelectionList.end(); ++it ) {
         QicsSelection &sel = *it;
@@ -0,0 +1,134 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#include "QicsSortKeys.h"
+
+#include "QicsDataItem.h"
+
+
+QicsSortKeyColumn::QicsSortKeyColumn()
+    : myOrdFlip(1), mySensitivity(Qt::CaseSensitive)
+{
+}
+
+void QicsSortKeyColumn::reset(int size, Qics::QicsSortOrder order, Qt::CaseSensitivity cs)
+{
+    myKeys.fill(QicsSortKey(), size);
+    myStrings.fill(QString(), size);
+    myOrdFlip = (order == Qics::Ascending) ? 1 : -1;
+    mySensitivity = cs;
+}
+
+void QicsSortKeyColumn::setNull(int index)
+{
+    myKeys[index] = QicsSortKey();
+    myStrings[index] = QString();
+}
+
+void QicsSortKeyColumn::setNumber(int index, double d)
+{
+    QicsSortKey &key = myKeys[index];
+    key.kind = QicsSortKey::Number;
+    key.isInteger = false;
+    key.number = d;
+    myStrings[index] = QString();
+}
+
+void QicsSortKeyColumn::setInteger(int index, qint64 i)
+{
+    QicsSortKey &key = myKeys[index];
+    key.kind = QicsSortKey::Number;
+    key.isInteger = true;
+    key.integer = i;
+    myStrings[index] = QString();
+}
+
+void QicsSortKeyColumn::setString(int index, const QString &str)
+{
+    QString &s = myStrings[index];
+    s = str;
+    myKeys[index] = makeKey(s);
+}
+
+void QicsSortKeyColumn::setItem(int index, const QicsDataItem *item)
+{
+    myKeys[index] = makeKey(item, myStrings[index]);
+}
+
+QicsSortKey QicsSortKeyColumn::makeKey(const QicsDataItem *item, QString &str)
+{
+    QicsSortKey key;
+
+    if (!item) {
+        str = QString();
+        return key;
+    }
+
+    // Built-in numbers are taken as they are, the string round trip
+    // would only give the same value with less precision.
+    switch (item->type())
+    {
+    case QicsDataItem_Int:
+        key.kind = QicsSortKey::Number;
+        key.isInteger = true;
+        key.integer = static_cast<const QicsDataInt *>(item)->data();
+        str = QString();
+        return key;
+    case QicsDataItem_Long:
+        key.kind = QicsSortKey::Number;
+        key.isInteger = true;
+        key.integer = static_cast<const QicsDataLong *>(item)->data();
+        str = QString();
+        return key;
+    case QicsDataItem_LongLong:
+        key.kind = QicsSortKey::Number;
+        key.isInteger = true;
+        key.integer = static_cast<const QicsDataLongLong *>(item)->data();
+        str = QString();
+        return key;
+    case QicsDataItem_Float:
+    case QicsDataItem_Double:
+        key.kind = QicsSortKey::Number;
+        key.number = item->number();
+        str = QString();
+        return key;
+    default:
+        break;
+    }
+
+    str = item->string();
+    return makeKey(str);
+}
+
+QicsSortKey QicsSortKeyColumn::makeKey(QString &str)
+{
+    QicsSortKey key;
+
+    if (str.isEmpty()) {
+        key.kind = QicsSortKey::Empty;
+        str = QString();
+        return key;
+    }
+
+    bool ok;
+    const double d = str.toDouble(&ok);
+
+    if (ok) {
+        key.kind = QicsSortKey::Number;
+        key.number = d;
+        str = QString();
+    }
+    else
+        key.kind = QicsSortKey::String;
+
+    return key;
+}
@@ -13,107 +13,620 @@
 #include "QicsSorter.h"
 
 #include <QStringList>
+#include <QtEndian>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutex>
 #include "QicsDataModel.h"
 #include "QicsAbstractSorterDelegate.h"
+#include "QicsSortKeys.h"
 
 // Uncoment this line if you want provide integrity check
 //#define INTEGRITY_CHECK
 
 
-QicsSorter	*g_self;
-QVector<int> g_thingsToSort;
-QVector<int>::iterator  g_thingsToSortIter;
-// ### For 2.4.1 compatibility
-DataItemComparator g_compareFunc;
-int g_ordFlip;
+// Ranges smaller than this are not worth spreading over threads.
+#define QICS_PARALLEL_SORT_THRESHOLD 16384
 
+// Size of the runs a background sort works on between two checks
+// for cancellation, and the upper bound of their number.
+#define QICS_ASYNC_SORT_CHUNK 8192
+#define QICS_ASYNC_SORT_MAX_CHUNKS 1024
 
-int delegateCompare(const int &_a, const int &_b)
+/*
+* Interface of whoever watches a sort done in steps.  step() is called
+* after every finished step, from the thread that runs the sort, and
+* stops the sort by returning false.
+*/
+class QicsSortObserver
 {
-    const int thingToSort = (*g_thingsToSortIter);
+public:
+    virtual ~QicsSortObserver() {}
+    virtual bool step(int done, int total) = 0;
+};
 
-    ++g_thingsToSortIter;
+/*
+* QicsSortContext holds everything a single sort run needs to compare
+* two model indices.  Nothing is shared between runs, so several
+* sorters can sort at the same time.
+*
+* Comparisons use one of three sources:
+* - precomputed sort keys built by the sorter delegates,
+* - data items cloned once for a DataItemComparator,
+* - QicsAbstractSorterDelegate::compare() for delegates without keys.
+* Only the first two never touch the data model, so only they may be
+* used from several threads.
+*/
+class QicsSortContext
+{
+public:
+    QicsSortContext(Qics::QicsSortMode mode)
+        : myMode(mode), myCompare(CompareDelegates),
+            myModel(0), myType(Qics::RowIndex), myFunc(0), myOrdFlip(1)
+    {
+    }
 
-    QicsAbstractSorterDelegate *sorterDelegate = g_self->sorterDelegate(thingToSort);
-    QicsAbstractSorterDelegate *sorterDelegateDefault = g_self->defaultSorterDelegate();
+    ~QicsSortContext()
+    {
+        for (int i = 0; i < myItems.size(); ++i)
+            qDeleteAll(myItems.at(i));
+    }
 
-    if (!sorterDelegate)
-        sorterDelegate = sorterDelegateDefault;
-    else
-        sorterDelegate->setSortOrder(sorterDelegateDefault->sortOrder());
+    bool buildKeys(QicsSorter *sorter, const QVector<int> &rows_or_columns,
+        const QVector<int> &indices, int size, Qics::QicsSortOrder order);
+    void snapshotItems(const QicsDataModel *dm, Qics::QicsIndexType type,
+        const QVector<int> &rows_or_columns, const QVector<int> &indices,
+        int size, DataItemComparator func, int ordFlip);
+    void useDelegates(QicsSorter *sorter, const QVector<int> &rows_or_columns);
 
-    int retval = sorterDelegate->compare(_a, _b, thingToSort);
+    /*
+    * Returns true if compare() does not access the data model
+    * and may be called from any thread.
+    */
+    inline bool isReentrant() const { return (myCompare != CompareDelegates); }
 
-    if (retval == 0 && (g_thingsToSortIter < g_thingsToSort.end()))
-        return delegateCompare(_a, _b);
+    /*
+    * Returns true if the context compares by any of the
+    * rows or columns \a first to \a last.
+    */
+    bool sortsBy(int first, int last) const;
 
-    g_thingsToSortIter = g_thingsToSort.begin();
+    /*
+    * Takes the values of the model indices \a indices from the data
+    * model again.  Must be called on the thread of the data model.
+    */
+    void update(const QVector<int> &indices);
+
+    inline int compare(int a, int b) const
+    {
+        const int count = myThingsToSort.size();
+        for (int i = 0; i < count; ++i) {
+            int retval;
+
+            switch (myCompare)
+            {
+            case CompareKeys:
+                retval = myKeys.at(i).compare(a, b);
+                break;
+            case CompareItems:
+                retval = compareItems(myItems.at(i).at(a), myItems.at(i).at(b));
+                break;
+            default:
+                retval = myDelegates.at(i)->compare(a, b, myThingsToSort.at(i));
+                break;
+            }
+
+            if (retval != 0)
+                return retval;
+        }
+        return 0;
+    }
 
-    return retval;
-}
+    inline bool lessThan(int a, int b) const { return (compare(a, b) < 0); }
+
+    /*
+    * Returns true if [begin, end) is in order already.
+    */
+    bool isSorted(const int *begin, const int *end) const;
+
+    /*
+    * Sorts [begin, end) with the sort mode of the context,
+    * unless it is in order already.
+    */
+    void sort(int *begin, int *end) const;
+
+    /*
+    * Stable sort of [begin, end) in small steps reported to \a observer.
+    * Returns false if the observer cancelled the sort; the range is
+    * left in an unspecified order then.  The context must be reentrant.
+    */
+    bool sortInSteps(int *begin, int *end, QicsSortObserver *observer) const;
+
+private:
+    inline int compareItems(const QicsDataItem *a, const QicsDataItem *b) const
+    {
+        // sometimes the cells are null
+        if (a == 0)
+            return (b == 0) ? 0 : myOrdFlip;
+        if (b == 0)
+            return -myOrdFlip;
+        return myOrdFlip * myFunc(a, b);
+    }
+
+    void parallelSort(int *begin, int *end) const;
+    bool mergeSort(int *begin, int *end, int chunks, QThreadPool *pool,
+        QicsSortObserver *observer) const;
 
-int functionCompare(const int &_a, const int &_b, const QicsDataModel *dm)
+    enum CompareSource { CompareKeys, CompareItems, CompareDelegates };
+
+    Qics::QicsSortMode myMode;
+    CompareSource myCompare;
+    QVector<int> myThingsToSort;
+
+    QVector<QicsSortKeyColumn> myKeys;
+
+    QVector<QVector<const QicsDataItem *> > myItems;
+    const QicsDataModel *myModel;
+    Qics::QicsIndexType myType;
+    DataItemComparator myFunc;
+    int myOrdFlip;
+
+    QVector<QicsAbstractSorterDelegate *> myDelegates;
+};
+
+// LessThan functor for the Qt sort algorithms.
+class QicsSortContextLessThan
 {
-    const QicsDataItem *a = 0;
-    const QicsDataItem *b = 0;
+public:
+    QicsSortContextLessThan(const QicsSortContext *context)
+        : myContext(context)
+    {
+    }
 
-    int retval = 0;
-    int thingToSort = (*g_thingsToSortIter);
+    inline bool operator()(int a, int b) const
+    { return myContext->lessThan(a, b); }
 
-    ++g_thingsToSortIter;
+private:
+    const QicsSortContext *myContext;
+};
 
-    if (g_self->type() == Qics::RowIndex) {
-        a = dm->item(_a, thingToSort);
-        b = dm->item(_b, thingToSort);
+// Stable sort of one chunk of a parallel sort.
+class QicsSortChunkTask : public QRunnable
+{
+public:
+    QicsSortChunkTask(const QicsSortContext *context, int *begin, int *end)
+        : myContext(context), myBegin(begin), myEnd(end)
+    {
     }
-    else {
-        a = dm->item(thingToSort, _a);
-        b = dm->item(thingToSort, _b);
+
+    void run()
+    {
+        qStableSort(myBegin, myEnd, QicsSortContextLessThan(myContext));
     }
-    if (a) a = a->clone();
-    if (b) b = b->clone();
 
-    // sometimes the cells are null
-    if (a == 0) {
-        if (b == 0)
-            retval = 0;
-        else
-            retval = g_ordFlip;
+private:
+    const QicsSortContext *myContext;
+    int *myBegin;
+    int *myEnd;
+};
+
+// Merges the sorted runs src[first, middle) and src[middle, last) into
+// dst[first, last).  Ties are taken from the first run to stay stable.
+class QicsSortMergeTask : public QRunnable
+{
+public:
+    QicsSortMergeTask(const QicsSortContext *context, const int *src, int *dst,
+                      int first, int middle, int last)
+        : myContext(context), mySrc(src), myDst(dst),
+            myFirst(first), myMiddle(middle), myLast(last)
+    {
     }
-    else if (b == 0)
-        retval = g_ordFlip * -1;
-    else
-        retval = g_ordFlip * g_compareFunc(a, b);
 
-    delete a;
-    delete b;
+    void run()
+    {
+        const int *a = mySrc + myFirst;
+        const int *a_end = mySrc + myMiddle;
+        const int *b = a_end;
+        const int *b_end = mySrc + myLast;
+        int *out = myDst + myFirst;
+
+        while (a != a_end && b != b_end) {
+            if (myContext->lessThan(*b, *a))
+                *out++ = *b++;
+            else
+                *out++ = *a++;
+        }
+
+        while (a != a_end)
+            *out++ = *a++;
+        while (b != b_end)
+            *out++ = *b++;
+    }
 
-    if (retval == 0 && (g_thingsToSortIter < g_thingsToSort.end()))
-        return functionCompare(_a, _b, dm);
+private:
+    const QicsSortContext *myContext;
+    const int *mySrc;
+    int *myDst;
+    int myFirst;
+    int myMiddle;
+    int myLast;
+};
+
+/*
+* QicsSortJob sorts a snapshot of a sorter's order on a worker thread.
+* It owns its sort context, so it never touches the data model.  The
+* sorter is told about progress and the end of the sort by queued calls;
+* cancel() detaches the job from the sorter, after which it finishes
+* silently.  The job deletes itself when its thread has finished.
+*/
+class QicsSortJob : public QThread, public QicsSortObserver
+{
+public:
+    QicsSortJob(QicsSorter *sorter, QicsSortContext *context, int serial,
+                const QVector<int> &order, int from, int to)
+        : mySorter(sorter), myContext(context), mySerial(serial),
+            myOrder(order), myRange(order.mid(from, to - from + 1)),
+            myFrom(from), myPercent(-1)
+    {
+        connect(this, SIGNAL(finished()), this, SLOT(deleteLater()));
+    }
 
-    g_thingsToSortIter = g_thingsToSort.begin();
-    return retval;
+    ~QicsSortJob()
+    {
+        delete myContext;
+    }
+
+    void cancel()
+    {
+        QMutexLocker locker(&myMutex);
+        mySorter = 0;
+    }
+
+    inline int serial() const { return mySerial; }
+
+    /* hands the sort context over to the caller, once the job is done */
+    QicsSortContext *takeContext()
+    {
+        QicsSortContext *context = myContext;
+        myContext = 0;
+        return context;
+    }
+
+    /* the order the job was started from */
+    inline const QVector<int> &order() const { return myOrder; }
+
+    /* the sorted range, valid once the sorter was told the job is done */
+    inline const QVector<int> &range() const { return myRange; }
+    inline int from() const { return myFrom; }
+
+    bool step(int done, int total)
+    {
+        QMutexLocker locker(&myMutex);
+        if (!mySorter)
+            return false;
+
+        const int percent = (total > 0) ? int(qint64(done) * 100 / total) : 100;
+        if (percent != myPercent) {
+            myPercent = percent;
+            QMetaObject::invokeMethod(mySorter, "handleSortProgress", Qt::QueuedConnection,
+                Q_ARG(int, mySerial), Q_ARG(int, percent));
+        }
+        return true;
+    }
+
+protected:
+    void run()
+    {
+        int *data = myRange.data();
+        const bool done = myContext->sortInSteps(data, data + myRange.size(), this);
+
+        QMutexLocker locker(&myMutex);
+        if (done && mySorter)
+            QMetaObject::invokeMethod(mySorter, "handleSortDone", Qt::QueuedConnection,
+                Q_ARG(int, mySerial));
+    }
+
+private:
+    QMutex myMutex;
+    QicsSorter *mySorter;
+    QicsSortContext *myContext;
+    const int mySerial;
+    const QVector<int> myOrder;
+    QVector<int> myRange;
+    const int myFrom;
+    int myPercent;
+};
+
+bool QicsSortContext::buildKeys(QicsSorter *sorter, const QVector<int> &rows_or_columns,
+                                const QVector<int> &indices, int size,
+                                Qics::QicsSortOrder order)
+{
+    const int count = rows_or_columns.size();
+    QicsAbstractSorterDelegate *sorterDelegateDefault = sorter->defaultSorterDelegate();
+
+    myKeys.resize(count);
+    myDelegates.resize(count);
+
+    for (int i = 0; i < count; ++i) {
+        const int thingToSort = rows_or_columns.at(i);
+
+        QicsAbstractSorterDelegate *sorterDelegate = sorter->sorterDelegate(thingToSort);
+        if (!sorterDelegate)
+            sorterDelegate = sorterDelegateDefault;
+
+        myKeys[i].reset(size, order, sorterDelegate->sortingSensitivity());
+        myDelegates[i] = sorterDelegate;
+
+        // delegates without keys have to be compared item by item
+        if (!sorterDelegate->buildSortKeys(indices, thingToSort, myKeys[i])) {
+            myKeys.clear();
+            myDelegates.clear();
+            return false;
+        }
+    }
+
+    myThingsToSort = rows_or_columns;
+    myCompare = CompareKeys;
+    return true;
 }
 
-bool delegateLessThan(const int &_a, const int &_b)
+void QicsSortContext::snapshotItems(const QicsDataModel *dm, Qics::QicsIndexType type,
+                                    const QVector<int> &rows_or_columns,
+                                    const QVector<int> &indices, int size,
+                                    DataItemComparator func, int ordFlip)
 {
-    return (delegateCompare(_a, _b) < 0);
+    // Clone every item once, instead of twice per comparison.
+    const int count = rows_or_columns.size();
+    myItems.resize(count);
+
+    for (int i = 0; i < count; ++i) {
+        const int thingToSort = rows_or_columns.at(i);
+        QVector<const QicsDataItem *> &column = myItems[i];
+        column.fill(0, size);
+
+        QVector<int>::const_iterator iter, iter_end(indices.constEnd());
+        for (iter = indices.constBegin(); iter != iter_end; ++iter) {
+            const QicsDataItem *it = (type == Qics::RowIndex) ?
+                dm->item(*iter, thingToSort) : dm->item(thingToSort, *iter);
+
+            if (it)
+                column[*iter] = it->clone();
+        }
+    }
+
+    myThingsToSort = rows_or_columns;
+    myModel = dm;
+    myType = type;
+    myFunc = func;
+    myOrdFlip = ordFlip;
+    myCompare = CompareItems;
+}
+
+void QicsSortContext::useDelegates(QicsSorter *sorter, const QVector<int> &rows_or_columns)
+{
+    const int count = rows_or_columns.size();
+    QicsAbstractSorterDelegate *sorterDelegateDefault = sorter->defaultSorterDelegate();
+
+    myDelegates.resize(count);
+
+    for (int i = 0; i < count; ++i) {
+        QicsAbstractSorterDelegate *sorterDelegate = sorter->sorterDelegate(rows_or_columns.at(i));
+        myDelegates[i] = sorterDelegate ? sorterDelegate : sorterDelegateDefault;
+    }
+
+    myThingsToSort = rows_or_columns;
+    myCompare = CompareDelegates;
 }
 
-bool functionLessThan(const int &_a, const int &_b)
+bool QicsSortContext::sortsBy(int first, int last) const
 {
-    const QicsDataModel *dm = g_self->dataModel();
-    if (!dm) return false;
+    QVector<int>::const_iterator iter, iter_end(myThingsToSort.constEnd());
+    for (iter = myThingsToSort.constBegin(); iter != iter_end; ++iter)
+        if (*iter >= first && *iter <= last)
+            return true;
 
-    return (functionCompare(_a, _b, dm) < 0);
+    return false;
 }
 
+void QicsSortContext::update(const QVector<int> &indices)
+{
+    const int count = myThingsToSort.size();
+
+    switch (myCompare)
+    {
+    case CompareKeys:
+        for (int i = 0; i < count; ++i)
+            myDelegates.at(i)->buildSortKeys(indices, myThingsToSort.at(i), myKeys[i]);
+        break;
+    case CompareItems:
+        for (int i = 0; i < count; ++i) {
+            const int thingToSort = myThingsToSort.at(i);
+            QVector<const QicsDataItem *> &column = myItems[i];
+
+            QVector<int>::const_iterator iter, iter_end(indices.constEnd());
+            for (iter = indices.constBegin(); iter != iter_end; ++iter) {
+                const QicsDataItem *it = (myType == Qics::RowIndex) ?
+                    myModel->item(*iter, thingToSort) : myModel->item(thingToSort, *iter);
+
+                delete column.at(*iter);
+                column[*iter] = it ? it->clone() : 0;
+            }
+        }
+        break;
+    default:
+        // delegates read the data model on every comparison
+        break;
+    }
+}
+
+bool QicsSortContext::isSorted(const int *begin, const int *end) const
+{
+    if (end - begin < 2)
+        return true;
+
+    for (const int *it = begin; it + 1 != end; ++it)
+        if (lessThan(*(it + 1), *it))
+            return false;
+
+    return true;
+}
+
+void QicsSortContext::sort(int *begin, int *end) const
+{
+    // nothing to do if the range is in order already
+    if (isSorted(begin, end))
+        return;
+
+    switch (myMode)
+    {
+    case Qics::QicsQuickSort:
+        qSort(begin, end, QicsSortContextLessThan(this));
+        break;
+    case Qics::QicsParallelStableSort:
+        parallelSort(begin, end);
+        break;
+    default:
+        qStableSort(begin, end, QicsSortContextLessThan(this));
+        break;
+    }
+}
+
+void QicsSortContext::parallelSort(int *begin, int *end) const
+{
+    const int size = end - begin;
+    const int chunks = QThread::idealThreadCount();
+
+    if (!isReentrant() || chunks < 2 || size < QICS_PARALLEL_SORT_THRESHOLD) {
+        qStableSort(begin, end, QicsSortContextLessThan(this));
+        return;
+    }
+
+    // A private pool, so that a sort running in a pooled thread
+    // can never wait for a slot of its own pool.
+    QThreadPool pool;
+    pool.setMaxThreadCount(chunks);
+
+    mergeSort(begin, end, chunks, &pool, 0);
+}
+
+bool QicsSortContext::sortInSteps(int *begin, int *end, QicsSortObserver *observer) const
+{
+    Q_ASSERT(isReentrant());
+
+    const int size = end - begin;
+
+    if (isSorted(begin, end))
+        return observer->step(1, 1);
+
+    const int chunks = qBound(1, size / QICS_ASYNC_SORT_CHUNK, QICS_ASYNC_SORT_MAX_CHUNKS);
+    const int threads = QThread::idealThreadCount();
+
+    if (myMode == Qics::QicsParallelStableSort && threads > 1 && size >= QICS_PARALLEL_SORT_THRESHOLD) {
+        QThreadPool pool;
+        pool.setMaxThreadCount(threads);
+        return mergeSort(begin, end, qMax(chunks, threads), &pool, observer);
+    }
+
+    return mergeSort(begin, end, chunks, 0, observer);
+}
+
+/*
+* Sorts \a chunks runs of [begin, end) and merges neighbouring runs,
+* doubling the run width on every pass.  The tasks of a pass run on
+* \a pool, or one after another on the calling thread if there is no
+* pool.  Every finished task, or every pass on a pool, is reported to
+* \a observer, if any.
+*/
+bool QicsSortContext::mergeSort(int *begin, int *end, int chunks, QThreadPool *pool,
+                                QicsSortObserver *observer) const
+{
+    const int size = end - begin;
+    int total = chunks;
+    int done = 0;
+
+    for (int width = 1; width < chunks; width *= 2)
+        total += (chunks + 2 * width - 1) / (2 * width);
+
+    QVector<int> bounds(chunks + 1);
+    for (int i = 0; i <= chunks; ++i)
+        bounds[i] = int(qint64(size) * i / chunks);
+
+    for (int i = 0; i < chunks; ++i) {
+        QicsSortChunkTask *task = new QicsSortChunkTask(this, begin + bounds.at(i), begin + bounds.at(i + 1));
+
+        if (pool)
+            pool->start(task);
+        else {
+            task->run();
+            delete task;
+            if (observer && !observer->step(++done, total))
+                return false;
+        }
+    }
+
+    if (pool) {
+        pool->waitForDone();
+        done = chunks;
+        if (observer && !observer->step(done, total))
+            return false;
+    }
+
+    if (chunks < 2)
+        return true;
+
+    QVector<int> buffer(size);
+    int *src = begin;
+    int *dst = buffer.data();
+
+    for (int width = 1; width < chunks; width *= 2) {
+        for (int i = 0; i < chunks; i += 2 * width) {
+            const int first = bounds.at(i);
+            const int middle = bounds.at(qMin(i + width, chunks));
+            const int last = bounds.at(qMin(i + 2 * width, chunks));
+            QicsSortMergeTask *task = new QicsSortMergeTask(this, src, dst, first, middle, last);
+
+            if (pool) {
+                pool->start(task);
+                ++done;
+            }
+            else {
+                task->run();
+                delete task;
+                if (observer && !observer->step(++done, total))
+                    return false;
+            }
+        }
+
+        if (pool) {
+            pool->waitForDone();
+            if (observer && !observer->step(done, total))
+                return false;
+        }
+
+        qSwap(src, dst);
+    }
+
+    if (src != begin)
+        memcpy(begin, src, size * sizeof(int));
+
+    return true;
+}
 
 QicsSorter::QicsSorter(Qics::QicsIndexType _type, QicsDataModel *model, QObject *parent)
     : QObject(parent),
         myType(_type),
         myDataModel(model),
-        m_defaultSorterDelegate(0)
+        m_hiddenCount(0),
+        m_visualMapsValid(false),
+        m_orderRevision(0),
+        m_defaultSorterDelegate(0),
+        m_sortJob(0),
+        m_sortSerial(0),
+        m_liveSort(false),
+        m_liveContext(0),
+        m_liveFrom(0),
+        m_liveTo(-1)
 {
     setSortMode(Qics::QicsQuickSort);
     m_sorterDelegates.clear();
@@ -135,12 +648,21 @@ QicsSorter::QicsSorter(Qics::QicsIndexType _type, QicsDataModel *model, QObject
             connect(myDataModel, SIGNAL(columnsDeleted(int, int)),
                 this, SLOT(deleteElements(int, int)));
         }
+
+        connect(myDataModel, SIGNAL(modelChanged(const QicsRegion &)),
+            this, SLOT(handleModelChanged(const QicsRegion &)));
     }
     fillVisualToModelMap();
 }
 
 QicsSorter::~QicsSorter()
 {
+    // a running job finishes on its own and deletes itself
+    if (m_sortJob)
+        m_sortJob->cancel();
+
+    delete m_liveContext;
+
     qDeleteAll(m_sorterDelegates);
     m_sorterDelegates.clear();
 }
@@ -204,6 +726,8 @@ void QicsSorter::integrityCheck()
 */
 void QicsSorter::appendElements(int how_many)
 {
+    dropLiveSort();
+
     // If we haven't yet reordered anything, we don't need to do anything
     // here.
     if (m_order.isEmpty()) {
@@ -228,6 +752,9 @@ void QicsSorter::appendElements(int how_many)
         ++cur_size;
     }
 
+    if (m_hiddenCount)
+        m_hidden.resize(cur_size);
+
     flushModelToVisualMap();
 }
 
@@ -245,15 +772,17 @@ void QicsSorter::elementVisibilityChanged(int index, bool visible)
 
     const int element = m_order.at(index);
 
-    if (visible) {
-        m_hidden.remove(element);
-    }
-    else {
-        m_hidden.insert(element);
-    }
+    if (m_hidden.size() <= element)
+        m_hidden.resize(qMax(cur_size, element + 1));
 
-    flushModelToVisualMap();
-    fillModelToVisualMap();
+    if (m_hidden.at(element) == visible) {
+        m_hidden[element] = !visible;
+        m_hiddenCount += visible ? -1 : 1;
+
+        // filters hide many elements in a row, so the
+        // maps are only rebuilt when they are needed
+        flushModelToVisualMap();
+    }
 }
 
 /*! internal slot
@@ -263,6 +792,8 @@ void QicsSorter::insertElements(int how_many, int start)
     /* guard ourselves */
     Q_ASSERT(how_many > 0);
 
+    dropLiveSort();
+
     // If we haven't yet reordered anything, we don't need to do anything
     // here.
 
@@ -317,6 +848,9 @@ void QicsSorter::insertElements(int how_many, int start)
     for(i = 0; i < how_many; ++i)
         m_order[insertPoint+i] = start+i;
 
+    if (start < m_hidden.size())
+        m_hidden.insert(start, how_many, false);
+
 #ifdef INTEGRITY_CHECK
     integrityCheck();
 #endif
@@ -331,6 +865,8 @@ void QicsSorter::insertElements(int how_many, int start)
 */
 void QicsSorter::deleteElements(int how_many, int start)
 {
+    dropLiveSort();
+
     // If we haven't yet reordered anything, we don't need to do anything
     // here.
 
@@ -373,6 +909,12 @@ void QicsSorter::deleteElements(int how_many, int start)
 
     m_order.resize(ndone);
 
+    if (start < m_hidden.size()) {
+        const int removed = qMin(how_many, m_hidden.size() - start);
+        m_hiddenCount -= m_hidden.mid(start, removed).count(true);
+        m_hidden.remove(start, removed);
+    }
+
 #ifdef INTEGRITY_CHECK
     integrityCheck();
 #endif
@@ -385,6 +927,8 @@ void QicsSorter::deleteElements(int how_many, int start)
 
 void QicsSorter::deleteVisualElements(int how_many, int start)
 {
+    dropLiveSort();
+
     if (m_order.isEmpty())
         return;
 
@@ -424,43 +968,86 @@ void QicsSorter::fillVisualToModelMap()
 
     for(int i = 0; i < orderAllocated; ++i)
         m_order[i] = i;
+
+    flushModelToVisualMap();
 }
 
-/* We lazy evaluate this map because we don't need it all the time.
+/* We lazy evaluate these maps because we don't need them all the time.
 */
 void QicsSorter::fillModelToVisualMap()
 {
     const int size = m_order.size();
-    m_modelToVisualMap.clear();
-    int index = 0;
-    for(int i = 0; i < size; ++i) {
-        if (!m_hidden.contains(m_order.at(i))) {
-            m_modelToVisualMap.insert(m_order.at(i), index);
-            ++index;
+    const int *order = m_order.constData();
+
+    // guard against orders which do not hold every model index
+    int bound = size;
+    for(int i = 0; i < size; ++i)
+        if (order[i] >= bound)
+            bound = order[i] + 1;
+
+    m_orderIndex.fill(-1, bound);
+    int *orderIndex = m_orderIndex.data();
+
+    for(int i = 0; i < size; ++i)
+        orderIndex[order[i]] = i;
+
+    if (m_hiddenCount) {
+        // only visible elements have a visual index
+        m_modelToVisual.fill(-1, bound);
+        m_visualToModel.resize(0);
+        m_visualToModel.reserve(size);
+
+        int *modelToVisual = m_modelToVisual.data();
+        const int hiddenSize = m_hidden.size();
+
+        for(int i = 0; i < size; ++i) {
+            const int x = order[i];
+            if (x < hiddenSize && m_hidden.at(x))
+                continue;
+            modelToVisual[x] = m_visualToModel.size();
+            m_visualToModel.append(x);
         }
     }
+    else {
+        m_modelToVisual.clear();
+        m_visualToModel.clear();
+    }
+
+    m_visualMapsValid = true;
 }
 
 void QicsSorter::flushModelToVisualMap()
 {
-    m_modelToVisualMap.clear();
+    m_visualMapsValid = false;
+    ++m_orderRevision;
+}
+
+void QicsSorter::mapToVisual(int *visChange, int size)
+{
+    flushModelToVisualMap();
+    fillModelToVisualMap();
+
+    // hidden elements are mapped to the first visual index
+    for(int i = 0; i < size; ++i)
+        visChange[i] = qMax(0, modelToVisual(visChange[i]));
 }
 
 int QicsSorter::modelToVisual(int x)
 {
-    if(m_modelToVisualMap.isEmpty())
+    if (!m_visualMapsValid)
         fillModelToVisualMap();
 
-    return m_modelToVisualMap.value(x, -1);
+    const QVector<int> &map = m_hiddenCount ? m_modelToVisual : m_orderIndex;
+    return ((x >= 0 && x < map.size()) ? map.at(x) : -1);
 }
 
 int QicsSorter::visualToModel(int x)
 {
-    if(m_modelToVisualMap.isEmpty())
+    if (!m_visualMapsValid)
         fillModelToVisualMap();
 
-    const int model = m_modelToVisualMap.key(x, -1);
-    return model;
+    const QVector<int> &map = m_hiddenCount ? m_visualToModel : m_order;
+    return ((x >= 0 && x < map.size()) ? map.at(x) : -1);
 }
 
 void QicsSorter::sort(const QVector<int> &rows_or_columns, QicsSortOrder sort_order,
@@ -475,72 +1062,383 @@ void QicsSorter::sort(const QVector<int> &rows_or_columns, QicsSortOrder sort_or
     if (rows_or_columns.isEmpty())
         return;
 
-    m_defaultSorterDelegate->setSortOrder(sort_order);
-    m_defaultSorterDelegate->setType(type());
+    if(from < 0)
+        from = 0;
+    if(to < 0 || to >= oldOrderSize)
+        to = oldOrderSize - 1;
+
+    dropLiveSort();
+
+    // save off a copy of the order so we can build the change map
+    int *visChange = new int[oldOrderSize];
+    memmove(visChange, m_order.constData(), oldOrderSize*sizeof(int));
+
+    if (from < to) {
+        QicsSortContext *context = createSortContext(rows_or_columns, sort_order,
+            m_order.mid(from, to - from + 1), func);
+
+        int *data = m_order.data();
+        context->sort(data + from, data + to + 1);
 
-    g_self = this;
-    g_thingsToSort = rows_or_columns;
-    g_thingsToSortIter = g_thingsToSort.begin();
-    g_compareFunc = func;
-    g_ordFlip = (sort_order == Qics::Ascending ) ? 1 : -1;
+        if (m_liveSort)
+            setLiveContext(context, from, to);
+        else
+            delete context;
+    }
+
+    /* Now we compute the mapping of old visual to new visual.
+    * For old visual i, visChange[i] is the model index,
+    * modelToVisual of that gives the current visual.
+    */
+    mapToVisual(visChange, oldOrderSize);
+
+    emit orderChanged(myType, visChange, oldOrderSize);
+
+    delete[] visChange;
+}
+
+void QicsSorter::sortRanges(const QVector<int> &rows_or_columns, QicsSortOrder sort_order,
+                            QVector<int> &indices, const QVector<int> &bounds,
+                            DataItemComparator func)
+{
+    if (rows_or_columns.isEmpty() || bounds.size() < 2 || indices.size() < 2)
+        return;
+
+    // the keys are indexed by model index
+    if (m_order.isEmpty())
+        fillVisualToModelMap();
+
+    QicsSortContext *context = createSortContext(rows_or_columns, sort_order,
+        indices, func);
+
+    int *data = indices.data();
+    for (int i = 0; i + 1 < bounds.size(); ++i)
+        if (bounds.at(i) + 1 < bounds.at(i+1))
+            context->sort(data + bounds.at(i), data + bounds.at(i+1));
+
+    delete context;
+}
+
+void QicsSorter::sortAsync(const QVector<int> &rows_or_columns, QicsSortOrder sort_order,
+                           int from, int to, DataItemComparator func)
+{
+    cancelSort();
+    dropLiveSort();
+
+    // If we haven't moved or sorted yet, we need to fill this map.
+    if (m_order.isEmpty())
+        fillVisualToModelMap();
+
+    const int oldOrderSize = m_order.size();
+
+    if (rows_or_columns.isEmpty()) {
+        emit sortFinished(myType, false);
+        return;
+    }
 
     if(from < 0)
         from = 0;
     if(to < 0 || to >= oldOrderSize)
         to = oldOrderSize - 1;
 
+    QicsSortContext *context = 0;
+    if (from < to)
+        context = createSortContext(rows_or_columns, sort_order,
+            m_order.mid(from, to - from + 1), func);
+
+    // Delegates without sort keys compare by reading the data model,
+    // which may only be done on this thread.
+    if (!context || !context->isReentrant()) {
+        delete context;
+        sort(rows_or_columns, sort_order, from, to, func);
+        emit sortFinished(myType, true);
+        return;
+    }
+
+    m_sortJob = new QicsSortJob(this, context, ++m_sortSerial, m_order, from, to);
+    m_sortJob->start(QThread::LowPriority);
+}
+
+void QicsSorter::cancelSort()
+{
+    if (!m_sortJob)
+        return;
+
+    m_sortJob->cancel();
+    m_sortJob = 0;
+    m_liveChanges.clear();
+
+    emit sortFinished(myType, false);
+}
+
+void QicsSorter::handleSortProgress(int serial, int percent)
+{
+    if (m_sortJob && m_sortJob->serial() == serial)
+        emit sortProgress(myType, percent);
+}
+
+void QicsSorter::handleSortDone(int serial)
+{
+    if (!m_sortJob || m_sortJob->serial() != serial)
+        return;
+
+    // the job deletes itself once its thread has finished
+    QicsSortJob *job = m_sortJob;
+    m_sortJob = 0;
+
+    // The order was changed while sorting, so the sorted
+    // snapshot does not describe it any more.
+    if (job->order() != m_order) {
+        m_liveChanges.clear();
+        emit sortFinished(myType, false);
+        return;
+    }
+
+    const int oldOrderSize = m_order.size();
+    const QVector<int> &range = job->range();
+
     // save off a copy of the order so we can build the change map
     int *visChange = new int[oldOrderSize];
     memmove(visChange, m_order.constData(), oldOrderSize*sizeof(int));
 
-    QVector<int>::iterator _from = m_order.begin()+from;
-    QVector<int>::iterator _to = m_order.begin()+to+1;
+    memmove(m_order.data() + job->from(), range.constData(), range.size()*sizeof(int));
 
-    bool sorted = false;
-    int vm_i = visualToModel(from);
-    int vm_i1 = -1;
-    const QicsDataModel *dm = dataModel();
+#ifdef INTEGRITY_CHECK
+    integrityCheck();
+#endif
+    /* Now we compute the mapping of old visual to new visual.
+    * For old visual i, visChange[i] is the model index,
+    * modelToVisual of that gives the current visual.
+    */
+    mapToVisual(visChange, oldOrderSize);
 
-    for (int i=from;i<to;++i) {
-        vm_i1 = visualToModel(i+1);
+    emit orderChanged(myType, visChange, oldOrderSize);
 
-        int result = 0;
-        if (func)
-            result = functionCompare(vm_i, vm_i1, dm);
-        else
-            result = delegateCompare(vm_i, vm_i1);
+    delete[] visChange;
 
-        if(result>0) {
-            sorted=false;
-            break;
-        }
-        else {
-            sorted=true;
-            vm_i = vm_i1;
-        }
+    if (m_liveSort) {
+        setLiveContext(job->takeContext(), job->from(), job->from() + range.size() - 1);
+
+        // apply the changes which came in while sorting
+        const QVector<QicsRegion> changes = m_liveChanges;
+        m_liveChanges.clear();
+        foreach (const QicsRegion &reg, changes)
+            handleModelChanged(reg);
     }
 
-    if (!sorted) {
-        if (sortMode() == Qics::QicsQuickSort)
-            qSort(_from, _to, func ? functionLessThan : delegateLessThan);
+    emit sortFinished(myType, true);
+}
+
+void QicsSorter::setLiveSort(bool on)
+{
+    m_liveSort = on;
+
+    if (!on) {
+        dropLiveSort();
+        m_liveChanges.clear();
+    }
+}
+
+void QicsSorter::setLiveContext(QicsSortContext *context, int from, int to)
+{
+    delete m_liveContext;
+    m_liveContext = context;
+    m_liveFrom = from;
+    m_liveTo = to;
+}
+
+void QicsSorter::dropLiveSort()
+{
+    delete m_liveContext;
+    m_liveContext = 0;
+}
+
+int QicsSorter::orderIndex(int x)
+{
+    if (!m_visualMapsValid)
+        fillModelToVisualMap();
+
+    return ((x >= 0 && x < m_orderIndex.size()) ? m_orderIndex.at(x) : -1);
+}
+
+void QicsSorter::handleModelChanged(const QicsRegion &reg)
+{
+    if (!m_liveSort)
+        return;
+
+    // the order is replaced when the background sort is done
+    if (m_sortJob) {
+        m_liveChanges << reg;
+        return;
+    }
+
+    if (!m_liveContext)
+        return;
+
+    const bool rows = (myType == RowIndex);
+
+    if (!m_liveContext->sortsBy(rows ? reg.startColumn() : reg.startRow(),
+                                rows ? reg.endColumn() : reg.endRow()))
+        return;
+
+    const int start = qMax(0, rows ? reg.startRow() : reg.startColumn());
+    const int end = qMin(m_order.size() - 1, rows ? reg.endRow() : reg.endColumn());
+
+    if (start == end)
+        repositionElement(start);
+    else if (start < end)
+        repositionElements(start, end);
+}
+
+/*
+* A single changed element is taken out of the live range and put back
+* at the position found by a binary search on the side it has to move
+* to.  The range is in order otherwise, so nothing else moves.
+*/
+void QicsSorter::repositionElement(int x)
+{
+    const int p = orderIndex(x);
+    if (p < m_liveFrom || p > m_liveTo)
+        return;
+
+    m_liveContext->update(QVector<int>() << x);
+
+    const int from = modelToVisual(x);
+    int *data = m_order.data();
+    int q;
+
+    if (p > m_liveFrom && m_liveContext->lessThan(x, data[p - 1])) {
+        q = qUpperBound(data + m_liveFrom, data + p, x,
+            QicsSortContextLessThan(m_liveContext)) - data;
+        memmove(data + q + 1, data + q, (p - q)*sizeof(int));
+    }
+    else if (p < m_liveTo && m_liveContext->lessThan(data[p + 1], x)) {
+        q = qUpperBound(data + p + 1, data + m_liveTo + 1, x,
+            QicsSortContextLessThan(m_liveContext)) - data - 1;
+        memmove(data + p, data + p + 1, (q - p)*sizeof(int));
+    }
+    else
+        return;
+
+    data[q] = x;
+
+#ifdef INTEGRITY_CHECK
+    integrityCheck();
+#endif
+
+    // only the elements between the old and the new place moved
+    if (m_visualMapsValid && !m_hiddenCount) {
+        int *orderIndex = m_orderIndex.data();
+        for (int i = qMin(p, q); i <= qMax(p, q); ++i)
+            orderIndex[data[i]] = i;
+        ++m_orderRevision;
+    }
+    else
+        flushModelToVisualMap();
+
+    // hidden elements move without being seen
+    const int to = modelToVisual(x);
+    if (from >= 0 && from != to)
+        emit itemMoved(myType, from, to);
+}
+
+/*
+* Several changed elements are taken out of the live range, sorted among
+* themselves and merged back into the rest of the range, which is still
+* in order.
+*/
+void QicsSorter::repositionElements(int start, int end)
+{
+    QVector<int> changed;
+    changed.reserve(end - start + 1);
+    for (int x = start; x <= end; ++x)
+        changed << x;
+
+    m_liveContext->update(changed);
+
+    const QVector<int> oldOrder = m_order;
+    const int *old = oldOrder.constData();
+
+    QVector<int> moved, rest;
+    for (int i = m_liveFrom; i <= m_liveTo; ++i) {
+        if (old[i] >= start && old[i] <= end)
+            moved << old[i];
+        else
+            rest << old[i];
+    }
+
+    if (moved.isEmpty())
+        return;
+
+    QicsSortContextLessThan lessThan(m_liveContext);
+    qStableSort(moved.begin(), moved.end(), lessThan);
+
+    int *out = m_order.data() + m_liveFrom;
+    const int *a = rest.constBegin(), *a_end = rest.constEnd();
+    const int *b = moved.constBegin(), *b_end = moved.constEnd();
+
+    while (a != a_end && b != b_end) {
+        if (lessThan(*b, *a))
+            *out++ = *b++;
         else
-            qStableSort(_from, _to, func ? functionLessThan : delegateLessThan);
+            *out++ = *a++;
     }
+    while (a != a_end)
+        *out++ = *a++;
+    while (b != b_end)
+        *out++ = *b++;
 
+    if (m_order == oldOrder)
+        return;
+
+#ifdef INTEGRITY_CHECK
+    integrityCheck();
+#endif
     flushModelToVisualMap();
 
-    /* Now we compute the mapping of old visual to new visual.
-    * For old visual i, visChange[i] is the model index,
-    * modelToVisualMap of that gives the current visual.
-    */
-    fillModelToVisualMap();
+    // map old positions to new ones through the model indices
+    const int size = m_order.size();
+    QVector<int> position(size);
+    for (int i = 0; i < size; ++i)
+        position[m_order.at(i)] = i;
 
-    for(int i = 0; i < oldOrderSize; ++i)
-        visChange[i] = m_modelToVisualMap.value(visChange[i]);
+    int *visChange = new int[size];
+    for (int i = 0; i < size; ++i)
+        visChange[i] = position.at(old[i]);
 
-    emit orderChanged(myType, visChange, oldOrderSize);
+    emit orderChanged(myType, visChange, size);
 
     delete[] visChange;
+
+    emit elementsRepositioned(myType);
+}
+
+QicsSortContext *QicsSorter::createSortContext(const QVector<int> &rows_or_columns,
+                                               QicsSortOrder sort_order,
+                                               const QVector<int> &indices,
+                                               DataItemComparator func)
+{
+    m_defaultSorterDelegate->setSortOrder(sort_order);
+    m_defaultSorterDelegate->setType(type());
+
+    // all delegates sort in the order of the default one
+    foreach (int thingToSort, rows_or_columns) {
+        QicsAbstractSorterDelegate *sorterDelegate = this->sorterDelegate(thingToSort);
+        if (sorterDelegate)
+            sorterDelegate->setSortOrder(sort_order);
+    }
+
+    QicsSortContext *context = new QicsSortContext(sortMode());
+
+    if (func) {
+        if (myDataModel)
+            context->snapshotItems(myDataModel, myType, rows_or_columns, indices,
+                m_order.size(), func, (sort_order == Qics::Ascending) ? 1 : -1);
+    }
+    else if (!context->buildKeys(this, rows_or_columns, indices, m_order.size(), sort_order))
+        context->useDelegates(this, rows_or_columns);
+
+    return context;
 }
 
 /*
@@ -568,6 +1466,8 @@ void QicsSorter::moveItems(int target, const QVector<int> &itms)
 
     int i;
 
+    dropLiveSort();
+
     // If we haven't moved or sorted yet, we need to fill this map.
     if (m_order.isEmpty())
         fillVisualToModelMap();
@@ -640,45 +1540,51 @@ QDomElement QicsSorter::toDomXml(const QString &tag, QDomDocument* doc) const
 {
     QDomElement e = doc->createElement(tag);
 
-    QStringList orderList;
-    foreach(int i, m_order)
-        orderList << QString::number(i);
-
-    QString attrValue = orderList.join(",");
-    e.setAttribute("order", attrValue);
+    // the order is stored as little endian 32 bit integers in base64,
+    // the visual maps are rebuilt from it
+    const int size = m_order.size();
+    QByteArray data(size * int(sizeof(qint32)), Qt::Uninitialized);
+    uchar *out = reinterpret_cast<uchar *>(data.data());
 
-    QStringList mapList;
-    foreach(int i, m_modelToVisualMap)
-        mapList << QString::number(i);
+    for(int i = 0; i < size; ++i, out += sizeof(qint32))
+        qToLittleEndian<qint32>(m_order.at(i), out);
 
-    attrValue = mapList.join(",");
-    e.setAttribute("map", attrValue);
+    e.setAttribute("orderData", QString::fromLatin1(data.toBase64()));
 
     return e;
 }
 
 void QicsSorter::configureFromDomXml(const QDomElement& e)
 {
-    QStringList orderList = e.attribute("order").split(",");
+    dropLiveSort();
+
     m_order.clear();
-    foreach(QString str, orderList)
-        if(!str.isEmpty())
-            m_order << str.toInt();
-
-    QStringList mapList = e.attribute("map").split(",");
-    m_modelToVisualMap.clear();
-    int index = 0;
-    foreach(const QString &str, mapList)
-        if(!str.isEmpty()) {
-            m_modelToVisualMap.insert(index, str.toInt());
-            ++index;
-        }
+
+    if (e.hasAttribute("orderData")) {
+        const QByteArray data = QByteArray::fromBase64(e.attribute("orderData").toLatin1());
+        const int size = data.size() / int(sizeof(qint32));
+        const uchar *in = reinterpret_cast<const uchar *>(data.constData());
+
+        m_order.resize(size);
+        for(int i = 0; i < size; ++i, in += sizeof(qint32))
+            m_order[i] = qFromLittleEndian<qint32>(in);
+    }
+    else {
+        // written by older versions
+        QStringList orderList = e.attribute("order").split(",");
+        foreach(QString str, orderList)
+            if(!str.isEmpty())
+                m_order << str.toInt();
+    }
+
+    flushModelToVisualMap();
 }
 
 void QicsSorter::reorder(const QVector<int> &newOrder, int from, int to)
 {
     register int i,j;
 
+    dropLiveSort();
     fillVisualToModelMap();
 
     const int oldOrderSize = m_order.size();
@@ -698,16 +1604,11 @@ void QicsSorter::reorder(const QVector<int> &newOrder, int from, int to)
     int *visChange = new int[oldOrderSize];
     memmove(visChange, m_order.constData(), oldOrderSize*sizeof(int));
 
-    flushModelToVisualMap();
-
     /* Now we compute the mapping of old visual to new visual.
     * For old visual i, visChange[i] is the model index,
-    * modelToVisualMap of that gives the current visual.
+    * modelToVisual of that gives the current visual.
     */
-    fillModelToVisualMap();
-
-    for(i = 0; i < oldOrderSize; ++i)
-        visChange[i] = m_modelToVisualMap.value(visChange[i]);
+    mapToVisual(visChange, oldOrderSize);
 
     emit orderChanged(myType, visChange, oldOrderSize);
 
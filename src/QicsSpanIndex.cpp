@@ -0,0 +1,138 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#include "QicsSpanIndex.h"
+
+#include <algorithm>
+
+
+static inline bool regionsIntersect(const QicsRegion &a, const QicsRegion &b)
+{
+    return (a.startRow() <= b.endRow() && b.startRow() <= a.endRow() &&
+        a.startColumn() <= b.endColumn() && b.startColumn() <= a.endColumn());
+}
+
+static inline bool isEmptyRegion(const QicsRegion &reg)
+{
+    return (reg.endRow() < reg.startRow() || reg.endColumn() < reg.startColumn());
+}
+
+
+QicsSpanIndex::QicsSpanIndex()
+{
+}
+
+void QicsSpanIndex::clear()
+{
+    myRegions.clear();
+    myTiles.clear();
+    myLarge.clear();
+}
+
+int QicsSpanIndex::add(const QicsRegion &reg)
+{
+    const int id = myRegions.size();
+    myRegions.append(reg);
+
+    if (isEmptyRegion(reg))
+        return id;
+
+    const int tr1 = tileOf(reg.startRow()), tr2 = tileOf(reg.endRow());
+    const int tc1 = tileOf(reg.startColumn()), tc2 = tileOf(reg.endColumn());
+
+    if (qint64(tr2 - tr1 + 1) * (tc2 - tc1 + 1) > MaxTiles) {
+        myLarge.append(id);
+        return id;
+    }
+
+    for (int tr = tr1; tr <= tr2; ++tr)
+        for (int tc = tc1; tc <= tc2; ++tc)
+            myTiles[tileKey(tr, tc)].append(id);
+
+    return id;
+}
+
+int QicsSpanIndex::find(int row, int col) const
+{
+    int found = -1;
+
+    QHash<quint64, QVector<int> >::const_iterator it =
+        myTiles.constFind(tileKey(tileOf(row), tileOf(col)));
+
+    if (it != myTiles.constEnd()) {
+        const QVector<int> &ids = it.value();
+        for (int i = 0; i < ids.size(); ++i) {
+            const int id = ids.at(i);
+            if (myRegions.at(id).containsCell(row, col)) {
+                found = id;
+                break;
+            }
+        }
+    }
+
+    // large regions only matter if they come before the tile's match
+    for (int i = 0; i < myLarge.size(); ++i) {
+        const int id = myLarge.at(i);
+        if (found >= 0 && id > found)
+            break;
+        if (myRegions.at(id).containsCell(row, col)) {
+            found = id;
+            break;
+        }
+    }
+
+    return found;
+}
+
+void QicsSpanIndex::intersecting(const QicsRegion &reg, QVector<int> &ids_return) const
+{
+    ids_return.clear();
+
+    if (myRegions.isEmpty() || isEmptyRegion(reg))
+        return;
+
+    const int tr1 = tileOf(reg.startRow()), tr2 = tileOf(reg.endRow());
+    const int tc1 = tileOf(reg.startColumn()), tc2 = tileOf(reg.endColumn());
+
+    // A query covering more tiles than there are occupied tiles (such as
+    // an entire row or column) is cheaper as a scan of all regions.
+    if (qint64(tr2 - tr1 + 1) * (tc2 - tc1 + 1) > myTiles.size()) {
+        for (int id = 0; id < myRegions.size(); ++id) {
+            const QicsRegion &r = myRegions.at(id);
+            if (!isEmptyRegion(r) && regionsIntersect(r, reg))
+                ids_return.append(id);
+        }
+        return;
+    }
+
+    for (int tr = tr1; tr <= tr2; ++tr) {
+        for (int tc = tc1; tc <= tc2; ++tc) {
+            QHash<quint64, QVector<int> >::const_iterator it =
+                myTiles.constFind(tileKey(tr, tc));
+            if (it == myTiles.constEnd())
+                continue;
+
+            const QVector<int> &ids = it.value();
+            for (int i = 0; i < ids.size(); ++i)
+                if (regionsIntersect(myRegions.at(ids.at(i)), reg))
+                    ids_return.append(ids.at(i));
+        }
+    }
+
+    for (int i = 0; i < myLarge.size(); ++i)
+        if (regionsIntersect(myRegions.at(myLarge.at(i)), reg))
+            ids_return.append(myLarge.at(i));
+
+    // a region overlapping several tiles is reported once per tile
+    std::sort(ids_return.begin(), ids_return.end());
+    ids_return.erase(std::unique(ids_return.begin(), ids_return.end()), ids_return.end());
+}
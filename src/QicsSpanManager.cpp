@@ -14,18 +14,29 @@
 
 #include "QicsGridInfo.h"
 #include "QicsDataModel.h"
+#include "QicsMappedDimensionManager.h"
+#include "QicsDimensionManager.h"
+
+// number of orderings for which visual span indexes are kept
+#define QICS_VISUAL_SPAN_INDEXES 4
 
 
 QicsSpanManager::QicsSpanManager(QicsGridInfo *grid_info, QObject *parent)
     : QObject(parent),
         myReportChanges(true),
-        myInfo(grid_info)
+        myInfo(grid_info),
+        mySpanRevision(0),
+        myModelIndexValid(false),
+        myNextVisualIndex(0)
 {
 }
 
 QicsSpanManager::QicsSpanManager(const QicsSpanManager &sm)
     : QObject(), myReportChanges(true),
-        myInfo(sm.myInfo)
+        myInfo(sm.myInfo),
+        mySpanRevision(0),
+        myModelIndexValid(false),
+        myNextVisualIndex(0)
 {
     QicsSpanList::const_iterator iter, iter_end(sm.myCellSpanList.constEnd());
 
@@ -51,13 +62,16 @@ bool QicsSpanManager::addCellSpan(const QicsSpan &sp)
     if (span.height()<=1 && span.width()<=1)
         return false;
 
+    // only the spans near the new one can intersect it
+    QVector<int> ids;
+    modelIndex().intersecting(span.toRegion(), ids);
+
     bool f = false;
-    QicsSpanList::iterator iter, it_end = myCellSpanList.end();
-    for (iter = myCellSpanList.begin(); iter != it_end; ++iter) {
-        const QicsSpan &sp = *iter;
+    for (int i = 0; i < ids.size(); ++i) {
+        QicsSpan &sp = myCellSpanList[ids.at(i)];
         // replace the span if there is one
         if ((sp._row == span._row) && (sp._col == span._col)) {
-            (*iter) = span;
+            sp = span;
             f = true;
             break;
         }
@@ -67,8 +81,14 @@ bool QicsSpanManager::addCellSpan(const QicsSpan &sp)
         }
     }
 
-    if (!f)
+    if (f)
+        spansChanged();
+    else {
         myCellSpanList.push_back(span);
+        // appending keeps the identifiers of the model index in step
+        myModelIndex.add(span.toRegion());
+        ++mySpanRevision;
+    }
 
     if (myReportChanges)
         emit spanChanged(span);
@@ -78,23 +98,25 @@ bool QicsSpanManager::addCellSpan(const QicsSpan &sp)
 
 void QicsSpanManager::removeCellSpan(int start_row, int start_col)
 {
-    QicsSpanList::iterator iter, iter_end(myCellSpanList.end());
-    for (iter = myCellSpanList.begin(); iter != iter_end; ++iter) {
-        QicsSpan r = *iter;
+    const int id = modelIndex().find(start_row, start_col);
+    if (id < 0)
+        return;
 
-        if ((r.row() == start_row) && (r.column() == start_col)) {
-            myCellSpanList.erase(iter);
+    QicsSpan r = myCellSpanList.at(id);
 
-            if (myReportChanges)
-                emit spanChanged(r);
-            return;
-        }
+    if ((r.row() == start_row) && (r.column() == start_col)) {
+        myCellSpanList.remove(id);
+        spansChanged();
+
+        if (myReportChanges)
+            emit spanChanged(r);
     }
 }
 
 void QicsSpanManager::removeAllSpans()
 {
     myCellSpanList.clear();
+    spansChanged();
 }
 
 QicsSpanList *QicsSpanManager::cellSpanList() const
@@ -111,29 +133,117 @@ bool QicsSpanManager::insideSpan(const QicsGridInfo &gi, int row, int col, QicsR
     if (row < 0 || col < 0)
         return false;
 
-    QicsSpanList::const_iterator it_end = myCellSpanList.constEnd();
-    for (QicsSpanList::const_iterator iter = myCellSpanList.constBegin(); iter != it_end; ++iter) {
-        const QicsSpan &r = *iter;
+    const QicsSpanIndex &index = visualIndex(gi);
 
-        const int top = gi.visualRowIndex(gi.firstNonHiddenModelRow(r.row(), r.row() + r.height() - 1));
-        const int left = gi.visualColumnIndex(gi.firstNonHiddenModelColumn(r.column(), r.column() + r.width() - 1));
-        const int &height = r._nrows;
-        const int &width = r._ncols;
+    const int id = index.find(row, col);
+    if (id < 0)
+        return false;
+
+    // Return the span in VISUAL coordinates
+    reg_return = index.region(id);
+
+    // Return true if it is spanner
+    if (spanner)
+        *spanner = ((row == reg_return.startRow()) && (col == reg_return.startColumn()));
+
+    return true;
+}
+
+void QicsSpanManager::visualSpansIntersecting(const QicsGridInfo &gi, const QicsRegion &reg,
+                                              QVector<QicsRegion> &spans_return) const
+{
+    spans_return.clear();
+
+    if (myCellSpanList.isEmpty())
+        return;
+
+    const QicsSpanIndex &index = visualIndex(gi);
+
+    QVector<int> ids;
+    index.intersecting(reg, ids);
+
+    spans_return.reserve(ids.size());
+    for (int i = 0; i < ids.size(); ++i)
+        spans_return.append(index.region(ids.at(i)));
+}
 
-        if( (top <= row) && (row < top+height) &&
-            (left <= col) && (col < left+width)) {
-            // Return the span in VISUAL coordinates
-            reg_return = QicsRegion(top, left, top + height-1, left + width - 1);
+void QicsSpanManager::spansChanged()
+{
+    ++mySpanRevision;
+    myModelIndexValid = false;
+}
+
+const QicsSpanIndex &QicsSpanManager::modelIndex() const
+{
+    if (!myModelIndexValid) {
+        myModelIndex.clear();
+        for (int i = 0; i < myCellSpanList.size(); ++i)
+            myModelIndex.add(myCellSpanList.at(i).toRegion());
+        myModelIndexValid = true;
+    }
 
-            // Return true if it is spanner
-            if (spanner)
-                *spanner = ((row == top) && (col == left));
+    return myModelIndex;
+}
 
-            return true;
+const QicsSpanIndex &QicsSpanManager::visualIndex(const QicsGridInfo &gi) const
+{
+    const QicsSorter *row_sorter = gi.rowOrdering();
+    const QicsSorter *column_sorter = gi.columnOrdering();
+    const QicsDimensionManager *dm = gi.mappedDM()->dimensionManager();
+
+    const uint row_order = row_sorter ? row_sorter->orderRevision() : 0;
+    const uint column_order = column_sorter ? column_sorter->orderRevision() : 0;
+    const uint row_revision = dm->rowRevision();
+    const uint column_revision = dm->columnRevision();
+
+    QicsVisualSpanIndex *cache = 0;
+    for (int i = 0; i < myVisualIndexes.size(); ++i) {
+        QicsVisualSpanIndex &vi = myVisualIndexes[i];
+        if (vi.rowSorter == row_sorter && vi.columnSorter == column_sorter && vi.dm == dm) {
+            cache = &vi;
+            break;
         }
     }
 
-    return false;
+    if (cache) {
+        if (cache->spanRevision == mySpanRevision &&
+                cache->rowOrderRevision == row_order &&
+                cache->columnOrderRevision == column_order &&
+                cache->rowRevision == row_revision &&
+                cache->columnRevision == column_revision)
+            return cache->index;
+    }
+    else if (myVisualIndexes.size() < QICS_VISUAL_SPAN_INDEXES) {
+        myVisualIndexes.resize(myVisualIndexes.size() + 1);
+        cache = &myVisualIndexes.last();
+    }
+    else {
+        cache = &myVisualIndexes[myNextVisualIndex];
+        myNextVisualIndex = (myNextVisualIndex + 1) % QICS_VISUAL_SPAN_INDEXES;
+    }
+
+    cache->rowSorter = row_sorter;
+    cache->columnSorter = column_sorter;
+    cache->dm = dm;
+    cache->spanRevision = mySpanRevision;
+    cache->rowOrderRevision = row_order;
+    cache->columnOrderRevision = column_order;
+    cache->rowRevision = row_revision;
+    cache->columnRevision = column_revision;
+
+    // see the comment above maxSpanForRow() on why spans are mapped
+    // from model to visual coordinates and not the other way round
+    cache->index.clear();
+    for (int i = 0; i < myCellSpanList.size(); ++i) {
+        const QicsSpan &r = myCellSpanList.at(i);
+
+        const int top = gi.visualRowIndex(gi.firstNonHiddenModelRow(r.row(), r.row() + r.height() - 1));
+        const int left = gi.visualColumnIndex(gi.firstNonHiddenModelColumn(r.column(), r.column() + r.width() - 1));
+
+        cache->index.add(QicsRegion(top, left, top + r._nrows - 1, left + r._ncols - 1));
+    }
+
+    return cache->index;
 }
 
 // AM: consider make this method deprecated
@@ -249,6 +359,8 @@ void QicsSpanManager::insertRows(int num, int start_position)
     if (num <= 0 || start_position<0)
         return;
 
+    spansChanged();
+
     QicsSpanList::iterator it, it_end(myCellSpanList.end());
     for ( it = myCellSpanList.begin(); it != it_end; ++it ) {
         if ( (*it)._row >= start_position ) {
@@ -269,6 +381,8 @@ void QicsSpanManager::insertColumns(int num, int start_position)
     if (num <= 0 || start_position<0)
         return;
 
+    spansChanged();
+
     QicsSpanList::iterator it, it_end(myCellSpanList.end());
     for ( it = myCellSpanList.begin(); it != it_end; ++it ) {
         if ( (*it)._col >= start_position ) {
@@ -289,6 +403,8 @@ void QicsSpanManager::deleteRows(int num, int start_position)
     if (num <= 0 || start_position<0)
         return;
 
+    spansChanged();
+
     QicsSpanList::iterator it;
     for ( it = myCellSpanList.begin(); it != myCellSpanList.end(); ++it ) {
         int sl = (*it)._row;
@@ -338,6 +454,8 @@ void QicsSpanManager::deleteColumns(int num, int start_position)
     if (num <= 0 || start_position<0)
         return;
 
+    spansChanged();
+
     QicsSpanList::iterator it;
     for ( it = myCellSpanList.begin(); it != myCellSpanList.end(); ++it ) {
         int sl = (*it)._col;
@@ -385,6 +503,8 @@ void QicsSpanManager::columnVisibilityChanged(int index, bool visible)
     if (myCellSpanList.isEmpty())
         return;
 
+    spansChanged();
+
     QicsSpanList::iterator it;
     for (it = myCellSpanList.begin(); it != myCellSpanList.end(); ++it) {
         if ( ((*it)._col <= index) && ((*it)._col+(*it)._ncols)>index) {
@@ -399,6 +519,8 @@ void QicsSpanManager::rowVisibilityChanged(int index, bool visible)
     if (myCellSpanList.isEmpty())
         return;
 
+    spansChanged();
+
     QicsSpanList::iterator it;
     for (it = myCellSpanList.begin(); it != myCellSpanList.end(); ++it) {
         if ( ((*it)._row <= index) && ((*it)._row+(*it)._nrows)>index) {
@@ -12,12 +12,14 @@
 
 #include "QicsStandardSorterDelegate.h"
 
+#include <typeinfo>
 #include "QicsDataItem.h"
 #include "QicsDataModel.h"
+#include "QicsSortKeys.h"
 
 
 QicsStandardSorterDelegate::QicsStandardSorterDelegate(QObject *parent)
-    : QicsAbstractSorterDelegate(parent)
+    : QicsAbstractSorterDelegate(parent), m_sortKeysEnabled(false), m_sortKeysSet(false)
 {
 }
 
@@ -31,66 +33,58 @@ int QicsStandardSorterDelegate::compare(const int &index1, const int &index2, co
 
     if (!dataModel) return 0;
 
-    const QicsDataItem *item1 = 0;
-    const QicsDataItem *item2 = 0;
+    // The key of the first item is taken before the second item is
+    // requested, so the items do not have to be cloned.
+    QString str1, str2;
+    QicsSortKey key1, key2;
 
     if (indexType() == Qics::RowIndex) {
-        item1 = dataModel->item(index1, sortIndex);
-        if (item1) item1 = item1->clone();
-        item2 = dataModel->item(index2, sortIndex);
-        if (item2) item2 = item2->clone();
+        key1 = QicsSortKeyColumn::makeKey(dataModel->item(index1, sortIndex), str1);
+        key2 = QicsSortKeyColumn::makeKey(dataModel->item(index2, sortIndex), str2);
     }
     else {
-        item1 = dataModel->item(sortIndex, index1);
-        if (item1) item1 = item1->clone();
-        item2 = dataModel->item(sortIndex, index2);
-        if (item2) item2 = item2->clone();
+        key1 = QicsSortKeyColumn::makeKey(dataModel->item(sortIndex, index1), str1);
+        key2 = QicsSortKeyColumn::makeKey(dataModel->item(sortIndex, index2), str2);
     }
 
-    int retval = 0;
-    int ordFlip = (sortOrder() == Qics::Ascending) ? 1 : -1;
+    const int ordFlip = (sortOrder() == Qics::Ascending) ? 1 : -1;
 
-    if (item1 == 0) {
-        if (item2 == 0)
-            retval = 0;
-        else
-            retval = ordFlip;
+    return QicsSortKeyColumn::compareKeys(key1, str1, key2, str2,
+        ordFlip, sortingSensitivity());
+}
+
+bool QicsStandardSorterDelegate::buildSortKeys(const QVector<int> &indices, int sortIndex,
+                                               QicsSortKeyColumn &keys)
+{
+    const QicsDataModel *dataModel = model();
+
+    if (!dataModel || !sortKeysEnabled()) return false;
+
+    QVector<int>::const_iterator iter, iter_end(indices.constEnd());
+
+    if (indexType() == Qics::RowIndex) {
+        for (iter = indices.constBegin(); iter != iter_end; ++iter)
+            keys.setItem(*iter, dataModel->item(*iter, sortIndex));
     }
-    else if (item2 == 0)
-        retval = ordFlip * -1;
     else {
-        QString a_string = item1->string();
-        QString b_string = item2->string();
-
-        if ((a_string.isEmpty())&&(b_string.isEmpty()))
-            retval = 0;
-        else
-            if (a_string.isEmpty())
-                retval = 1;
-            else
-                if (b_string.isEmpty())
-                    retval = -1;
-                else {
-                    bool ok1, ok2;
-                    double d1 = a_string.toDouble(&ok1);
-                    double d2 = b_string.toDouble(&ok2);
-                    if (ok1 && ok2) {
-                        retval = d1 == d2 ? 0 : ordFlip * (d1 < d2 ? -1 : 1);
-                    } else
-                        if (ok1)
-                            retval = -1;
-                        else
-                            if (ok2)
-                                retval = 1;
-                            else
-                                retval = ordFlip * stringCompare(a_string, b_string);
-                }
+        for (iter = indices.constBegin(); iter != iter_end; ++iter)
+            keys.setItem(*iter, dataModel->item(sortIndex, *iter));
     }
 
-    delete item1;
-    delete item2;
+    return true;
+}
 
-    return retval;
+void QicsStandardSorterDelegate::setSortKeysEnabled(bool on)
+{
+    m_sortKeysEnabled = on;
+    m_sortKeysSet = true;
 }
 
+bool QicsStandardSorterDelegate::sortKeysEnabled() const
+{
+    if (m_sortKeysSet)
+        return m_sortKeysEnabled;
 
+    // a subclass may have reimplemented compare(), which the keys ignore
+    return (typeid(*this) == typeid(QicsStandardSorterDelegate));
+}
@@ -12,87 +12,205 @@
 
 #include "QicsStyle.h"
 
+#include <stdlib.h>
+#include <string.h>
+#include <QHash>
+#include <QColor>
+#include <QFont>
 #include <QPalette>
 #include <QCursor>
+#include <QPen>
+#include <QPixmap>
 #include "QicsUtil.h"
 #include "QicsMouseMap.h"
 #include "QicsRegion.h"
 #include "QicsCellDisplay.h"
 
 
+/*
+* Values that many styles tend to share, such as colors and fonts,
+* are kept once in a pool and reference counted.
+*/
+
+static inline uint poolHash(const QString &val) { return qHash(val); }
+static inline uint poolHash(const QColor &val) { return val.rgba() ^ (uint(val.spec()) << 24); }
+static inline uint poolHash(const QFont &val) { return qHash(val.key()); }
+static inline uint poolHash(const QPixmap &val) { return qHash(quint64(val.cacheKey())); }
+
+static inline uint poolHash(const QPen &val)
+{
+    return val.color().rgba() ^ (uint(val.width()) << 8) ^ (uint(val.style()) << 16) ^
+        (uint(val.capStyle()) << 20) ^ (uint(val.joinStyle()) << 24);
+}
+
+template <typename T>
+static inline bool poolEqual(const T &a, const T &b) { return (a == b); }
+
+static inline bool poolEqual(const QPixmap &a, const QPixmap &b) { return (a.cacheKey() == b.cacheKey()); }
+
+template <typename T>
+class QicsStyleValuePool
+{
+public:
+    const T *acquire(const T &val)
+    {
+        QList<Node *> &bucket = myBuckets[poolHash(val)];
+
+        for (int i = 0; i < bucket.size(); ++i) {
+            Node *node = bucket.at(i);
+            if (poolEqual(node->value, val)) {
+                ++node->ref;
+                return &node->value;
+            }
+        }
+
+        Node *node = new Node(val);
+        bucket.append(node);
+        return &node->value;
+    }
+
+    void release(const T *val)
+    {
+        typename QHash<uint, QList<Node *> >::iterator iter = myBuckets.find(poolHash(*val));
+        if (iter == myBuckets.end())
+            return;
+
+        QList<Node *> &bucket = iter.value();
+
+        for (int i = 0; i < bucket.size(); ++i) {
+            Node *node = bucket.at(i);
+            if (&node->value != val)
+                continue;
+
+            if (--node->ref == 0) {
+                bucket.removeAt(i);
+                if (bucket.isEmpty())
+                    myBuckets.erase(iter);
+                delete node;
+            }
+            return;
+        }
+    }
+
+private:
+    struct Node
+    {
+        Node(const T &val) : value(val), ref(1) {}
+
+        T value;
+        int ref;
+    };
+
+    QHash<uint, QList<Node *> > myBuckets;
+};
+
+// The pools are never destroyed, so that styles which outlive
+// static destruction don't release into a dead pool.
+template <typename T>
+static QicsStyleValuePool<T> &valuePool()
+{
+    static QicsStyleValuePool<T> *pool = new QicsStyleValuePool<T>;
+    return *pool;
+}
+
+template <typename T>
+static inline void *acquireValue(const void *val)
+{
+    return const_cast<T *>(valuePool<T>().acquire(*static_cast<const T *>(val)));
+}
+
+template <typename T>
+static inline void releaseValue(void *val)
+{
+    valuePool<T>().release(static_cast<const T *>(val));
+}
+
+
 QicsStyle::QicsStyle()
-    : myStyleTypeList(0), myNumProperties(0), mySetCount(0)
+    : myPresent(0), myInlineProperties(0), mySlots(0),
+      myStyleTypeList(0), myNumProperties(0), mySetCount(0)
 {
-    myProperties.clear();
 }
 
 void QicsStyle::init()
 {
-    myProperties.resize(myNumProperties);
-    myProperties.fill(0);
+    Q_ASSERT(myNumProperties <= 64);
+
+    myInlineProperties = 0;
+
+    for (int i = 0; i < myNumProperties; ++i) {
+        switch (myStyleTypeList->at(i))
+        {
+        case QicsT_Int:
+        case QicsT_Float:
+        case QicsT_Boolean:
+            myInlineProperties |= (Q_UINT64_C(1) << i);
+            break;
+        default:
+            break;
+        }
+    }
 }
 
 QicsStyle::~QicsStyle()
 {
     clear();
-    myProperties.clear();
+    ::free(mySlots);
 }
 
 void QicsStyle::setValue(int prop, const void *val)
 {
     if (prop >= myNumProperties) return;
 
-    // Clear the old value first
-    clear(prop);
-
-    // If nothing to set, then bail out
-    if (!val) return;
+    // If nothing to set, then just clear the old value
+    if (!val) {
+        clear(prop);
+        return;
+    }
 
-    void *newval = 0;
+    // Make the new value before the old one goes away, because
+    // val may point into this style.
+    QicsStyleSlot slot;
+    slot.p = 0;
 
     switch(myStyleTypeList->at(prop))
     {
     case QicsT_Int:
-        newval = new int(*(static_cast<const int *> (val)));
+        slot.i = *(static_cast<const int *> (val));
         break;
     case QicsT_Float:
-        newval = new float(*(static_cast<const float *>(val)));
+        slot.f = *(static_cast<const float *>(val));
+        break;
+    case QicsT_Boolean:
+        slot.b = *(static_cast<const bool *> (val));
         break;
     case QicsT_QString:
-        newval = new QString(*(static_cast<const QString *>(val)));
+        slot.p = acquireValue<QString>(val);
         break;
     case QicsT_QColor:
-        newval = new QColor(*(static_cast<const QColor *>(val)));
+        slot.p = acquireValue<QColor>(val);
         break;
-    case QicsT_QPoint:
-        newval = new QPoint(*(static_cast<const QPoint *>(val)));
+    case QicsT_QFont:
+        slot.p = acquireValue<QFont>(val);
         break;
-    case QicsT_Boolean:
-        newval = new bool(*(static_cast<const bool *> (val)));
+    case QicsT_QPixmap:
+        slot.p = acquireValue<QPixmap>(val);
         break;
-    case QicsT_QFont:
-        newval = new QFont(*(static_cast<const QFont *> (val)));
+    case QicsT_QPen:
+        slot.p = acquireValue<QPen>(val);
+        break;
+    case QicsT_QPoint:
+        slot.p = new QPoint(*(static_cast<const QPoint *>(val)));
         break;
     case QicsT_QPalette:
         break;
     case QicsT_QCursor:
-        newval = new QCursor(*(static_cast<const QCursor *> (val)));
-        break;
-    case QicsT_QPixmap:
-        newval = new QPixmap(*(static_cast<const QPixmap *> (val)));
-        break;
-    case QicsT_QPen:
-        newval = new QPen(*(static_cast<const QPen *> (val)));
+        slot.p = new QCursor(*(static_cast<const QCursor *> (val)));
         break;
     case QicsT_QicsRegion:
-        newval = new QicsRegion(*(static_cast<const QicsRegion *> (val)));
+        slot.p = new QicsRegion(*(static_cast<const QicsRegion *> (val)));
         break;
-    case QicsT_QicsCellDisplay: {
-            QicsCellDisplay *cd = (QicsCellDisplay*)myProperties.at(prop);
-            if (cd)
-                cd->aboutToClear(0,-1,-1);
-        }
-        // fall through
+    case QicsT_QicsCellDisplay:
     case QicsT_Pointer:
     case QicsT_QicsMouseMap:
     case QicsT_PasteValidator:
@@ -100,14 +218,28 @@ void QicsStyle::setValue(int prop, const void *val)
     case QicsT_QicsDataItemFormatter:
     case QicsT_QWidget:
         // We don't copy this
-        newval = const_cast<void *> (val);
+        slot.p = const_cast<void *> (val);
         break;
 
     default:
         qWarning("QicsStyle::setValue: invalid property %d", prop);
     }
 
-    myProperties[prop] = newval;
+    // Clear the old value
+    clear(prop);
+
+    if (!(myInlineProperties & (Q_UINT64_C(1) << prop)) && !slot.p)
+        return;
+
+    // Make room for the new slot, keeping the slots in property order
+    const quint64 bit = Q_UINT64_C(1) << prop;
+    const int index = countBits(myPresent & (bit - 1));
+
+    mySlots = static_cast<QicsStyleSlot *>(::realloc(mySlots, (mySetCount + 1) * sizeof(QicsStyleSlot)));
+    ::memmove(mySlots + index + 1, mySlots + index, (mySetCount - index) * sizeof(QicsStyleSlot));
+
+    mySlots[index] = slot;
+    myPresent |= bit;
     ++mySetCount;
 }
 
@@ -119,49 +251,52 @@ void QicsStyle::clear()
 
 void QicsStyle::clear(int prop)
 {
-    if (prop >= myNumProperties || !getValue(prop))
+    if (prop >= myNumProperties)
+        return;
+
+    const quint64 bit = Q_UINT64_C(1) << prop;
+    if (!(myPresent & bit))
         return;
 
+    const int index = countBits(myPresent & (bit - 1));
+    void *val = mySlots[index].p;
+
     switch(myStyleTypeList->at(prop))
     {
     case QicsT_Int:
-        delete (static_cast<int *>(myProperties.at(prop)));
-        break;
     case QicsT_Float:
-        delete (static_cast<float *>(myProperties.at(prop)));
+    case QicsT_Boolean:
+        // kept in the slot
         break;
     case QicsT_QString:
-        delete (static_cast<QString *>(myProperties.at(prop)));
+        releaseValue<QString>(val);
         break;
     case QicsT_QColor:
-        delete (static_cast<QColor *>(myProperties.at(prop)));
+        releaseValue<QColor>(val);
         break;
-    case QicsT_QPoint:
-        delete (static_cast<QPoint *>(myProperties.at(prop)));
+    case QicsT_QFont:
+        releaseValue<QFont>(val);
         break;
-    case QicsT_Boolean:
-        delete (static_cast<bool *> (myProperties.at(prop)));
+    case QicsT_QPixmap:
+        releaseValue<QPixmap>(val);
         break;
-    case QicsT_QFont:
-        delete (static_cast<QFont *> (myProperties.at(prop)));
+    case QicsT_QPen:
+        releaseValue<QPen>(val);
+        break;
+    case QicsT_QPoint:
+        delete (static_cast<QPoint *>(val));
         break;
     case QicsT_QPalette:
-        delete (static_cast<QPalette *> (myProperties.at(prop)));
+        delete (static_cast<QPalette *> (val));
         break;
     case QicsT_QCursor:
-        delete (static_cast<QCursor *> (myProperties.at(prop)));
-        break;
-    case QicsT_QPixmap:
-        delete (static_cast<QPixmap *> (myProperties.at(prop)));
-        break;
-    case QicsT_QPen:
-        delete (static_cast<QPen *> (myProperties.at(prop)));
+        delete (static_cast<QCursor *> (val));
         break;
     case QicsT_QicsRegion:
-        delete (static_cast<QicsRegion *> (myProperties.at(prop)));
+        delete (static_cast<QicsRegion *> (val));
         break;
     case QicsT_QicsMouseMap:
-        delete (static_cast<QicsMouseMap *> (myProperties.at(prop)));
+        delete (static_cast<QicsMouseMap *> (val));
         break;
     case QicsT_Pointer:
     case QicsT_PasteValidator:
@@ -171,7 +306,7 @@ void QicsStyle::clear(int prop)
         // We don't free this
         break;
     case QicsT_QicsCellDisplay: {
-            QicsCellDisplay *cd = static_cast<QicsCellDisplay *>(myProperties.at(prop));
+            QicsCellDisplay *cd = static_cast<QicsCellDisplay *>(val);
             if (cd)
                 cd->aboutToClear(0,-1,-1);
         }
@@ -179,9 +314,15 @@ void QicsStyle::clear(int prop)
     default:
         qWarning("QicsStyle::clear: invalid property %d", prop);
     };
-    myProperties[prop] = 0;
 
     --mySetCount;
+    ::memmove(mySlots + index, mySlots + index + 1, (mySetCount - index) * sizeof(QicsStyleSlot));
+    myPresent &= ~bit;
+
+    if (!mySetCount) {
+        ::free(mySlots);
+        mySlots = 0;
+    }
 }
 
 QString QicsStyle::penToString(const QPen *pen)
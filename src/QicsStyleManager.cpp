@@ -20,6 +20,15 @@
 
 #define SAVE_SPACE
 
+// Resolved properties are kept for about as many cells as fit on a
+// large screen; the cache starts over when it grows past this.
+#define QICS_RESOLVED_STYLE_LIMIT 8192
+
+static inline quint64 resolvedStyleKey(int row, int col)
+{
+    return (quint64(quint32(row)) << 32) | quint32(col);
+}
+
 //----------------------------------------------------------------------------
 // CONSTRUCTORS AND DESTRUCTORS
 //----------------------------------------------------------------------------
@@ -30,7 +39,12 @@ QicsStyleManager::QicsStyleManager(Qics::QicsGridType type, QicsGridInfo *grid_i
         myReportChanges(true),
         myBaseSM(0),
         myGridInfo(grid_info),
-        myModelAttributeController(0)
+        myModelAttributeController(0),
+        myLastResolved(0),
+        myLastResolvedKey(0),
+        myBaseRevision(0),
+        myStyleRevision(0),
+        myWideRevision(0)
 {
     myDefaultStyle = new QicsCellStyle(type, true);
     myGridStyle = new QicsGridStyle(type, true);
@@ -43,7 +57,12 @@ QicsStyleManager::QicsStyleManager(QicsStyleManager *base_sm, QicsGridInfo *grid
     : QObject(parent),
         myType(base_sm->type()),
         myReportChanges(true),
-        myModelAttributeController(0)
+        myModelAttributeController(0),
+        myLastResolved(0),
+        myLastResolvedKey(0),
+        myBaseRevision(base_sm->styleRevision()),
+        myStyleRevision(0),
+        myWideRevision(0)
 {
     myBaseSM = base_sm;
     myGridInfo = grid_info;
@@ -93,6 +112,7 @@ QicsStyleManager::~QicsStyleManager()
 void QicsStyleManager::setModelAttributeController(QicsAbstractAttributeController* mac)
 {
     myModelAttributeController = mac;
+    invalidateResolvedStyles();
 
     if (myModelAttributeController) {
         myModelAttributeController->setDefaultStyle(myDefaultStyle);
@@ -167,6 +187,8 @@ void QicsStyleManager::setCellStyle(int row, int col, QicsCellStyle *cs)
 
     const QicsCellStylePV &the_row_vec = *(myVectorOfModelColumns.at(col));
     *the_row_vec[row] = *cs;
+
+    invalidateResolvedCell(row, col, false);
 }
 
 
@@ -390,6 +412,8 @@ void QicsStyleManager::configureFromDomXml(const QDomElement& e, QicsTable* tabl
         child = child.nextSiblingElement();
     }
 
+    invalidateResolvedStyles();
+
     setReportChanges(olds);
 }
 
@@ -645,6 +669,26 @@ void QicsStyleManager::setGridFromDomXml(const QDomElement& e, QicsTable*)
 void *QicsStyleManager::getCellProperty(int row, int col,
                                   QicsCellStyle::QicsCellStyleProperty name,
                                   int visual_row, int visual_col) const
+{
+    if (name < 0 || name >= QicsCellStyle::LastProperty)
+        return resolveCellProperty(row, col, name, visual_row, visual_col);
+
+    QicsResolvedCellStyle *rs = resolvedCellStyle(row, col, visual_row, visual_col);
+    if (!rs)
+        return resolveCellProperty(row, col, name, visual_row, visual_col);
+
+    const quint64 bit = Q_UINT64_C(1) << name;
+    if (!(rs->resolved & bit)) {
+        rs->values[name] = resolveCellProperty(row, col, name, visual_row, visual_col);
+        rs->resolved |= bit;
+    }
+
+    return rs->values[name];
+}
+
+void *QicsStyleManager::resolveCellProperty(int row, int col,
+                                  QicsCellStyle::QicsCellStyleProperty name,
+                                  int visual_row, int visual_col) const
 {
     void *val = 0;
 
@@ -980,6 +1024,155 @@ void *QicsStyleManager::defaultProp(QicsCellStyle::QicsCellStyleProperty prop) c
     return myDefaultStyle->getValue(prop);
 }
 
+QicsStyleManager::QicsResolvedCellStyle *QicsStyleManager::resolvedCellStyle(int row, int col,
+                                  int visual_row, int visual_col) const
+{
+    if (row < 0 || col < 0)
+        return 0;
+
+    // Attribute controllers may hand out values they compute on the fly,
+    // so nothing can be cached while one is in use anywhere in the chain.
+    for (const QicsStyleManager *sm = this; sm; sm = sm->myBaseSM)
+        if (sm->myModelAttributeController)
+            return 0;
+
+    if (myBaseSM) {
+        const uint rev = myBaseSM->styleRevision();
+        if (rev != myBaseRevision) {
+            myResolvedStyles.clear();
+            myLastResolved = 0;
+            myBaseRevision = rev;
+        }
+    }
+
+    const quint64 key = resolvedStyleKey(row, col);
+
+    if (!myLastResolved || myLastResolvedKey != key) {
+        QicsResolvedCellStyleHash::iterator iter = myResolvedStyles.find(key);
+
+        if (iter == myResolvedStyles.end()) {
+            if (myResolvedStyles.size() >= QICS_RESOLVED_STYLE_LIMIT)
+                myResolvedStyles.clear();
+
+            iter = myResolvedStyles.insert(key, QicsResolvedCellStyle());
+        }
+
+        myLastResolved = &iter.value();
+        myLastResolvedKey = key;
+    }
+
+    // the cell may have moved since it was cached
+    if (myLastResolved->visualRow != visual_row || myLastResolved->visualColumn != visual_col) {
+        myLastResolved->visualRow = visual_row;
+        myLastResolved->visualColumn = visual_col;
+        myLastResolved->resolved = 0;
+    }
+
+    return myLastResolved;
+}
+
+uint QicsStyleManager::columnStyleRevision(int col) const
+{
+    uint rev = myWideRevision;
+    if (col >= 0 && col < myColumnRevisions.size())
+        rev += myColumnRevisions.at(col);
+
+    return rev + (myBaseSM ? myBaseSM->columnStyleRevision(col) : 0);
+}
+
+void QicsStyleManager::invalidateResolvedCell(int row, int col, bool visual_coords)
+{
+    ++myStyleRevision;
+
+    // a visual column may show any model column
+    if (visual_coords || col < 0)
+        ++myWideRevision;
+    else {
+        if (col >= myColumnRevisions.size())
+            myColumnRevisions.resize(col + 1);
+        ++myColumnRevisions[col];
+    }
+
+    if (myResolvedStyles.isEmpty())
+        return;
+
+    if (visual_coords) {
+        // visual settings are rare, so just look for the cell
+        QicsResolvedCellStyleHash::iterator iter = myResolvedStyles.begin();
+
+        while (iter != myResolvedStyles.end()) {
+            if (iter.value().visualRow == row && iter.value().visualColumn == col)
+                iter = myResolvedStyles.erase(iter);
+            else
+                ++iter;
+        }
+    }
+    else
+        myResolvedStyles.remove(resolvedStyleKey(row, col));
+
+    myLastResolved = 0;
+}
+
+void QicsStyleManager::invalidateResolvedRow(int row, bool visual_coords)
+{
+    ++myStyleRevision;
+    ++myWideRevision;
+
+    if (myResolvedStyles.isEmpty())
+        return;
+
+    QicsResolvedCellStyleHash::iterator iter = myResolvedStyles.begin();
+
+    while (iter != myResolvedStyles.end()) {
+        const int r = visual_coords ? iter.value().visualRow : int(iter.key() >> 32);
+
+        if (r == row)
+            iter = myResolvedStyles.erase(iter);
+        else
+            ++iter;
+    }
+
+    myLastResolved = 0;
+}
+
+void QicsStyleManager::invalidateResolvedColumn(int col, bool visual_coords)
+{
+    ++myStyleRevision;
+
+    if (visual_coords || col < 0)
+        ++myWideRevision;
+    else {
+        if (col >= myColumnRevisions.size())
+            myColumnRevisions.resize(col + 1);
+        ++myColumnRevisions[col];
+    }
+
+    if (myResolvedStyles.isEmpty())
+        return;
+
+    QicsResolvedCellStyleHash::iterator iter = myResolvedStyles.begin();
+
+    while (iter != myResolvedStyles.end()) {
+        const int c = visual_coords ? iter.value().visualColumn : int(quint32(iter.key()));
+
+        if (c == col)
+            iter = myResolvedStyles.erase(iter);
+        else
+            ++iter;
+    }
+
+    myLastResolved = 0;
+}
+
+void QicsStyleManager::invalidateResolvedStyles()
+{
+    ++myStyleRevision;
+    ++myWideRevision;
+
+    myResolvedStyles.clear();
+    myLastResolved = 0;
+}
+
 ///////////////////////////////////////////////////////////////////////
 ///////////////////      Set Property Methods       ///////////////////
 ///////////////////////////////////////////////////////////////////////
@@ -1011,6 +1204,8 @@ void QicsStyleManager::setCellProperty(int row, int col, bool visual_coords,
     if (!visual_coords) {
         if (myModelAttributeController && myModelAttributeController->setCellProperty(row, col, name, val)) {
 
+            invalidateResolvedCell(row, col, visual_coords);
+
             if (myReportChanges)
                 emit cellPropertyChanged(QicsRegion(row, col, row, col), name, visual_coords);
 
@@ -1067,6 +1262,8 @@ void QicsStyleManager::setCellProperty(int row, int col, bool visual_coords,
     // just set it and be done with it.
     the_row_vec.at(row)->setValue(name,val);
 
+    invalidateResolvedCell(row, col, visual_coords);
+
     if (myReportChanges)
         emit cellPropertyChanged(QicsRegion(row, col, row, col),
         name, visual_coords);
@@ -1080,6 +1277,8 @@ void QicsStyleManager::setRowProperty(int row, bool visual_coords,
     if (!visual_coords) {
         if (myModelAttributeController && myModelAttributeController->setRowProperty(row, name, val)) {
 
+            invalidateResolvedRow(row, visual_coords);
+
             if (myReportChanges)
                 emit cellPropertyChanged(QicsRegion(row, 0, row, Qics::QicsLAST_COLUMN), name, visual_coords);
 
@@ -1134,6 +1333,8 @@ void QicsStyleManager::setRowProperty(int row, bool visual_coords,
         }
     }
 
+    invalidateResolvedRow(row, visual_coords);
+
     if (myReportChanges)
         emit cellPropertyChanged(QicsRegion(row, 0, row, Qics::QicsLAST_COLUMN),
             name, visual_coords);
@@ -1147,6 +1348,8 @@ void QicsStyleManager::setColumnProperty(int col, bool visual_coords,
     if (!visual_coords) {
         if (myModelAttributeController && myModelAttributeController->setColumnProperty(col, name, val)) {
 
+            invalidateResolvedColumn(col, visual_coords);
+
             if (myReportChanges)
                 emit cellPropertyChanged(QicsRegion(0, col, Qics::QicsLAST_ROW, col), name, visual_coords);
 
@@ -1200,6 +1403,8 @@ void QicsStyleManager::setColumnProperty(int col, bool visual_coords,
         }
     }
 
+    invalidateResolvedColumn(col, visual_coords);
+
     if (myReportChanges)
         emit cellPropertyChanged(QicsRegion(0, col, Qics::QicsLAST_ROW, col),
             name, visual_coords);
@@ -1237,6 +1442,8 @@ void QicsStyleManager::setRepeatingRowProperty(int row, unsigned int interval,
 
     rcs->setValue(name, val);
 
+    invalidateResolvedStyles();
+
     if (myReportChanges)
         emit cellPropertyChanged(QicsRegion(0, 0, Qics::QicsLAST_ROW, Qics::QicsLAST_COLUMN),
             name, true);
@@ -1266,6 +1473,8 @@ void QicsStyleManager::setRepeatingColumnProperty(int col, unsigned int interval
 
     rcs->setValue(name, val);
 
+    invalidateResolvedStyles();
+
     if (myReportChanges)
         emit cellPropertyChanged(QicsRegion(0, 0, Qics::QicsLAST_ROW, Qics::QicsLAST_COLUMN),
             name, true);
@@ -1276,6 +1485,8 @@ void QicsStyleManager::setDefaultProperty(QicsCellStyle::QicsCellStyleProperty n
 {
     // MAC
     if (myModelAttributeController && myModelAttributeController->setDefaultProperty(name, val)) {
+        invalidateResolvedStyles();
+
         if (myReportChanges)
             emit cellPropertyChanged(QicsRegion(0, 0, Qics::QicsLAST_ROW, Qics::QicsLAST_COLUMN), name, false);
 
@@ -1323,6 +1534,8 @@ void QicsStyleManager::setDefaultProperty(QicsCellStyle::QicsCellStyleProperty n
             style->clear(name);
     }
 
+    invalidateResolvedStyles();
+
     // report the change
     if (myReportChanges)
         emit cellPropertyChanged(QicsRegion(0, 0, Qics::QicsLAST_ROW, Qics::QicsLAST_COLUMN),
@@ -1349,6 +1562,8 @@ void QicsStyleManager::clearCellProperty(int row, int col, bool visual_coords,
 
     // MAC
     if (!visual_coords && myModelAttributeController && myModelAttributeController->clearCellProperty(row, col, name)) {
+        invalidateResolvedCell(row, col, visual_coords);
+
         if (myReportChanges)
             emit cellPropertyChanged(QicsRegion(row, col, row, col), name, visual_coords);
 
@@ -1376,6 +1591,8 @@ void QicsStyleManager::clearCellProperty(int row, int col, bool visual_coords,
 #endif
     );
 
+    invalidateResolvedCell(row, col, visual_coords);
+
     // report the change
     if (myReportChanges)
         emit cellPropertyChanged(QicsRegion(row, col, row, col),
@@ -1388,6 +1605,8 @@ void QicsStyleManager::clearRowProperty(int row, bool visual_coords,
     // MAC
     if (!visual_coords && myModelAttributeController && myModelAttributeController->clearRowProperty(row, name)) {
 
+        invalidateResolvedRow(row, visual_coords);
+
         if (myReportChanges)
             emit cellPropertyChanged(QicsRegion(row, 0, row, Qics::QicsLAST_COLUMN), name, visual_coords);
 
@@ -1409,6 +1628,8 @@ void QicsStyleManager::clearRowProperty(int row, bool visual_coords,
 
     cs->clear(name);
 
+    invalidateResolvedRow(row, visual_coords);
+
     if (myReportChanges)
         emit cellPropertyChanged(QicsRegion(row, 0, row, Qics::QicsLAST_COLUMN),
             name, visual_coords);
@@ -1420,6 +1641,8 @@ void QicsStyleManager::clearColumnProperty(int col, bool visual_coords,
     // MAC
     if (!visual_coords && myModelAttributeController && myModelAttributeController->clearColumnProperty(col, name)) {
 
+        invalidateResolvedColumn(col, visual_coords);
+
         if (myReportChanges)
             emit cellPropertyChanged(QicsRegion(0, col, Qics::QicsLAST_ROW, col), name, visual_coords);
 
@@ -1441,6 +1664,8 @@ void QicsStyleManager::clearColumnProperty(int col, bool visual_coords,
 
     cs->clear(name);
 
+    invalidateResolvedColumn(col, visual_coords);
+
     if (myReportChanges)
         emit cellPropertyChanged(QicsRegion(0, col, Qics::QicsLAST_ROW, col),
             name, visual_coords);
@@ -1457,6 +1682,7 @@ void QicsStyleManager::clearRepeatingRowProperty(int row, unsigned int interval,
 
         if ((rcs->start() == row) && (rcs->interval() == interval)) {
             rcs->clear(name);
+            invalidateResolvedStyles();
             return;
         }
     }
@@ -1473,6 +1699,7 @@ void QicsStyleManager::clearRepeatingColumnProperty(int col, unsigned int interv
 
         if ((rcs->start() == col) && (rcs->interval() == interval)) {
             rcs->clear(name);
+            invalidateResolvedStyles();
             return;
         }
     }
@@ -1527,6 +1754,8 @@ void QicsStyleManager::insertRows(int num, int start_position)
     if ((start_position < 0) || (num <= 0))
         return;
 
+    invalidateResolvedStyles();
+
     // MAC
     if (myModelAttributeController)
         myModelAttributeController->insertRows(num, start_position);
@@ -1575,6 +1804,8 @@ void QicsStyleManager::insertColumns(int num, int start_position)
     if ((start_position < 0) || (num <= 0))
         return;
 
+    invalidateResolvedStyles();
+
     // MAC
     if (myModelAttributeController)
         myModelAttributeController->insertColumns(num, start_position);
@@ -1600,6 +1831,8 @@ void QicsStyleManager::insertColumns(int num, int start_position)
 
 void QicsStyleManager::setDataModel(QicsDataModel *sm)
 {
+    invalidateResolvedStyles();
+
     // MAC
     if (myModelAttributeController) {
         if (sm)
@@ -1623,6 +1856,8 @@ void QicsStyleManager::deleteRows(int num, int start_position)
     if ((start_position < 0) || (num <= 0))
         return;
 
+    invalidateResolvedStyles();
+
     // MAC
     if (myModelAttributeController)
         myModelAttributeController->deleteRows(num, start_position);
@@ -1686,6 +1921,8 @@ void QicsStyleManager::deleteColumns(int num, int start_position)
     if ((start_position < 0) || (num <= 0))
         return;
 
+    invalidateResolvedStyles();
+
     // MAC
     if (myModelAttributeController)
         myModelAttributeController->deleteColumns(num, start_position);
@@ -21,6 +21,7 @@
 #include "QicsDataModelDefault.h"
 #include "QicsScrollManager.h"
 #include "QicsSelectionManager.h"
+#include "QicsAutoFitCache.h"
 #include "QicsTextCellDisplay.h"
 #include "QicsScrollBarScroller.h"
 #include "QicsTableRegionDrag.h"
@@ -199,6 +200,7 @@ void QicsTable::init(QicsDataModel *model,
 
     myDefaultCellDisplayer = 0;
     myCellRegion = 0;
+    m_autoFitSampleSize = 0;
 
     m_tableCommon = new QicsTableCommon(this);
 
@@ -778,11 +780,12 @@ void QicsTable::initObjects()
     connect(m_selectionManager, SIGNAL(selectionListChangedExternal(bool)),
         this, SLOT(handleSelectionListChanged(bool)));
 
-    connect(m_selectionManager, SIGNAL(rowSelected(int,bool)),
-        this, SIGNAL(rowSelected(int,bool)));
+    m_rowSelectedForwarded = false;
+    m_columnSelectedForwarded = false;
+    updateSelectionSignalForwarding();
 
-    connect(m_selectionManager, SIGNAL(columnSelected(int,bool)),
-        this, SIGNAL(columnSelected(int,bool)));
+    m_autoFitCache = new QicsAutoFitCache(this);
+    m_autoFitCache->setDataModel(dataModel());
 
     connect(dimensionManager(),SIGNAL(rowResized(int,int,int)),this,SIGNAL(rowResized(int,int,int)));
     connect(dimensionManager(),SIGNAL(columnResized(int,int,int)),this,SIGNAL(columnResized(int,int,int)));
@@ -800,6 +803,10 @@ void QicsTable::initObjects()
 
     connect(dimensionManager(),SIGNAL(dimensionChanged(Qics::QicsIndexType,int,int)),this,SLOT(configureFrozen(Qics::QicsIndexType,int,int)));
     connect(&gridInfo(), SIGNAL(filterChanged(int, bool)), this, SLOT(handleFilterChanged(int, bool)));
+    connect(&gridInfo(), SIGNAL(orderingProgress(Qics::QicsIndexType, int)),
+        this, SIGNAL(sortProgress(Qics::QicsIndexType, int)));
+    connect(&gridInfo(), SIGNAL(orderingFinished(Qics::QicsIndexType, bool)),
+        this, SIGNAL(sortFinished(Qics::QicsIndexType, bool)));
 
     // handles all the scrolling
     m_scrollManager = new QicsScrollManager(this);
@@ -858,6 +865,9 @@ void QicsTable::initGridInfoObjects()
     connect(&gridInfo(), SIGNAL(cellValueChanged(int, int)),
         this, SLOT(modelToVisualValueChanged(int, int)));
 
+    connect(&gridInfo(), SIGNAL(cellValuesChanged(const QicsRegion &)),
+        this, SLOT(modelToVisualValuesChanged(const QicsRegion &)));
+
     connect(&gridInfo(),SIGNAL(rowsMoved(int, const QVector<int>&)),
         this,SIGNAL(rowsMoved(int, const QVector<int>&)));
 
@@ -974,6 +984,7 @@ void QicsTable::setDataModel(QicsDataModel *dm)
 
     initDataModels(dm);
     m_selectionManager->setDataModel(dm);
+    m_autoFitCache->setDataModel(dm);
 
     // we need to keep the three data models in sync so that when
     // rows and columns are inserted or deleted in the main data model,
@@ -1978,15 +1989,44 @@ void QicsTable::toggleColumnWidthExpansion(int col, bool setOverrideCursor)
         w = qMax(w, cd->sizeHint(TOP_HEADER, i, col, itm).width());
     }
 
+    // widths are cached by model cell, and are only valid for the
+    // styles and column width they were measured with
+    const int modelCol = gridInfo().modelColumnIndex(col);
+    m_autoFitCache->validateColumn(modelCol, gridInfo().mappedDM()->columnWidth(col),
+        styleManager()->columnStyleRevision(modelCol));
+
+    const int startRow = vp.startRow();
     const int endRow = vp.endRow();
-    for (int i = vp.startRow(); i <= endRow; ++i) {
+
+    // with a sample size, measure the rows on screen and every step-th
+    // row; the other rows only count if they were measured before
+    int step = 1;
+    if (m_autoFitSampleSize > 0 && endRow - startRow + 1 > m_autoFitSampleSize)
+        step = (endRow - startRow + 1) / m_autoFitSampleSize;
+    const int firstShown = topRow();
+    const int lastShown = bottomRow();
+
+    for (int i = startRow; i <= endRow; ++i) {
+        const int modelRow = gridInfo().modelRowIndex(i);
+        int cw = m_autoFitCache->width(modelRow, modelCol);
+
+        if (cw < 0 && step > 1 && (i - startRow) % step != 0 &&
+                (i < firstShown || i > lastShown))
+            continue;
+
         if (spanManager->isSpanner(cell.gridInfo(), i, col, reg))// #90009
             continue;// #90009
-        cell.setRowIndex(i);
-        cd = cell.displayer();
-        itm = cell.dataValue();
 
-        w = qMax(w, cd->sizeHint(MAIN_GRID, i, col, itm).width());
+        if (cw < 0) {
+            cell.setRowIndex(i);
+            cd = cell.displayer();
+            itm = cell.dataValue();
+
+            cw = cd->sizeHint(MAIN_GRID, i, col, itm).width();
+            m_autoFitCache->setWidth(modelRow, modelCol, cw);
+        }
+
+        w = qMax(w, cw);
     }
 
     w = qMax(w, gridInfo().mappedDM()->columnMinWidth(col));
@@ -3118,6 +3158,45 @@ void QicsTable::setRepaintBehavior(QicsRepaintBehavior r)
     chGridInfo().setGridRepaintBehavior(r);
 }
 
+int QicsTable::refreshInterval() const
+{
+    return gridInfo().refreshInterval();
+}
+
+void QicsTable::setRefreshInterval(int msecs)
+{
+    gridInfo().setRefreshInterval(msecs);
+    rhGridInfo().setRefreshInterval(msecs);
+    chGridInfo().setRefreshInterval(msecs);
+}
+
+void QicsTable::flushModelChanges()
+{
+    gridInfo().flushModelChanges();
+    rhGridInfo().flushModelChanges();
+    chGridInfo().flushModelChanges();
+}
+
+bool QicsTable::markSelectionInStyles() const
+{
+    return m_selectionManager->markSelectionInStyles();
+}
+
+void QicsTable::setMarkSelectionInStyles(bool yes)
+{
+    m_selectionManager->setMarkSelectionInStyles(yes);
+}
+
+int QicsTable::autoFitSampleSize() const
+{
+    return m_autoFitSampleSize;
+}
+
+void QicsTable::setAutoFitSampleSize(int num)
+{
+    m_autoFitSampleSize = qMax(num, 0);
+}
+
 Qics::QicsScrollBarMode QicsTable::hScrollBarMode() const
 {
     return m_columnScroller->mode();
@@ -3170,6 +3249,30 @@ void QicsTable::sortColumns(const QVector<int> &rowsnum, Qics::QicsSortOrder ord
     m_tableCommon->sortColumns(rowsnum, order, from, to, func);
 }
 
+void QicsTable::sortRowsAsync(const QVector<int> &colsnum, Qics::QicsSortOrder order,
+                         int from, int to,
+                         DataItemComparator func)
+{
+    m_tableCommon->sortRowsAsync(colsnum, order, from, to, func);
+}
+
+void QicsTable::sortColumnsAsync(const QVector<int> &rowsnum, Qics::QicsSortOrder order,
+                            int from, int to,
+                            DataItemComparator func)
+{
+    m_tableCommon->sortColumnsAsync(rowsnum, order, from, to, func);
+}
+
+void QicsTable::cancelSort()
+{
+    gridInfo().cancelOrdering();
+}
+
+bool QicsTable::isSorting() const
+{
+    return gridInfo().isOrdering();
+}
+
 void QicsTable::moveRows(int target_row, const QVector<int> &rows)
 {
     m_tableCommon->moveRows(target_row, rows);
@@ -3949,6 +4052,22 @@ void QicsTable::modelToVisualValueChanged(int row, int col)
         gridInfo().visualColumnIndex(col));
 }
 
+void QicsTable::modelToVisualValuesChanged(const QicsRegion &reg)
+{
+    // check if the cell being edited is in the changed region
+    const QicsCell* cur_cell = currentCell();
+
+    if ( cur_cell->isValid() && cur_cell->displayer()->isEditing() &&
+        reg.containsCell(gridInfo().modelRowIndex(cur_cell->rowIndex()),
+            gridInfo().modelColumnIndex(cur_cell->columnIndex())) ) {
+        cur_cell->displayer()->startEdit(MAIN_GRID,
+            cur_cell->rowIndex(), cur_cell->columnIndex(),
+            cur_cell->dataValue());
+    }
+
+    emit valuesChanged(reg);
+}
+
 void QicsTable::handleCurrentCellChange(int row, int col)
 {
     myCurrentCell->setRowIndex(row);
@@ -4199,6 +4318,8 @@ bool QicsTable::event ( QEvent * e )
     case QEvent::FontChange: {
         QFont f = font();
 
+        m_autoFitCache->clear();
+
         //setting font for grids
         if(LEFT_HEADER)
             rowHeaderRef().setFont(f);
@@ -4246,6 +4367,60 @@ bool QicsTable::eventFilter(QObject* sender,QEvent* e)
     return false;
 }
 
+#if QT_VERSION < 0x050000
+void QicsTable::connectNotify(const char *signal)
+{
+    QFrame::connectNotify(signal);
+    updateSelectionSignalForwarding();
+}
+
+void QicsTable::disconnectNotify(const char *signal)
+{
+    QFrame::disconnectNotify(signal);
+    updateSelectionSignalForwarding();
+}
+#else
+void QicsTable::connectNotify(const QMetaMethod &signal)
+{
+    QFrame::connectNotify(signal);
+    updateSelectionSignalForwarding();
+}
+
+void QicsTable::disconnectNotify(const QMetaMethod &signal)
+{
+    QFrame::disconnectNotify(signal);
+    updateSelectionSignalForwarding();
+}
+#endif
+
+void QicsTable::updateSelectionSignalForwarding()
+{
+    if (!m_selectionManager)
+        return;
+
+    const bool rows = (receivers(SIGNAL(rowSelected(int,bool))) > 0);
+    if (rows != m_rowSelectedForwarded) {
+        m_rowSelectedForwarded = rows;
+        if (rows)
+            connect(m_selectionManager, SIGNAL(rowSelected(int,bool)),
+                this, SIGNAL(rowSelected(int,bool)));
+        else
+            disconnect(m_selectionManager, SIGNAL(rowSelected(int,bool)),
+                this, SIGNAL(rowSelected(int,bool)));
+    }
+
+    const bool columns = (receivers(SIGNAL(columnSelected(int,bool))) > 0);
+    if (columns != m_columnSelectedForwarded) {
+        m_columnSelectedForwarded = columns;
+        if (columns)
+            connect(m_selectionManager, SIGNAL(columnSelected(int,bool)),
+                this, SIGNAL(columnSelected(int,bool)));
+        else
+            disconnect(m_selectionManager, SIGNAL(columnSelected(int,bool)),
+                this, SIGNAL(columnSelected(int,bool)));
+    }
+}
+
 void QicsTable::focusNextPrevGrid(const QicsScreenGrid* current_grid, bool next)
 {
     for(int i = 0 ;i< 3; ++i) {
@@ -388,6 +388,20 @@ void QicsTableCommon::sortColumns(const QVector<int> &rows, QicsSortOrder order,
     gridInfo().orderColumnsBy(rows, order, from, to, func);
 }
 
+void QicsTableCommon::sortRowsAsync(const QVector<int> &columns, QicsSortOrder order,
+                               int from, int to,
+                               DataItemComparator func)
+{
+    gridInfo().orderRowsByAsync(columns, order, from, to, func);
+}
+
+void QicsTableCommon::sortColumnsAsync(const QVector<int> &rows, QicsSortOrder order,
+                                  int from, int to,
+                                  DataItemComparator func)
+{
+    gridInfo().orderColumnsByAsync(rows, order, from, to, func);
+}
+
 void QicsTableCommon::moveRows(int target_row, const QVector<int> &rows)
 {
     gridInfo().moveRows(target_row, rows);
@@ -119,12 +119,8 @@ void QicsTextCellDisplay::displayCell(QicsGrid *grid, int row, int col,
     bool can_display_all = true;
 
     // respect the QLineEdit echo mode
-    if (!m_contentScrollEnabled) {
-        td->lineEdit->setText(d->qs);
-        td->lineEdit->setEchoMode(m_echomode);
-        td->lineEdit->setInputMask(m_inputMask);
-        d->qs = td->lineEdit->displayText();
-    }
+    if (!m_contentScrollEnabled)
+        d->qs = td->layoutCache.displayText(td->lineEdit, d->qs, m_echomode, m_inputMask);
     //
     // No need to try to overflow if this cell is empty.
     //
@@ -446,7 +442,7 @@ QSize QicsTextCellDisplay::sizeHint(QicsGrid *grid, int row, int col, const Qics
     QString text = textToDisplay(ginfo, row, col, itm);
 
     int tflags = myCell->alignment() | myCell->textFlags();
-    QFontMetrics fm(myCell->font());
+    const QFont font = myCell->font();
     bool wordbreak = tflags | Qt::TextWordWrap;
 
     QSize sz(0,0);
@@ -465,8 +461,8 @@ QSize QicsTextCellDisplay::sizeHint(QicsGrid *grid, int row, int col, const Qics
         // If we aren't breaking lines, or if there's no newline in the
         // string, this is easy...
 
-        sz.setWidth(sz.width() + fm.width(text));
-        sz.setHeight(sz.height() + fm.height());
+        sz.setWidth(sz.width() + td->layoutCache.textWidth(font, text));
+        sz.setHeight(sz.height() + QFontMetrics(font).height());
     }
     else {
         // If we do expect more than one line, then we really don't
@@ -485,9 +481,7 @@ QSize QicsTextCellDisplay::sizeHint(QicsGrid *grid, int row, int col, const Qics
         else
             str_rect = QRect(QPoint(dar.left(), 0), QPoint(dar.right(), 0));
 
-        QRect br = fm.boundingRect(str_rect.left(), str_rect.top(),
-            str_rect.width(), str_rect.height(),
-            tflags, text);
+        QSize br = td->layoutCache.boundingSize(font, str_rect.size(), tflags, text);
 
         sz.setWidth(sz.width() + br.width());
         sz.setHeight(qMax(sz.height(), br.height()));
@@ -618,11 +612,7 @@ bool QicsTextCellDisplay::canDisplayAll(QicsGridInfo *info,
     else
         str_rect = cr;
 
-    QFontMetrics fm(font);
-
-    QRect br = fm.boundingRect(str_rect.left(), str_rect.top(),
-        str_rect.width(), str_rect.height(),
-        text_flags, text);
+    QSize br = td->layoutCache.boundingSize(font, str_rect.size(), text_flags, text);
 
     return ((br.width() <= (str_rect.width() + 1)) &&
         (br.height() <= (str_rect.height() + 1)));
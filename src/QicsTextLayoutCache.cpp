@@ -0,0 +1,78 @@
+/*********************************************************************
+**
+** Copyright (C) 2002-2014 Integrated Computer Solutions, Inc.
+** All rights reserved.
+**
+** This file is part of the QicsTable software.
+**
+** See the top level README file for license terms under which this
+** software can be used, distributed, or modified.
+**
+**********************************************************************/
+
+#include "QicsTextLayoutCache.h"
+
+#include <QFontMetrics>
+
+
+QicsTextLayoutCache::QicsTextLayoutCache(int max_entries)
+    : myDisplayTexts(qMax(max_entries, 1)),
+      myMeasures(qMax(max_entries, 1)),
+      myWidths(qMax(max_entries, 1))
+{
+}
+
+void QicsTextLayoutCache::clear()
+{
+    myDisplayTexts.clear();
+    myMeasures.clear();
+    myWidths.clear();
+}
+
+QString QicsTextLayoutCache::displayText(QLineEdit *edit, const QString &text,
+                                         QLineEdit::EchoMode mode, const QString &mask)
+{
+    const QicsTextLayoutKey key(text, mask, 0, 0, int(mode));
+
+    if (const QString *cached = myDisplayTexts.object(key))
+        return *cached;
+
+    edit->setText(text);
+    edit->setEchoMode(mode);
+    edit->setInputMask(mask);
+    const QString display = edit->displayText();
+
+    myDisplayTexts.insert(key, new QString(display));
+    return display;
+}
+
+QSize QicsTextLayoutCache::boundingSize(const QFont &font, const QSize &area, int flags,
+                                        const QString &text)
+{
+    const QicsTextLayoutKey key(text, font.key(), area.width(), area.height(), flags);
+
+    if (const QSize *cached = myMeasures.object(key))
+        return *cached;
+
+    // the size of the bounding rectangle does not depend on where the
+    // area is, only on how large it is
+    QFontMetrics fm(font);
+    const QSize sz = fm.boundingRect(0, 0, area.width(), area.height(), flags, text).size();
+
+    myMeasures.insert(key, new QSize(sz));
+    return sz;
+}
+
+int QicsTextLayoutCache::textWidth(const QFont &font, const QString &text)
+{
+    const QicsTextLayoutKey key(text, font.key(), 0, 0, 0);
+
+    if (const int *cached = myWidths.object(key))
+        return *cached;
+
+    QFontMetrics fm(font);
+    const int w = fm.width(text);
+
+    myWidths.insert(key, new int(w));
+    return w;
+}
@@ -46,8 +46,14 @@ HEADERS += ../include/QicsNamespace.h \
             ../include/QicsGridStyle.h \
             ../include/QicsStyleManager.h \
             ../include/QicsSelectionManager.h \
+            ../include/QicsSelectionIndex.h \
+            ../include/QicsAutoFitCache.h \
             ../include/QicsDimensionManager.h \
             ../include/QicsMappedDimensionManager.h \
+            ../include/QicsOffsetIndex.h \
+            ../include/QicsIndexSet.h \
+            ../include/QicsSpanIndex.h \
+            ../include/QicsDirtyRegionSet.h \
             ../include/QicsSpanManager.h \
             ../include/QicsSorter.h \
             ../include/QicsCellCommon.h \
@@ -70,6 +76,7 @@ HEADERS += ../include/QicsNamespace.h \
             ../include/QicsCellDisplay.h \
             ../include/QicsTextCellDisplay.h \
             ../include/QicsTextCellDisplayHelpers.h \
+            ../include/QicsTextLayoutCache.h \
             ../include/QicsCheckCellDisplay.h \
             ../include/QicsComboCellDisplay.h \
             ../include/QicsWidgetCellDisplay.h \
@@ -82,6 +89,7 @@ HEADERS += ../include/QicsNamespace.h \
             ../include/QicsDataModel.h \
             ../include/QicsDataItem.h \
             ../include/QicsDataModelDefault.h \
+            ../include/QicsColumnarDataModel.h \
             ../include/QicsScroller.h \
             ../include/QicsScrollBarScroller.h \
             ../include/QicsScrollManager.h \
@@ -118,10 +126,13 @@ HEADERS += ../include/QicsNamespace.h \
             ../include/QicsSpan.h \
             ../include/QicsAbstractSorterDelegate.h \
             ../include/QicsStandardSorterDelegate.h \
+            ../include/QicsSortKeys.h \
             ../addons/table.tree/QicsPopupDialog.h \
             ../addons/table.tree/QicsCheckPopup.h \
             ../addons/table.tree/QicsGroupBar.h \
             ../addons/table.tree/QicsGroupInfo.h \
+            ../addons/table.tree/QicsGroupKey.h \
+            ../addons/table.tree/QicsGroupAggregate.h \
             ../addons/table.tree/QicsSectionBar.h \
             ../addons/table.tree/QicsSortBar.h \
             ../addons/table.tree/QicsTreeDataModel.h \
@@ -140,8 +151,14 @@ SOURCES += QicsGridInfo.cpp \
             QicsGridStyle.cpp \
             QicsStyleManager.cpp \
             QicsSelectionManager.cpp \
+            QicsSelectionIndex.cpp \
+            QicsAutoFitCache.cpp \
             QicsDimensionManager.cpp \
             QicsMappedDimensionManager.cpp \
+            QicsOffsetIndex.cpp \
+            QicsIndexSet.cpp \
+            QicsSpanIndex.cpp \
+            QicsDirtyRegionSet.cpp \
             QicsSpanManager.cpp \
             QicsSorter.cpp \
             QicsCellCommon.cpp \
@@ -164,6 +181,7 @@ SOURCES += QicsGridInfo.cpp \
             QicsCellDisplay.cpp \
             QicsTextCellDisplayHelpers.cpp \
             QicsTextCellDisplay.cpp \
+            QicsTextLayoutCache.cpp \
             QicsCheckCellDisplay.cpp \
             QicsComboCellDisplay.cpp \
             QicsWidgetCellDisplay.cpp \
@@ -176,6 +194,7 @@ SOURCES += QicsGridInfo.cpp \
             QicsDataModel.cpp \
             QicsDataItem.cpp \
             QicsDataModelDefault.cpp \
+            QicsColumnarDataModel.cpp \
             QicsScrollBarScroller.cpp \
             QicsScrollManager.cpp \
             QicsUtil.cpp \
@@ -204,6 +223,7 @@ SOURCES += QicsGridInfo.cpp \
             QicsEnumerator.cpp \
             QicsAbstractSorterDelegate.cpp \
             QicsStandardSorterDelegate.cpp \
+            QicsSortKeys.cpp \
             QicsRuler.cpp \
             QicsNavigator.cpp \
             QicsRubberBand.cpp \
@@ -211,6 +231,8 @@ SOURCES += QicsGridInfo.cpp \
             ../addons/table.tree/QicsCheckPopup.cpp \
             ../addons/table.tree/QicsGroupBar.cpp \
             ../addons/table.tree/QicsGroupInfo.cpp \
+            ../addons/table.tree/QicsGroupKey.cpp \
+            ../addons/table.tree/QicsGroupAggregate.cpp \
             ../addons/table.tree/QicsSectionBar.cpp \
             ../addons/table.tree/QicsSortBar.cpp \
             ../addons/table.tree/QicsTreeDataModel.cpp \
@@ -219,7 +241,8 @@ SOURCES += QicsGridInfo.cpp \
             ../addons/table.tree/QicsSpecialRowData.cpp \
             ../addons/table.tree/QicsExpandableStaticRowData.cpp \
             ../addons/table.tree/QicsTreeTableGrid.cpp \
-            ../addons/table.tree/QicsTreeHeaderGrid.cpp
+            ../addons/table.tree/QicsTreeHeaderGrid.cpp \
+            ../addons/table.tree/QicsSummarizer.cpp
 
 #PRINTING_NOOP
 HEADERS +=  ../include/QicsPrintGrid.h \